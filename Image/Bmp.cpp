@@ -79,7 +79,7 @@ static int loadBMP1(FILE* fp, byte* Pix, unsigned int w, unsigned int h)
     padw = ((w + 31) / 32) * 32; /* 'w', padded to be a multiple of 32 */
 
     for (i = h - 1; i >= 0; i--) {
-        pp = Pix + (i * w);
+        pp = Pix + (size_t(i) * w);
 
         for (j = bitnum = 0; j < padw; j++, bitnum++) {
             if ((bitnum & 7) == 0) { /* read the next byte */
@@ -110,7 +110,7 @@ static int loadBMP4(FILE* fp, byte* Pix, unsigned int w, unsigned int h, unsigne
         padw = ((w + 7) / 8) * 8; /* 'w' padded to a multiple of 8pix (32 bits) */
 
         for (i = h - 1; i >= 0; i--) {
-            pp = Pix + (i * w);
+            pp = Pix + (size_t(i) * w);
 
             for (j = nybnum = 0; j < padw; j++, nybnum++) {
                 if ((nybnum & 1) == 0) { /* read next byte */
@@ -200,7 +200,7 @@ static int loadBMP8(FILE* fp, byte* Pix, unsigned int w, unsigned int h, unsigne
         padw = ((w + 3) / 4) * 4; /* 'w' padded to a multiple of 4pix (32 bits) */
 
         for (i = h - 1; i >= 0; i--) {
-            pp = Pix + (i * w);
+            pp = Pix + (size_t(i) * w);
 
             fread(pp, 1, w, fp);
             for (int j = w; j < padw; j++) getc(fp);
@@ -282,7 +282,7 @@ static int loadBMP24(FILE* fp, byte* Pix, unsigned int w, unsigned int h)
     ASSERT_RM(lbuf, "memory alloc failed");
 
     for (int i = h - 1; i >= 0; i--) {
-        byte* pp = Pix + (i * w * 3);
+        byte* pp = Pix + (size_t(i) * w * 3);
 
         fread(lbuf, 1, linebytecnt, fp);
         int w3 = w * 3;
@@ -313,7 +313,7 @@ static int loadBMP32(FILE* fp, byte* Pix, unsigned int w, unsigned int h)
     padb = 0; /* # of pad bytes to read at EOscanline */
 
     for (i = h - 1; i >= 0; i--) {
-        pp = Pix + (i * w * 4);
+        pp = Pix + (size_t(i) * w * 4);
 
         for (j = 0; j < (int)w; j++) {
             pp[2] = getc(fp); /* blue */
@@ -507,14 +507,14 @@ void ImageLoadSave::LoadBMP(const std::string& fname)
             chan = 1;
             // Convert color map image to monochrome.
             // Replace the palette indices with the palette entries.
-            for (int i = 0; i < size(); i++) { Pix[i] = red[Pix[i]]; }
+            for (int64_t i = 0; i < size(); i++) { Pix[i] = red[Pix[i]]; }
         } else {
             // Convert color map image to 24 bit.
             // Replace the palette indices with the palette entries.
             // The data is in Pix, but is one-third the right size.
             // Work backward to not overwrite.
             unsigned char* tmp = Pix;
-            for (int i = size() - 1; i; i--) {
+            for (int64_t i = size() - 1; i; i--) {
                 Pix[i * 3 + 0] = red[tmp[i]];
                 Pix[i * 3 + 1] = grn[tmp[i]];
                 Pix[i * 3 + 2] = blu[tmp[i]];
@@ -531,7 +531,7 @@ static void writeBMP8(FILE* fp, byte* Pix, int w, int h)
     padw = ((w + 3) / 4) * 4; /* 'w' padded to a multiple of 4pix (32 bits) */
 
     for (i = h - 1; i >= 0; i--) {
-        byte* pp = Pix + (i * w);
+        byte* pp = Pix + (size_t(i) * w);
 
         for (j = 0; j < w; j++) putc(*pp++, fp);
         for (; j < padw; j++) putc(0, fp);
@@ -546,7 +546,7 @@ static void writeBMP24(FILE* fp, byte* Pix, int w, int h)
     padb = (4 - ((w * 3) % 4)) & 0x03; /* # of pad bytes to write at EOscanline */
 
     for (i = h - 1; i >= 0; i--) {
-        byte* pp = Pix + (i * w * 3);
+        byte* pp = Pix + (size_t(i) * w * 3);
 
         for (j = 0; j < w; j++) {
             putc(pp[2], fp);
@@ -136,7 +136,7 @@ public:
         static int oldYC = -1;
 
         if (oldYC != YC) {
-            ptr = pic8 + YC * Width * chan;
+            ptr = pic8 + size_t(YC) * Width * chan;
             oldYC = YC;
         }
 
@@ -194,7 +194,7 @@ public:
     int readImage()
     {
         byte ch, ch1, *ptr1, *picptr;
-        int npixels, maxpixels;
+        int64_t npixels, maxpixels;
 
         npixels = maxpixels = 0;
 
@@ -280,7 +280,7 @@ public:
 #endif
 
         // Allocate the 'pic' */
-        maxpixels = Width * Height;
+        maxpixels = int64_t(Width) * Height;
 
         picptr = pic8 = new unsigned char[maxpixels * chan];
 
@@ -933,7 +933,7 @@ class GIFWriter {
     }
 
     //////////////////////////////////////////////////////////////////////
-    void compress(byte* data, int len)
+    void compress(byte* data, int64_t len)
     {
         long fcode;
         int i = 0;
@@ -1041,7 +1041,7 @@ public:
     //////////////////////////////////////////////////////////////////////
     void WriteGIF(const std::string& fname, int wid, int hgt, byte* Pix, bool isOneChan, LoadSaveParams SP)
     {
-        int size = wid * hgt;
+        int64_t size = int64_t(wid) * hgt;
 
         if ((fp = fopen(fname.c_str(), "wb")) == 0) throw DMcError("WriteGIF() failed: can't write GIF image file " + std::string(fname));
 
@@ -1122,7 +1122,7 @@ public:
 
         fputc(InitCodeSize, fp);
         init_bits = InitCodeSize + 1;
-        compress(pic8, wid * hgt); // Write the compressed pixel data
+        compress(pic8, int64_t(wid) * hgt); // Write the compressed pixel data
 
         fputc(0, fp);   // Write out a Zero-length packet (EOF)
         fputc(';', fp); // Write GIF file terminator
@@ -5,27 +5,157 @@
 
 #include "Image/ImageAlgorithms.h"
 
+#include "Math/FFT.h"
 #include "Math/Random.h"
 
 #include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
-template <class OutImage_T, class InImage_T>
-void ToneMapLinear(OutImage_T& Out, const InImage_T& Img, const typename InImage_T::PixType::ElType Scale, const typename InImage_T::PixType::ElType Bias)
+namespace {
+// Map each element e of Img to the float Map(e), or AlphaMap(e) for alpha, and convert that to Out's element type with
+// Xfer. Integer elements are passed to the maps as is, not normalized. Bands of rows run on multiple threads. Float and
+// half rows are mapped into a float buffer that ConvertPixels converts with its SIMD kernels. Unsigned char and unsigned
+// short elements instead look up their result in a table of every input value, made the same way.
+template <class OutImage_T, class InImage_T, class Map_T, class AlphaMap_T>
+void toneMapRows(OutImage_T& Out, const InImage_T& Img, const Map_T& Map, const AlphaMap_T& AlphaMap, const ColorXfer_e Xfer)
 {
-    Out.SetSize(Img.w(), Img.h());
+    typedef typename OutImage_T::PixType OutPixel_T;
+    typedef typename InImage_T::PixType InPixel_T;
+    typedef typename InPixel_T::ElType InEl_T;
+    typedef tPixel<float, InPixel_T::Chan> FPixel_T;
+    static_assert(OutPixel_T::Chan == InPixel_T::Chan, "Tone mapping maps each channel to the same channel");
+    const int w = Img.w(), h = Img.h(), C = InPixel_T::Chan, AlphaC = AlphaChan<InPixel_T>();
+
+    Out.SetSize(w, h);
+    if (Img.size() < 1) return;
+    Out.row(0); // Unshare the raster before the threads write rows of it
+
+    if constexpr (std::is_same<InEl_T, unsigned char>::value || std::is_same<InEl_T, unsigned short>::value) {
+        const size_t NV = size_t(std::numeric_limits<InEl_T>::max()) + 1;
+        std::vector<f1Pixel> F(NV);
+        std::vector<tPixel<typename OutPixel_T::ElType, 1>> Lut(NV), AlphaLut(NV);
+        for (size_t v = 0; v < NV; v++) F[v] = f1Pixel(Map(float(v)));
+        ConvertPixels(Lut.data(), F.data(), NV, Xfer);
+        if (AlphaC >= 0) {
+            for (size_t v = 0; v < NV; v++) F[v] = f1Pixel(AlphaMap(float(v)));
+            ConvertPixels(AlphaLut.data(), F.data(), NV);
+        }
 
-    for (int i = 0; i < Img.size(); i++) {
-        typename InImage_T::PixType tmp = Scale * Img[i];
-        tmp += Bias;
-        Out[i] = static_cast<typename OutImage_T::PixType>(tmp);
+        ParallelForRanges(h, std::max(1, ConvertParallelPixels / w), [&](const int y0, const int y1) {
+            for (int y = y0; y < y1; y++) {
+                const InPixel_T* s = Img.row(y);
+                OutPixel_T* d = Out.row(y);
+                for (int x = 0; x < w; x++)
+                    for (int c = 0; c < C; c++) d[x][c] = (c == AlphaC ? AlphaLut : Lut)[s[x][c]][0];
+            }
+        });
+    } else {
+        ParallelForRanges(h, std::max(1, ConvertParallelPixels / w), [&](const int y0, const int y1) {
+            std::vector<FPixel_T> Buf(w);
+            float* b = reinterpret_cast<float*>(Buf.data());
+            for (int y = y0; y < y1; y++) {
+                const InPixel_T* s = Img.row(y);
+                if constexpr (std::is_same<InEl_T, float>::value) {
+                    const float* e = reinterpret_cast<const float*>(s);
+                    for (int i = 0; i < w * C; i++) b[i] = Map(e[i]);
+                } else {
+                    ConvertPixels(Buf.data(), s, size_t(w));
+                    for (int i = 0; i < w * C; i++) b[i] = Map(b[i]);
+                }
+                if (AlphaC >= 0)
+                    for (int x = 0; x < w; x++) Buf[x][AlphaC] = AlphaMap(float(s[x][AlphaC]));
+                ConvertPixels(Out.row(y), Buf.data(), size_t(w), Xfer);
+            }
+        });
     }
 }
 
+// Out = Img * Scale + Bias, converted to Out's element type, for float or integer Img.
+template <class OutImage_T, class InImage_T> void toneMapScaleBias(OutImage_T& Out, const InImage_T& Img, const float Scale, const float Bias)
+{
+    if constexpr (OutImage_T::PixType::Chan == InImage_T::PixType::Chan) {
+        auto Map = [=](const float v) {
+            float t = v * Scale;
+            t += Bias;
+            return t;
+        };
+        toneMapRows(Out, Img, Map, Map, XFER_NONE);
+    } else {
+        // Different channel counts convert a whole pixel at a time.
+        Out.SetSize(Img.w(), Img.h());
+        for (int y = 0; y < Img.h(); y++) {
+            for (int x = 0; x < Img.w(); x++) {
+                typename InImage_T::PixType tmp = typename InImage_T::PixType::ElType(Scale) * Img(x, y);
+                tmp += typename InImage_T::PixType::ElType(Bias);
+                Out(x, y) = static_cast<typename OutImage_T::PixType>(tmp);
+            }
+        }
+    }
+}
+
+// The smallest and largest elements of each channel of Img. Bands of rows find their own extrema on multiple threads,
+// using the SIMD kernel on each row, and then the bands' extrema are combined.
+template <class Image_T> void findExtrema(typename Image_T::PixType& MinP, typename Image_T::PixType& MaxP, const Image_T& Img)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef typename Pixel_T::ElType Elem_T;
+    const int w = Img.w(), h = Img.h(), C = Pixel_T::Chan;
+    ASSERT_R(Img.size() > 0);
+
+    const int BandRows = std::max(1, ConvertParallelPixels / w);
+    const int Bands = (h + BandRows - 1) / BandRows;
+    std::vector<Pixel_T> Mins(Bands), Maxs(Bands);
+    ParallelForRanges(Bands, 1, [&](const int b0, const int b1) {
+        for (int band = b0; band < b1; band++) {
+            Pixel_T mn = Img(0, band * BandRows), mx = mn;
+            for (int y = band * BandRows; y < std::min(h, (band + 1) * BandRows); y++) {
+                const Pixel_T* r = Img.row(y);
+                Elem_T rmn[4], rmx[4];
+                if (sizeof(Pixel_T) == sizeof(Elem_T) * C && SIMDMinMax(reinterpret_cast<const Elem_T*>(r), size_t(w) * C, C, rmn, rmx)) {
+                    for (int c = 0; c < C; c++) {
+                        mn[c] = std::min(mn[c], rmn[c]);
+                        mx[c] = std::max(mx[c], rmx[c]);
+                    }
+                } else {
+                    for (int x = 0; x < w; x++) {
+                        mn = Min(mn, r[x]);
+                        mx = Max(mx, r[x]);
+                    }
+                }
+            }
+            Mins[band] = mn;
+            Maxs[band] = mx;
+        }
+    });
+
+    MinP = Mins[0];
+    MaxP = Maxs[0];
+    for (int band = 1; band < Bands; band++) {
+        MinP = Min(MinP, Mins[band]);
+        MaxP = Max(MaxP, Maxs[band]);
+    }
+}
+}; // namespace
+
+template <class OutImage_T, class InImage_T>
+void ToneMapLinear(OutImage_T& Out, const InImage_T& Img, const typename InImage_T::PixType::ElType Scale, const typename InImage_T::PixType::ElType Bias)
+{
+    toneMapScaleBias(Out, Img, Scale, Bias);
+}
+
 // This instantiation is touchy. Your code has to really give float args.
 template void ToneMapLinear(uc1Image& Out, const f1Image& Img, const float Scale, const float Bias);
 template void ToneMapLinear(uc3Image& Out, const f3Image& Img, const float Scale, const float Bias);
 template void ToneMapLinear(uc1Image& Out, const f3Image& Img, const float Scale, const float Bias);
+template void ToneMapLinear(uc1ImageView& Out, const f1ImageView& Img, const float Scale, const float Bias);
+template void ToneMapLinear(uc3ImageView& Out, const f3ImageView& Img, const float Scale, const float Bias);
+template void ToneMapLinear(uc1ImageView& Out, const f3ImageView& Img, const float Scale, const float Bias);
 
 template <class OutImage_T, class InImage_T>
 void ToneMapExtrema(OutImage_T& Out, const InImage_T& Img, const typename InImage_T::PixType& MinP, const typename InImage_T::PixType& MaxP)
@@ -36,17 +166,27 @@ void ToneMapExtrema(OutImage_T& Out, const InImage_T& Img, const typename InImag
     float Scale = 1.0f / (maxc - minc);
     float Bias = -(minc * Scale);
 
-    ToneMapLinear(Out, Img, Scale, Bias);
+    toneMapScaleBias(Out, Img, Scale, Bias);
 }
 
 template void ToneMapExtrema(uc1Image& Out, const f1Image& Img, const f1Pixel& MinP, const f1Pixel& MaxP);
 template void ToneMapExtrema(uc3Image& Out, const f3Image& Img, const f3Pixel& MinP, const f3Pixel& MaxP);
 template void ToneMapExtrema(uc1Image& Out, const f3Image& Img, const f3Pixel& MinP, const f3Pixel& MaxP);
+template void ToneMapExtrema(uc1Image& Out, const us1Image& Img, const us1Pixel& MinP, const us1Pixel& MaxP);
+template void ToneMapExtrema(uc3Image& Out, const us3Image& Img, const us3Pixel& MinP, const us3Pixel& MaxP);
+template void ToneMapExtrema(uc1ImageView& Out, const f1ImageView& Img, const f1Pixel& MinP, const f1Pixel& MaxP);
+template void ToneMapExtrema(uc3ImageView& Out, const f3ImageView& Img, const f3Pixel& MinP, const f3Pixel& MaxP);
+template void ToneMapExtrema(uc1ImageView& Out, const f3ImageView& Img, const f3Pixel& MinP, const f3Pixel& MaxP);
 
 template <class OutImage_T, class InImage_T> void ToneMapFindExtrema(OutImage_T& Out, const InImage_T& Img)
 {
+    if (Img.size() < 1) {
+        Out.SetSize(Img.w(), Img.h());
+        return;
+    }
+
     typename InImage_T::PixType MinP, MaxP;
-    Img.GetMinMax(MinP, MaxP);
+    findExtrema(MinP, MaxP, Img);
 
     ToneMapExtrema(Out, Img, MinP, MaxP);
 }
@@ -54,49 +194,111 @@ template <class OutImage_T, class InImage_T> void ToneMapFindExtrema(OutImage_T&
 template void ToneMapFindExtrema(uc1Image& Out, const f1Image& Img);
 template void ToneMapFindExtrema(uc3Image& Out, const f3Image& Img);
 template void ToneMapFindExtrema(uc1Image& Out, const f3Image& Img);
+template void ToneMapFindExtrema(uc1Image& Out, const us1Image& Img);
+template void ToneMapFindExtrema(uc3Image& Out, const us3Image& Img);
+template void ToneMapFindExtrema(uc1ImageView& Out, const f1ImageView& Img);
+template void ToneMapFindExtrema(uc3ImageView& Out, const f3ImageView& Img);
+template void ToneMapFindExtrema(uc1ImageView& Out, const f3ImageView& Img);
+
+template <class OutImage_T, class InImage_T>
+void ToneMap(OutImage_T& Out, const InImage_T& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB)
+{
+    typedef typename InImage_T::PixType::ElType InEl_T;
+    typedef typename OutImage_T::PixType::ElType OutEl_T;
+    const float norm = 1.f / float(element_traits<InEl_T>::one()); // Integer inputs are normalized to 0..1
+    const float k = norm * Exposure;
+    const float rnd = 0.5f / float(element_traits<OutEl_T>::one()); // The plain conversion truncates, so round
+    const float crnd = encodeSRGB ? 0.f : rnd;                      // The sRGB encoding rounds already
+    const ColorXfer_e Xfer = encodeSRGB ? XFER_LINEAR_TO_SRGB : XFER_NONE;
+
+    auto run = [&](const auto& Curve) {
+        toneMapRows(
+            Out, Img, [=](const float v) { return Curve(std::max(v * k, 0.f)) + crnd; }, [=](const float v) { return v * norm + rnd; }, Xfer);
+    };
+    switch (Op) {
+    case TONEMAP_CLAMP: run([](const float x) { return x; }); break;
+    case TONEMAP_REINHARD: run([](const float x) { return x / (1.f + x); }); break;
+    case TONEMAP_FILMIC: run([](const float x) { return (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f); }); break;
+    }
+}
+
+template void ToneMap(uc1Image& Out, const f1Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc3Image& Out, const f3Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc4Image& Out, const f4Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc3Image& Out, const h3Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc4Image& Out, const h4Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc1Image& Out, const us1Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc3Image& Out, const us3Image& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc3ImageView& Out, const f3ImageView& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+template void ToneMap(uc4ImageView& Out, const f4ImageView& Img, const ToneMapOp_e Op, const float Exposure, const bool encodeSRGB);
+
+// Each plane is a flat array of one channel, so the scale and bias loop vectorizes at full width and the conversion uses the SIMD kernels.
+// The arithmetic is the same as ToneMapLinear's on interleaved pixels.
+template <class OutPixel_T, class InPixel_T>
+void ToneMapLinear(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img, const InPixel_T& Scale, const InPixel_T& Bias)
+{
+    typedef typename tPlanarImage<InPixel_T>::PlanePixType InPlanePix_T;
+    typedef typename InPixel_T::ElType InElem_T;
+    static_assert(OutPixel_T::Chan == InPixel_T::Chan, "Tone mapping maps each channel to the same channel");
+
+    Out.SetSize(Img.w(), Img.h());
+    if (Img.empty()) return;
+
+    std::vector<InPlanePix_T> Buf(Img.w());
+    for (int c = 0; c < Img.chan(); c++) {
+        const InElem_T s = Scale[c], b = Bias[c];
+        for (int y = 0; y < Img.h(); y++) {
+            const InPlanePix_T* r = Img.plane(c).row(y);
+            for (int x = 0; x < Img.w(); x++) {
+                InElem_T t = r[x][0] * s;
+                t += b;
+                Buf[x][0] = t;
+            }
+            ConvertPixels(Out.plane(c).row(y), Buf.data(), size_t(Img.w()));
+        }
+    }
+}
 
-// If a pixel is outside bounding box of all its neighbors then clamp it into the box
-template <class Image_T> void Despeckle(Image_T& dstImg, const Image_T& srcImg)
-{
-    dstImg.SetSize(srcImg.w(), srcImg.h());
-
-    for (int y = 1; y < srcImg.h() - 1; y++) {
-        for (int x = 1; x < srcImg.w() - 1; x++) {
-            // Channel-wise min and max make the bounding box of the neighbors
-            typename Image_T::PixType MinP = srcImg(x - 1, y - 1), MaxP = srcImg(x - 1, y - 1);
-            MinP = Min(MinP, srcImg(x, y - 1));
-            MaxP = Max(MaxP, srcImg(x, y - 1));
-            MinP = Min(MinP, srcImg(x + 1, y - 1));
-            MaxP = Max(MaxP, srcImg(x + 1, y - 1));
-            MinP = Min(MinP, srcImg(x - 1, y));
-            MaxP = Max(MaxP, srcImg(x - 1, y));
-            MinP = Min(MinP, srcImg(x + 1, y));
-            MaxP = Max(MaxP, srcImg(x + 1, y));
-            MinP = Min(MinP, srcImg(x - 1, y + 1));
-            MaxP = Max(MaxP, srcImg(x - 1, y + 1));
-            MinP = Min(MinP, srcImg(x, y + 1));
-            MaxP = Max(MaxP, srcImg(x, y + 1));
-            MinP = Min(MinP, srcImg(x + 1, y + 1));
-            MaxP = Max(MaxP, srcImg(x + 1, y + 1));
-            // Set the pixel to a point inside the bounding box. Should we do the box center or some such?
-            dstImg(x, y) = Clamp(MinP, srcImg(x, y), MaxP);
-        }
-    }
-}
-template void Despeckle(f1Image& dstImg, const f1Image& srcImg);
-template void Despeckle(f3Image& dstImg, const f3Image& srcImg);
-template void Despeckle(f4Image& dstImg, const f4Image& srcImg);
-template void Despeckle(uc1Image& dstImg, const uc1Image& srcImg);
-template void Despeckle(uc3Image& dstImg, const uc3Image& srcImg);
-template void Despeckle(uc4Image& dstImg, const uc4Image& srcImg);
+template void ToneMapLinear(uc3PlanarImage& Out, const f3PlanarImage& Img, const f3Pixel& Scale, const f3Pixel& Bias);
+template void ToneMapLinear(uc4PlanarImage& Out, const f4PlanarImage& Img, const f4Pixel& Scale, const f4Pixel& Bias);
+
+template <class OutPixel_T, class InPixel_T>
+void ToneMapExtrema(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img, const InPixel_T& MinP, const InPixel_T& MaxP)
+{
+    float minc = MinP.min_chan();
+    float maxc = MaxP.max_chan();
+
+    float Scale = 1.0f / (maxc - minc);
+    float Bias = -(minc * Scale);
+
+    ToneMapLinear(Out, Img, InPixel_T(Scale), InPixel_T(Bias));
+}
+
+template void ToneMapExtrema(uc3PlanarImage& Out, const f3PlanarImage& Img, const f3Pixel& MinP, const f3Pixel& MaxP);
+template void ToneMapExtrema(uc4PlanarImage& Out, const f4PlanarImage& Img, const f4Pixel& MinP, const f4Pixel& MaxP);
+
+template <class OutPixel_T, class InPixel_T> void ToneMapFindExtrema(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img)
+{
+    if (Img.size() < 1) {
+        Out.SetSize(Img.w(), Img.h());
+        return;
+    }
+
+    InPixel_T MinP, MaxP;
+    Img.GetMinMax(MinP, MaxP);
+
+    ToneMapExtrema(Out, Img, MinP, MaxP);
+}
+
+template void ToneMapFindExtrema(uc3PlanarImage& Out, const f3PlanarImage& Img);
+template void ToneMapFindExtrema(uc4PlanarImage& Out, const f4PlanarImage& Img);
 
 template <class Image_T> typename Image_T::PixType::ElType getApproxMedian(const Image_T& Img, const int NumSamples)
 {
     typename Image_T::PixType::ElType* vals = new typename Image_T::PixType::ElType[NumSamples];
 
     for (int k = 0; k < NumSamples; k++) {
-        int i = irand(Img.size());
-        vals[k] = Img[i].luminance();
+        vals[k] = Img(irand(Img.w()), irand(Img.h())).luminance();
     }
 
     std::sort(&vals[0], &vals[NumSamples]);
@@ -109,44 +311,473 @@ template <class Image_T> typename Image_T::PixType::ElType getApproxMedian(const
 
 template float getApproxMedian(const f3Image& Img, const int NumSamples);
 
-template <class Pixel_T, class Image_T, class Elem_T>
-std::vector<Pixel_T> getHistogram(const Image_T& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc)
+namespace {
+// Map a float to an unsigned int that sorts the same way, and back.
+DMC_DECL uint32_t floatKey(const float f)
 {
-    std::vector<Pixel_T> Hist(NumBuckets, Pixel_T(0));
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+DMC_DECL float keyFloat(const uint32_t k)
+{
+    const uint32_t u = (k & 0x80000000u) ? (k & 0x7fffffffu) : ~k;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Index of the bucket of a histogram that holds the element of rank r, and the number of elements before that bucket
+template <class Count_T> int findRank(const Count_T* Hist, const int NumBuckets, const int64_t r, int64_t& before)
+{
+    before = 0;
+    for (int b = 0; b < NumBuckets; b++) {
+        if (before + int64_t(Hist[b]) > r) return b;
+        before += Hist[b];
+    }
+    return NumBuckets - 1;
+}
+}; // namespace
 
-    float scale = float(NumBuckets) / float(maxc - minc);
-    for (int k = 0; k < Img.size(); k++) {
-        for (int c = 0; c < Img.chan(); c++) {
-            int bucket = int(float(Img[k][c] - minc) * scale);
-            if (bucket >= 0 && bucket < NumBuckets) Hist[bucket][c]++;
+template <class Image_T> std::vector<typename Image_T::PixType> getPercentiles(const Image_T& Img, const std::vector<float>& P)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef typename Pixel_T::ElType Elem_T;
+    const int NC = Pixel_T::Chan;
+    ASSERT_R(Img.size() > 0);
+
+    std::vector<Pixel_T> Res(P.size());
+    const int64_t n = Img.size();
+    auto rankOf = [&](const float p) { return int64_t(std::clamp(p, 0.f, 1.f) * double(n - 1)); };
+
+    if constexpr (std::is_same<Elem_T, unsigned char>::value || std::is_same<Elem_T, unsigned short>::value) {
+        // The elements are the bucket numbers, so one pass is exact.
+        const int NB = 1 << (8 * sizeof(Elem_T));
+        std::vector<int64_t> Hist(size_t(NB) * NC, 0);
+        for (int y = 0; y < Img.h(); y++)
+            for (int x = 0; x < Img.w(); x++)
+                for (int c = 0; c < NC; c++) Hist[size_t(c) * NB + Img(x, y)[c]]++;
+        for (size_t i = 0; i < P.size(); i++) {
+            for (int c = 0; c < NC; c++) {
+                int64_t before;
+                Res[i][c] = Elem_T(findRank(&Hist[size_t(c) * NB], NB, rankOf(P[i]), before));
+            }
+        }
+    } else {
+        // Radix select on the sortable bits: count the high 16 bits, then the low 16 bits of just the elements in the
+        // bucket that holds each rank.
+        static_assert(std::is_same<Elem_T, float>::value, "getPercentiles takes unsigned char, unsigned short, and float pixels");
+        const int NB = 1 << 16;
+        std::vector<int64_t> Hist(size_t(NB) * NC, 0), Low(NB);
+        for (int y = 0; y < Img.h(); y++)
+            for (int x = 0; x < Img.w(); x++)
+                for (int c = 0; c < NC; c++) Hist[size_t(c) * NB + (floatKey(Img(x, y)[c]) >> 16)]++;
+        for (size_t i = 0; i < P.size(); i++) {
+            for (int c = 0; c < NC; c++) {
+                int64_t before, before2;
+                const int64_t r = rankOf(P[i]);
+                const uint32_t hi = uint32_t(findRank(&Hist[size_t(c) * NB], NB, r, before));
+                std::fill(Low.begin(), Low.end(), 0);
+                for (int y = 0; y < Img.h(); y++) {
+                    for (int x = 0; x < Img.w(); x++) {
+                        const uint32_t k = floatKey(Img(x, y)[c]);
+                        if ((k >> 16) == hi) Low[k & 0xffff]++;
+                    }
+                }
+                Res[i][c] = keyFloat((hi << 16) | uint32_t(findRank(Low.data(), NB, r - before, before2)));
+            }
         }
     }
 
+    return Res;
+}
+
+template std::vector<uc1Pixel> getPercentiles(const uc1Image& Img, const std::vector<float>& P);
+template std::vector<uc3Pixel> getPercentiles(const uc3Image& Img, const std::vector<float>& P);
+template std::vector<uc4Pixel> getPercentiles(const uc4Image& Img, const std::vector<float>& P);
+template std::vector<us1Pixel> getPercentiles(const us1Image& Img, const std::vector<float>& P);
+template std::vector<us3Pixel> getPercentiles(const us3Image& Img, const std::vector<float>& P);
+template std::vector<f1Pixel> getPercentiles(const f1Image& Img, const std::vector<float>& P);
+template std::vector<f3Pixel> getPercentiles(const f3Image& Img, const std::vector<float>& P);
+template std::vector<f4Pixel> getPercentiles(const f4Image& Img, const std::vector<float>& P);
+template std::vector<uc1Pixel> getPercentiles(const uc1ImageView& Img, const std::vector<float>& P);
+template std::vector<uc3Pixel> getPercentiles(const uc3ImageView& Img, const std::vector<float>& P);
+template std::vector<f1Pixel> getPercentiles(const f1ImageView& Img, const std::vector<float>& P);
+template std::vector<f3Pixel> getPercentiles(const f3ImageView& Img, const std::vector<float>& P);
+
+template <class Image_T> typename Image_T::PixType getMedian(const Image_T& Img) { return getPercentiles(Img, std::vector<float>(1, 0.5f))[0]; }
+
+template uc1Pixel getMedian(const uc1Image& Img);
+template uc3Pixel getMedian(const uc3Image& Img);
+template uc4Pixel getMedian(const uc4Image& Img);
+template us1Pixel getMedian(const us1Image& Img);
+template us3Pixel getMedian(const us3Image& Img);
+template f1Pixel getMedian(const f1Image& Img);
+template f3Pixel getMedian(const f3Image& Img);
+template f4Pixel getMedian(const f4Image& Img);
+
+namespace {
+const int MedianBins = 256, MedianCoarse = 16; // Fine buckets, and coarse groups of 16 fine buckets
+
+// The Perreault-Hebert median filter of one channel quantized to bytes, Q, into Med. Each band of rows keeps a histogram
+// of each column of the window, updated by one row out and one row in per output row, and slides a window histogram
+// across each row by adding the column histogram entering it and subtracting the one leaving. Coarse histograms of
+// 16 buckets each find the median's group so the search looks at no more than 32 counts.
+void MedianFilterPlane(uint8_t* Med, const uint8_t* Q, const int w, const int h, const int radius)
+{
+    const int N = 2 * radius + 1;
+    const int rank = N * N / 2;
+
+    ParallelForRanges(h, std::max(4 * N, ConvertParallelPixels / w), [&](const int y0, const int y1) {
+        std::vector<uint16_t> Col(size_t(w) * MedianBins, 0), ColC(size_t(w) * MedianCoarse, 0);
+        auto addRow = [&](const int yy, const int d) {
+            const uint8_t* q = Q + size_t(std::clamp(yy, 0, h - 1)) * w;
+            for (int x = 0; x < w; x++) {
+                Col[size_t(x) * MedianBins + q[x]] += uint16_t(d);
+                ColC[size_t(x) * MedianCoarse + (q[x] >> 4)] += uint16_t(d);
+            }
+        };
+        for (int yy = y0 - radius; yy <= y0 + radius; yy++) addRow(yy, 1);
+
+        uint16_t H[MedianBins], HC[MedianCoarse];
+        for (int y = y0; y < y1; y++) {
+            if (y > y0) {
+                addRow(y - radius - 1, -1);
+                addRow(y + radius, 1);
+            }
+
+            std::fill(H, H + MedianBins, uint16_t(0));
+            std::fill(HC, HC + MedianCoarse, uint16_t(0));
+            for (int xx = -radius; xx <= radius; xx++) {
+                const size_t cx = std::clamp(xx, 0, w - 1);
+                for (int b = 0; b < MedianBins; b++) H[b] += Col[cx * MedianBins + b];
+                for (int b = 0; b < MedianCoarse; b++) HC[b] += ColC[cx * MedianCoarse + b];
+            }
+
+            uint8_t* out = Med + size_t(y) * w;
+            for (int x = 0; x < w; x++) {
+                if (x > 0) {
+                    const size_t xin = std::min(x + radius, w - 1), xout = std::max(x - radius - 1, 0);
+                    const uint16_t *ci = &Col[xin * MedianBins], *co = &Col[xout * MedianBins];
+                    for (int b = 0; b < MedianBins; b++) H[b] += uint16_t(ci[b] - co[b]);
+                    const uint16_t *cci = &ColC[xin * MedianCoarse], *cco = &ColC[xout * MedianCoarse];
+                    for (int b = 0; b < MedianCoarse; b++) HC[b] += uint16_t(cci[b] - cco[b]);
+                }
+
+                int64_t before, before2;
+                const int g = findRank(HC, MedianCoarse, rank, before);
+                out[x] = uint8_t(g * 16 + findRank(H + g * 16, 16, rank - before, before2));
+            }
+        }
+    });
+}
+}; // namespace
+
+template <class Image_T> void MedianFilter(Image_T& Out, const Image_T& Img, const int radius)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef typename Pixel_T::ElType Elem_T;
+    const int w = Img.w(), h = Img.h();
+    ASSERT_R(radius >= 0 && radius <= 127); // So the window counts fit in 16 bits
+
+    Pixel_T MinP, MaxP;
+    if constexpr (!std::is_same<Elem_T, unsigned char>::value) Img.GetMinMax(MinP, MaxP);
+
+    Out.SetSize(w, h);
+    if (Img.size() < 1) return;
+
+    std::vector<uint8_t> Q(size_t(w) * h), Med(size_t(w) * h);
+    for (int c = 0; c < Pixel_T::Chan; c++) {
+        float scale = 1.f, mn = 0.f;
+        if constexpr (!std::is_same<Elem_T, unsigned char>::value) {
+            mn = float(MinP[c]);
+            scale = MaxP[c] > MinP[c] ? float(MedianBins) / (float(MaxP[c]) - mn) : 0.f;
+        }
+        for (int y = 0; y < h; y++) {
+            uint8_t* q = &Q[size_t(y) * w];
+            if constexpr (std::is_same<Elem_T, unsigned char>::value)
+                for (int x = 0; x < w; x++) q[x] = Img(x, y)[c];
+            else
+                for (int x = 0; x < w; x++) q[x] = uint8_t(std::min(int((float(Img(x, y)[c]) - mn) * scale), MedianBins - 1));
+        }
+
+        MedianFilterPlane(Med.data(), Q.data(), w, h, radius);
+
+        for (int y = 0; y < h; y++) {
+            const uint8_t* m = &Med[size_t(y) * w];
+            if constexpr (std::is_same<Elem_T, unsigned char>::value)
+                for (int x = 0; x < w; x++) Out(x, y)[c] = m[x];
+            else if (scale > 0.f)
+                for (int x = 0; x < w; x++) Out(x, y)[c] = Elem_T(mn + (float(m[x]) + 0.5f) / scale);
+            else
+                for (int x = 0; x < w; x++) Out(x, y)[c] = MinP[c];
+        }
+    }
+}
+
+template void MedianFilter(uc1Image& Out, const uc1Image& Img, const int radius);
+template void MedianFilter(uc3Image& Out, const uc3Image& Img, const int radius);
+template void MedianFilter(uc4Image& Out, const uc4Image& Img, const int radius);
+template void MedianFilter(f1Image& Out, const f1Image& Img, const int radius);
+template void MedianFilter(f3Image& Out, const f3Image& Img, const int radius);
+template void MedianFilter(uc1ImageView& Out, const uc1ImageView& Img, const int radius);
+template void MedianFilter(uc3ImageView& Out, const uc3ImageView& Img, const int radius);
+template void MedianFilter(f1ImageView& Out, const f1ImageView& Img, const int radius);
+
+namespace {
+// Counts[c * NumBuckets + b] is the number of elements of channel c of h rows of w pixels that fall in bucket b.
+// Row(y) points to the elements of row y, which has PixEls elements per pixel, the first Chan of which are counted.
+//
+// The rows are split into one band per thread, and each band counts into its own histogram, padded to whole cache lines
+// so that no two threads write to the same line. Each histogram has an extra bucket per channel that the values out of
+// range go into, so the inner loop doesn't branch. Then the histograms are summed in parallel over the buckets. Byte and
+// short elements look up their bucket in a table made with the same arithmetic the float elements use, so the counts are
+// the same either way.
+template <class ImgEl_T, class Row_T>
+void countHistogram(std::vector<unsigned int>& Counts, const Row_T& Row, const int w, const int h, const int PixEls, const int Chan, const int NumBuckets,
+                    const float minc, const float maxc)
+{
+    ASSERT_R(NumBuckets > 0);
+    Counts.assign(size_t(Chan) * NumBuckets, 0);
+    if (w < 1 || h < 1) return;
+
+    const int NB1 = NumBuckets + 1; // Buckets per channel of a private histogram, including the one for out of range
+    const size_t Stride = (size_t(Chan) * NB1 + 15) & ~size_t(15); // 64 bytes of unsigned ints
+    const float scale = float(NumBuckets) / float(maxc - minc);
+    auto bucketOf = [&](const ImgEl_T v) {
+        const int b = int(float(v - minc) * scale);
+        return (b >= 0 && b < NumBuckets) ? b : NumBuckets;
+    };
+
+    constexpr bool Direct = std::is_same<ImgEl_T, unsigned char>::value || std::is_same<ImgEl_T, unsigned short>::value;
+    std::vector<int> Lut;
+    if constexpr (Direct) {
+        Lut.resize(size_t(std::numeric_limits<ImgEl_T>::max()) + 1);
+        for (size_t v = 0; v < Lut.size(); v++) Lut[v] = bucketOf(ImgEl_T(v));
+    }
+
+    const int64_t n = int64_t(w) * h;
+    const int Bands = int(std::clamp<int64_t>(n / ConvertParallelPixels, 1, std::min(h, std::max(1, int(std::thread::hardware_concurrency())))));
+    // Start the histograms on a cache line, as tImage does its rasters
+    const size_t LineEls = baseImage::RasterAlign / sizeof(unsigned int);
+    std::vector<unsigned int> PrivBuf(Stride * Bands + LineEls - 1, 0);
+    unsigned int* Priv = PrivBuf.data() + (LineEls - reinterpret_cast<uintptr_t>(PrivBuf.data()) / sizeof(unsigned int) % LineEls) % LineEls;
+    ParallelForRanges(Bands, 1, [&](const int b0, const int b1) {
+        for (int band = b0; band < b1; band++) {
+            unsigned int* H = &Priv[Stride * band];
+            for (int y = int(int64_t(h) * band / Bands); y < int(int64_t(h) * (band + 1) / Bands); y++) {
+                const ImgEl_T* r = Row(y);
+                for (int x = 0; x < w; x++, r += PixEls) {
+                    for (int c = 0; c < Chan; c++) {
+                        if constexpr (Direct)
+                            H[c * NB1 + Lut[r[c]]]++;
+                        else
+                            H[c * NB1 + bucketOf(r[c])]++;
+                    }
+                }
+            }
+        }
+    });
+
+    ParallelForRanges(Chan * NumBuckets, ConvertParallelPixels / Bands, [&](const int e0, const int e1) {
+        for (int e = e0; e < e1; e++) {
+            const size_t ind = size_t(e / NumBuckets) * NB1 + e % NumBuckets;
+            unsigned int sum = 0;
+            for (int band = 0; band < Bands; band++) sum += Priv[Stride * band + ind];
+            Counts[e] = sum;
+        }
+    });
+}
+
+template <class Image_T> void histogramCounts(std::vector<unsigned int>& Counts, const Image_T& Img, const int NumBuckets, const float minc, const float maxc)
+{
+    typedef typename Image_T::PixType::ElType ImgEl_T;
+    const int PixEls = int(sizeof(typename Image_T::PixType) / sizeof(ImgEl_T));
+    auto Row = [&](const int y) { return reinterpret_cast<const ImgEl_T*>(&Img(0, y)); };
+    countHistogram<ImgEl_T>(Counts, Row, Img.w(), Img.h(), PixEls, Img.chan(), NumBuckets, minc, maxc);
+}
+
+// Count one plane at a time, rather than striding through the channels of the pixels.
+template <class ImgPixel_T>
+void histogramCounts(std::vector<unsigned int>& Counts, const tPlanarImage<ImgPixel_T>& Img, const int NumBuckets, const float minc, const float maxc)
+{
+    typedef typename ImgPixel_T::ElType ImgEl_T;
+    Counts.resize(size_t(Img.chan()) * NumBuckets);
+    std::vector<unsigned int> PlaneCounts;
+    for (int c = 0; c < Img.chan(); c++) {
+        auto Row = [&](const int y) { return reinterpret_cast<const ImgEl_T*>(Img.plane(c).row(y)); };
+        countHistogram<ImgEl_T>(PlaneCounts, Row, Img.w(), Img.h(), 1, 1, NumBuckets, minc, maxc);
+        std::copy(PlaneCounts.begin(), PlaneCounts.end(), Counts.begin() + size_t(c) * NumBuckets);
+    }
+}
+}; // namespace
+
+template <class Pixel_T, class Image_T, class Elem_T>
+std::vector<Pixel_T> getHistogram(const Image_T& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc)
+{
+    std::vector<unsigned int> Counts;
+    histogramCounts(Counts, Img, NumBuckets, float(minc), float(maxc));
+
+    std::vector<Pixel_T> Hist(NumBuckets, Pixel_T(0));
+    for (int c = 0; c < Img.chan(); c++)
+        for (int b = 0; b < NumBuckets; b++) Hist[b][c] = Counts[size_t(c) * NumBuckets + b];
+
     return Hist;
 }
 
 // When calling, make sure the last two args are actual floats.
 template std::vector<ui1Pixel> getHistogram(const uc1Image& Img, const int NumBuckets, const float minc, const float maxc);
 template std::vector<ui3Pixel> getHistogram(const uc3Image& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const uc4Image& Img, const int NumBuckets, const float minc, const float maxc);
 template std::vector<ui1Pixel> getHistogram(const us1Image& Img, const int NumBuckets, const float minc, const float maxc);
 template std::vector<ui3Pixel> getHistogram(const us3Image& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const us4Image& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui1Pixel> getHistogram(const f1Image& Img, const int NumBuckets, const float minc, const float maxc);
 template std::vector<ui3Pixel> getHistogram(const f3Image& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const f4Image& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui1Pixel> getHistogram(const uc1ImageView& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui3Pixel> getHistogram(const uc3ImageView& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui3Pixel> getHistogram(const f3ImageView& Img, const int NumBuckets, const float minc, const float maxc);
+
+template <class Pixel_T, class ImgPixel_T, class Elem_T>
+std::vector<Pixel_T> getHistogram(const tPlanarImage<ImgPixel_T>& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc)
+{
+    std::vector<unsigned int> Counts;
+    histogramCounts(Counts, Img, NumBuckets, float(minc), float(maxc));
+
+    std::vector<Pixel_T> Hist(NumBuckets, Pixel_T(0));
+    for (int c = 0; c < Img.chan(); c++)
+        for (int b = 0; b < NumBuckets; b++) Hist[b][c] = Counts[size_t(c) * NumBuckets + b];
+
+    return Hist;
+}
+
+template std::vector<ui3Pixel> getHistogram(const uc3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const uc4PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui3Pixel> getHistogram(const us3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const us4PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui3Pixel> getHistogram(const f3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+template std::vector<ui4Pixel> getHistogram(const f4PlanarImage& Img, const int NumBuckets, const float minc, const float maxc);
+
+template <class Pixel_T, class Image_T, class Elem_T>
+std::vector<Pixel_T> getHistogramFraction(const Image_T& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc, const bool cumulative)
+{
+    std::vector<unsigned int> Counts;
+    histogramCounts(Counts, Img, NumBuckets, float(minc), float(maxc));
+
+    std::vector<Pixel_T> Hist(NumBuckets, Pixel_T(0));
+    const double inv = Img.size() ? 1.0 / double(Img.size()) : 0.0;
+    for (int c = 0; c < Img.chan(); c++) {
+        int64_t sum = 0;
+        for (int b = 0; b < NumBuckets; b++) {
+            const unsigned int k = Counts[size_t(c) * NumBuckets + b];
+            sum = cumulative ? sum + k : k;
+            Hist[b][c] = typename Pixel_T::ElType(double(sum) * inv);
+        }
+    }
+
+    return Hist;
+}
+
+template std::vector<f1Pixel> getHistogramFraction(const uc1Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const uc3Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f4Pixel> getHistogramFraction(const uc4Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f1Pixel> getHistogramFraction(const us1Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const us3Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f4Pixel> getHistogramFraction(const us4Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f1Pixel> getHistogramFraction(const f1Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const f3Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f4Pixel> getHistogramFraction(const f4Image& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const uc3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const us3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
+template std::vector<f3Pixel> getHistogramFraction(const f3PlanarImage& Img, const int NumBuckets, const float minc, const float maxc, const bool cumulative);
 
 template <class DstPixel_T, class SrcPixel_T> void CopyChan(tImage<DstPixel_T>& DstIm, const int dst_ch, const tImage<SrcPixel_T>& SrcIm, const int src_ch)
 {
     ASSERT_R(DstIm.w() == SrcIm.w() && DstIm.h() == SrcIm.h());
     ASSERT_R(src_ch < SrcIm.chan() && dst_ch < DstIm.chan());
 
-    for (int i = 0; i < DstIm.size(); i++) basePixel::channel_cast(DstIm[i][dst_ch], SrcIm[i][src_ch]);
+    for (int64_t i = 0; i < DstIm.size(); i++) basePixel::channel_cast(DstIm[i][dst_ch], SrcIm[i][src_ch]);
 }
 
 template void CopyChan(f1Image& DstIm, const int dst_ch, const f3Image& SrcIm, const int src_ch);
 
-// TODO: Make the per-pixel operation be generic by passing in a lambda
 template <class DstPixel_T, class SrcPixel_T>
-void CopyRect(tImage<DstPixel_T>& DstIm, const tImage<SrcPixel_T>& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
-              const int bhgt, const int mode, SrcPixel_T Key, float alpha)
+void CopyChan(tPlanarImage<DstPixel_T>& DstIm, const int dst_ch, const tPlanarImage<SrcPixel_T>& SrcIm, const int src_ch)
 {
+    ASSERT_R(DstIm.w() == SrcIm.w() && DstIm.h() == SrcIm.h());
+    ASSERT_R(src_ch < SrcIm.chan() && dst_ch < DstIm.chan());
+
+    ConvertImage(DstIm.plane(dst_ch), SrcIm.plane(src_ch));
+}
+
+template void CopyChan(f3PlanarImage& DstIm, const int dst_ch, const f3PlanarImage& SrcIm, const int src_ch);
+template void CopyChan(uc3PlanarImage& DstIm, const int dst_ch, const f3PlanarImage& SrcIm, const int src_ch);
+template void CopyChan(f3PlanarImage& DstIm, const int dst_ch, const uc3PlanarImage& SrcIm, const int src_ch);
+
+namespace {
+// Call RowOp(d, s, n) on each row of the bw x bh rectangle at bdx,bdy in DstIm and bsx,bsy in SrcIm, with d and s
+// pointing to the n = bw pixels of the rectangle in that row. Large rectangles run in bands of rows on multiple threads.
+template <class DstImage_T, class SrcImage_T, class RowOp_T>
+void forRectRows(DstImage_T& DstIm, const SrcImage_T& SrcIm, const int bsx, const int bsy, const int bdx, const int bdy, const int bw, const int bh,
+                 const RowOp_T& RowOp)
+{
+    DstIm.row(0); // Unshare the raster before the threads write rows of it
+    ParallelForRanges(bh, ConvertParallelPixels / bw, [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) RowOp(DstIm.row(bdy + y) + bdx, SrcIm.row(bsy + y) + bsx, bw);
+    });
+}
+
+// d[i] = a[i] + (b[i] - a[i]) * w for n pixels of C elements, which is linInterp(). w is alpha, or if perPixel, the
+// alpha channel of each pixel of b. d may be a.
+template <int C, class F_T> void lerpEls(F_T* d, const F_T* a, const F_T* b, const int n, const F_T alpha, const bool perPixel)
+{
+    if constexpr (C == 4) {
+        if (perPixel) {
+            for (int x = 0; x < n * C; x += C) {
+                const F_T w = b[x + 3];
+                for (int c = 0; c < C; c++) d[x + c] = a[x + c] + (b[x + c] - a[x + c]) * w;
+            }
+            return;
+        }
+    }
+    for (int i = 0; i < n * C; i++) d[i] = a[i] + (b[i] - a[i]) * alpha;
+}
+
+// d[x] = linInterp(d[x], s[x], w) for n pixels, with w as in lerpEls(). Pixels that aren't already FloatMathPixType are
+// converted to it a block at a time with ConvertPixels() and back, so that the conversions and the lerp all vectorize.
+template <class Pixel_T> void lerpRow(Pixel_T* d, const Pixel_T* s, const int n, const float alpha, const bool perPixel)
+{
+    typedef typename Pixel_T::FloatMathPixType F_T;
+    typedef typename F_T::ElType FEl_T;
+    const int C = Pixel_T::Chan;
+
+    if constexpr (std::is_same<Pixel_T, F_T>::value && sizeof(Pixel_T) == sizeof(FEl_T) * C) {
+        lerpEls<C>(reinterpret_cast<FEl_T*>(d), reinterpret_cast<const FEl_T*>(d), reinterpret_cast<const FEl_T*>(s), n, FEl_T(alpha), perPixel);
+    } else {
+        const int Block = 256;
+        F_T A[Block], B[Block];
+        for (int x = 0; x < n; x += Block) {
+            const int m = std::min(Block, n - x);
+            ConvertPixels(A, d + x, m);
+            ConvertPixels(B, s + x, m);
+            lerpEls<C>(reinterpret_cast<FEl_T*>(A), reinterpret_cast<const FEl_T*>(A), reinterpret_cast<const FEl_T*>(B), m, FEl_T(alpha), perPixel);
+            ConvertPixels(d + x, A, m);
+        }
+    }
+}
+}; // namespace
+
+template <class DstImage_T, class SrcImage_T>
+void CopyRect(DstImage_T& DstIm, const SrcImage_T& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid, const int bhgt,
+              const int mode, typename SrcImage_T::PixType Key, float alpha)
+{
+    typedef typename DstImage_T::PixType DstPixel_T;
+    typedef typename SrcImage_T::PixType SrcPixel_T;
+    typedef typename SrcPixel_T::ElType SrcEl_T;
+    const bool SameType = std::is_same<DstPixel_T, SrcPixel_T>::value;
+
     if (bwid <= 0 || bhgt <= 0 || DstIm.size() <= 0 || SrcIm.size() <= 0) return;
 
     // Compute transformation from src to dst.
@@ -191,37 +822,61 @@ void CopyRect(tImage<DstPixel_T>& DstIm, const tImage<SrcPixel_T>& SrcIm, const
     bsx = bdx - stodx;
     bsy = bdy - stody;
 
-    int srcxmax = bsx + bw;
-    int srcymax = bsy + bh;
-
-    int chan = Key[0];
-
-    for (int sy = bsy, dy = bdy; sy < srcymax; sy++, dy++) {
-        for (int sx = bsx, dx = bdx; sx < srcxmax; sx++, dx++) {
-            if (mode == 0) // Pixel Copy
-                DstIm(dx, dy) = static_cast<DstPixel_T>(SrcIm(sx, sy));
-            else if (mode == 1) { // OVER Operator with per-pixel alpha
-                typename DstPixel_T::FloatMathPixType srcpix(SrcIm(sx, sy));
-                typename DstPixel_T::FloatMathType srcalpha(srcpix[3]);
-                DstIm(dx, dy) = linInterp(DstIm(dx, dy), SrcIm(sx, sy), srcalpha);
-            } else if (mode == 2) { // Color key BLIT
-                // This one makes white and off-white be transparent. Should turn this into alpha.
-                if (SrcIm(sx, sy) != Key) DstIm(dx, dy) = static_cast<DstPixel_T>(SrcIm(sx, sy));
-                // if ((Key - SrcIm(sx, sy)).max_chan() > 25) DstIm(dx, dy) = static_cast<DstPixel_T>(SrcIm(sx, sy));
-            } else if (mode == 3) { // Adobe Multiply mode (alpha lerp between dst and src*dst)
-                typename DstPixel_T::FloatMathPixType srcpix(SrcIm(sx, sy));
-                typename DstPixel_T::FloatMathPixType dstpix(DstIm(dx, dy));
-                typename DstPixel_T::FloatMathType srcalpha(srcpix[3]);
-                typename DstPixel_T::FloatMathPixType mp(srcpix * dstpix);
-                DstIm(dx, dy) = linInterp(dstpix, mp, srcalpha);
-            } else if (mode == 4) { // OVER Operator with constant alpha
-                DstIm(dx, dy) = linInterp(DstIm(dx, dy), SrcIm(sx, sy), alpha);
-            } else if (mode == 5) { // Adding pixels
-                DstIm(dx, dy) = DstIm(dx, dy) + SrcIm(sx, sy);
-            } else if (mode == 6) { // Copy one channel
-                DstIm(dx, dy)[chan] = SrcIm(sx, sy)[chan];
-            }
+    // The mode is chosen once here, and each case runs a whole row at a time.
+    auto forRect = [&](const auto& RowOp) { forRectRows(DstIm, SrcIm, bsx, bsy, bdx, bdy, bw, bh, RowOp); };
+    auto forRectPixels = [&](const auto& PixOp) {
+        forRect([&](DstPixel_T* d, const SrcPixel_T* s, const int n) {
+            for (int x = 0; x < n; x++) PixOp(d[x], s[x]);
+        });
+    };
+
+    switch (mode) {
+    case 0: // Pixel Copy
+        forRect([](DstPixel_T* d, const SrcPixel_T* s, const int n) { ConvertPixels(d, s, size_t(n)); });
+        break;
+    case 1: // OVER Operator with per-pixel alpha
+    case 4: // OVER Operator with constant alpha
+        if constexpr (SameType) {
+            ASSERT_R(mode == 4 || DstPixel_T::Chan == 4);
+            forRect([&](DstPixel_T* d, const SrcPixel_T* s, const int n) { lerpRow(d, s, n, alpha, mode == 1); });
+        } else {
+            forRectPixels([&](DstPixel_T& d, const SrcPixel_T& s) {
+                const typename DstPixel_T::FloatMathType w = mode == 1 ? typename DstPixel_T::FloatMathPixType(s)[3] : alpha;
+                d = linInterp(d, s, w);
+            });
         }
+        break;
+    case 2: // Color key BLIT
+        // This one makes white and off-white be transparent. Should turn this into alpha.
+        forRect([&](DstPixel_T* d, const SrcPixel_T* s, const int n) {
+            if constexpr (SameType && (std::is_same<SrcEl_T, unsigned char>::value || std::is_same<SrcEl_T, unsigned short>::value))
+                if (SIMDKeyedCopy(d, s, size_t(n), &Key, sizeof(SrcPixel_T))) return;
+            for (int x = 0; x < n; x++)
+                if (s[x] != Key) d[x] = static_cast<DstPixel_T>(s[x]);
+        });
+        break;
+    case 3: // Adobe Multiply mode (alpha lerp between dst and src*dst)
+        ASSERT_R(SrcPixel_T::Chan == 4);
+        forRectPixels([](DstPixel_T& d, const SrcPixel_T& s) {
+            typename DstPixel_T::FloatMathPixType srcpix(s);
+            typename DstPixel_T::FloatMathPixType dstpix(d);
+            typename DstPixel_T::FloatMathType srcalpha(srcpix[3]);
+            typename DstPixel_T::FloatMathPixType mp(srcpix * dstpix);
+            d = linInterp(dstpix, mp, srcalpha);
+        });
+        break;
+    case 5: // Adding pixels
+        forRect([](DstPixel_T* d, const SrcPixel_T* s, const int n) {
+            if constexpr (SameType && sizeof(DstPixel_T) == sizeof(SrcEl_T) * DstPixel_T::Chan)
+                if (SIMDElemOp(ELEM_ADD, reinterpret_cast<SrcEl_T*>(d), reinterpret_cast<const SrcEl_T*>(s), size_t(n) * DstPixel_T::Chan)) return;
+            for (int x = 0; x < n; x++) d[x] = d[x] + s[x];
+        });
+        break;
+    case 6: { // Copy one channel
+        const int chan = Key[0];
+        forRectPixels([chan](DstPixel_T& d, const SrcPixel_T& s) { d[chan] = s[chan]; });
+        break;
+    }
     }
 }
 
@@ -237,6 +892,18 @@ template void CopyRect(uc3Image& DstIm, const uc3Image& SrcIm, const int srcx, c
                        const int mode, uc3Image ::PixType, const float alpha);
 template void CopyRect(uc4Image& DstIm, const uc4Image& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid, const int bhgt,
                        const int mode, uc4Image ::PixType, const float alpha);
+template void CopyRect(f1ImageView& DstIm, const f1ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, f1Image ::PixType, const float alpha);
+template void CopyRect(f3ImageView& DstIm, const f3ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, f3Image ::PixType, const float alpha);
+template void CopyRect(f4ImageView& DstIm, const f4ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, f4Image ::PixType, const float alpha);
+template void CopyRect(uc1ImageView& DstIm, const uc1ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, uc1Image ::PixType, const float alpha);
+template void CopyRect(uc3ImageView& DstIm, const uc3ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, uc3Image ::PixType, const float alpha);
+template void CopyRect(uc4ImageView& DstIm, const uc4ImageView& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
+                       const int bhgt, const int mode, uc4Image ::PixType, const float alpha);
 
 template <class KernelImage_T> KernelImage_T MakeGaussianKernel(const int N, const typename KernelImage_T::PixType::ElType sigma)
 {
@@ -261,6 +928,8 @@ template <class KernelImage_T> KernelImage_T MakeGaussianKernel(const int N, con
     return Kernel;
 }
 
+template f1Image MakeGaussianKernel<f1Image>(const int N, const float sigma);
+
 namespace {
 // Sample the image with the kernel. Divide by sum of covered weights.
 template <class Image_T, class KernelImage_T>
@@ -276,7 +945,7 @@ DMC_DECL typename Image_T::PixType sample_kernel_weighted(const Image_T& Img, co
     int yl = std::max(yc - N2, 0), yh = std::min(yc + N2, Img.h() - 1);
     for (int y = yl; y <= yh; y++) {
         for (int x = xl; x <= xh; x++) {
-            typename KernelImage_T::PixType::ElType K = Kernel(xc - x + N2, yc - y + N2);
+            typename KernelImage_T::PixType::ElType K = Kernel(x - xc + N2, y - yc + N2);
             sum += Img(x, y) * K;
             weight += K;
         }
@@ -331,120 +1000,585 @@ DMC_DECL typename Image_T::PixType sample_kernel_fullN(const Image_T& Img, const
     return sum;
 }
 
-// Convolve the parts of the image where the kernel is fully inside. This should be fast.
-template <class Image_T, class KernelImage_T> void ConvolveMiddle(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
+// Convolve the pixels in [x0, x1) x [y0, y1), where the kernel must be fully inside the image. This should be fast.
+template <class Image_T, class KernelImage_T>
+void ConvolveMiddle(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const int x0, const int y0, const int x1, const int y1)
 {
-    const int N = Kernel.w();
-    const int N2 = N / 2;
-    const int wid = In.w(), hgt = In.h();
-    for (int y = N2; y < hgt - N2; y++) {
-        for (int x = N2; x < wid - N2; x++) { Out(x, y) = sample_kernel_full(In, Kernel, x, y); }
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) { Out(x, y) = sample_kernel_full(In, Kernel, x, y); }
     }
 }
 
 // Kernel width, N, is known at compile time.
-template <class Image_T, class KernelImage_T, int N> void ConvolveMiddleN(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
+template <class Image_T, class KernelImage_T, int N>
+void ConvolveMiddleN(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const int x0, const int y0, const int x1, const int y1)
 {
-    const int N2 = N / 2;
     ASSERT_R((Kernel.w() == N));
-    const int wid = In.w(), hgt = In.h();
 
-    // Do center.
-    for (int y = N2; y < hgt - N2; y++) {
-        for (int x = N2; x < wid - N2; x++) { Out(x, y) = sample_kernel_fullN<Image_T, KernelImage_T, N>(In, Kernel, x, y); }
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) { Out(x, y) = sample_kernel_fullN<Image_T, KernelImage_T, N>(In, Kernel, x, y); }
     }
 }
 
 // Specialization for f1Image, 5.
 // Uses direct pixel access and loop unrolling for big speedup.
-template <> void ConvolveMiddleN<f1Image, f1Image, 5>(f1Image& Out, const f1Image& In, const f1Image& Kernel)
+template <>
+void ConvolveMiddleN<f1Image, f1Image, 5>(f1Image& Out, const f1Image& In, const f1Image& Kernel, const int x0, const int y0, const int x1, const int y1)
 {
-    float* OutP = (float*)Out.pv();
-    const float* InP = (const float*)In.pv();
     const float* KP = (const float*)Kernel.pv();
 
-    const int wid = In.w(), hgt = In.h();
-    for (int y = 2; y < hgt - 2; y++) {
-        for (int x = 2; x < wid - 2; x++) {
+    for (int y = y0; y < y1; y++) {
+        // Rows may be padded, so step through the rows by their pointers.
+        const float* InM2 = (const float*)In.row(y - 2);
+        const float* InM1 = (const float*)In.row(y - 1);
+        const float* In0 = (const float*)In.row(y);
+        const float* InP1 = (const float*)In.row(y + 1);
+        const float* InP2 = (const float*)In.row(y + 2);
+        float* OutP = (float*)Out.row(y);
+        for (int x = x0; x < x1; x++) {
             float sum = 0;
 
-            sum += KP[0] * InP[(y - 2) * wid + x - 2];
-            sum += KP[1] * InP[(y - 2) * wid + x - 1];
-            sum += KP[2] * InP[(y - 2) * wid + x];
-            sum += KP[3] * InP[(y - 2) * wid + x + 1];
-            sum += KP[4] * InP[(y - 2) * wid + x + 2];
+            sum += KP[0] * InM2[x - 2];
+            sum += KP[1] * InM2[x - 1];
+            sum += KP[2] * InM2[x];
+            sum += KP[3] * InM2[x + 1];
+            sum += KP[4] * InM2[x + 2];
+
+            sum += KP[5] * InM1[x - 2];
+            sum += KP[6] * InM1[x - 1];
+            sum += KP[7] * InM1[x];
+            sum += KP[8] * InM1[x + 1];
+            sum += KP[9] * InM1[x + 2];
+
+            sum += KP[10] * In0[x - 2];
+            sum += KP[11] * In0[x - 1];
+            sum += KP[12] * In0[x];
+            sum += KP[13] * In0[x + 1];
+            sum += KP[14] * In0[x + 2];
+
+            sum += KP[15] * InP1[x - 2];
+            sum += KP[16] * InP1[x - 1];
+            sum += KP[17] * InP1[x];
+            sum += KP[18] * InP1[x + 1];
+            sum += KP[19] * InP1[x + 2];
+
+            sum += KP[20] * InP2[x - 2];
+            sum += KP[21] * InP2[x - 1];
+            sum += KP[22] * InP2[x];
+            sum += KP[23] * InP2[x + 1];
+            sum += KP[24] * InP2[x + 2];
+
+            OutP[x] = sum;
+        }
+    }
+}
+
+// Convolve the pixels in [x0, x1) x [y0, y1). Those where the kernel is fully inside the image, [xmid0, xmid1) x [ymid0, ymid1),
+// use the fast sum; the rest use the renormalized one.
+template <class Image_T, class KernelImage_T>
+void ConvolveTile(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const int x0, const int y0, const int x1, const int y1, const int xmid0,
+                  const int ymid0, const int xmid1, const int ymid1)
+{
+    const int N = Kernel.w();
+    const int mx0 = std::max(x0, xmid0), mx1 = std::min(x1, xmid1);
+    const int my0 = std::max(y0, ymid0), my1 = std::min(y1, ymid1);
+    const bool hasMiddle = mx0 < mx1 && my0 < my1;
+
+    // Do the edges.
+    for (int y = y0; y < y1; y++) {
+        if (hasMiddle && y >= my0 && y < my1) {
+            for (int x = x0; x < mx0; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
+            for (int x = mx1; x < x1; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
+        } else {
+            for (int x = x0; x < x1; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
+        }
+    }
 
-            sum += KP[5] * InP[(y - 1) * wid + x - 2];
-            sum += KP[6] * InP[(y - 1) * wid + x - 1];
-            sum += KP[7] * InP[(y - 1) * wid + x];
-            sum += KP[8] * InP[(y - 1) * wid + x + 1];
-            sum += KP[9] * InP[(y - 1) * wid + x + 2];
+    if (!hasMiddle) return;
+    if (N == 5)
+        ConvolveMiddleN<Image_T, KernelImage_T, 5>(Out, In, Kernel, mx0, my0, mx1, my1); // If kernel size is known at compile time.
+    else if (N == 9)
+        ConvolveMiddleN<Image_T, KernelImage_T, 9>(Out, In, Kernel, mx0, my0, mx1, my1); // If kernel size is known at compile time.
+    else
+        ConvolveMiddle(Out, In, Kernel, mx0, my0, mx1, my1); // If kernel size is not known at compile time.
+}
+}; // namespace
 
-            sum += KP[10] * InP[(y)*wid + x - 2];
-            sum += KP[11] * InP[(y)*wid + x - 1];
-            sum += KP[12] * InP[(y)*wid + x];
-            sum += KP[13] * InP[(y)*wid + x + 1];
-            sum += KP[14] * InP[(y)*wid + x + 2];
+// The image is cut into tiles that run on multiple threads. A tile reads the pixels of its halo, N/2 wide, straight
+// from In, so each output pixel is computed exactly as if the whole image were done at once.
+template <class Image_T, class KernelImage_T> void ConvolveImageDirect(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
+{
+    const int N = Kernel.w();
+    const int N2 = N / 2;
+    ASSERT_R((N & 1) && N >= 3); // Filter must be an odd width so it can center on a pixel.
+    const int wid = In.w(), hgt = In.h();
+    Out.SetSize(wid, hgt);
 
-            sum += KP[15] * InP[(y + 1) * wid + x - 2];
-            sum += KP[16] * InP[(y + 1) * wid + x - 1];
-            sum += KP[17] * InP[(y + 1) * wid + x];
-            sum += KP[18] * InP[(y + 1) * wid + x + 1];
-            sum += KP[19] * InP[(y + 1) * wid + x + 2];
+    // The rows and columns where the kernel is fully inside. They may be empty if the kernel is bigger than the image.
+    const int ymid0 = std::min(N2, hgt), ymid1 = std::max(ymid0, hgt - N2);
+    const int xmid0 = std::min(N2, wid), xmid1 = std::max(xmid0, wid - N2);
+
+    // A tile and its halo of a few kernel rows stay in the L2 cache. Every tile is enough work for a thread.
+    const int TileW = 256, TileH = 64;
+    const int tilesX = (wid + TileW - 1) / TileW, tilesY = (hgt + TileH - 1) / TileH;
+    ParallelForRanges(tilesX * tilesY, 1, [&](const int t0, const int t1) {
+        for (int t = t0; t < t1; t++) {
+            const int x0 = (t % tilesX) * TileW, y0 = (t / tilesX) * TileH;
+            ConvolveTile(Out, In, Kernel, x0, y0, std::min(x0 + TileW, wid), std::min(y0 + TileH, hgt), xmid0, ymid0, xmid1, ymid1);
+        }
+    });
+}
 
-            sum += KP[20] * InP[(y + 2) * wid + x - 2];
-            sum += KP[21] * InP[(y + 2) * wid + x - 1];
-            sum += KP[22] * InP[(y + 2) * wid + x];
-            sum += KP[23] * InP[(y + 2) * wid + x + 1];
-            sum += KP[24] * InP[(y + 2) * wid + x + 2];
+template void ConvolveImageDirect(f1Image& Out, const f1Image& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f3Image& Out, const f3Image& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f4Image& Out, const f4Image& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f1ImageView& Out, const f1ImageView& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f3ImageView& Out, const f3ImageView& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f4ImageView& Out, const f4ImageView& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f1TiledImage& Out, const f1TiledImage& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f3TiledImage& Out, const f3TiledImage& In, const f1Image& Kernel);
+template void ConvolveImageDirect(f4TiledImage& Out, const f4TiledImage& In, const f1Image& Kernel);
 
-            OutP[y * wid + x] = sum;
+namespace {
+// Choose the power-of-two FFT size for tiles along an image axis of len pixels with an N tap kernel.
+// Each tile of T pixels yields T - N + 1 output pixels. Bigger tiles waste less on overlap but cost more per pixel
+// to transform, so take the size with the least total work, counting the loads, product, and stores as three passes.
+int FFTConvolveTileSize(const int len, const int N)
+{
+    int T = 1;
+    while (T < N) T *= 2;
+
+    int bestT = T;
+    double bestCost = std::numeric_limits<double>::max();
+    for (; T <= std::max(1024, 2 * bestT); T *= 2) {
+        const int numTiles = (len + T - N) / (T - N + 1);
+        const double cost = double(numTiles) * T * (log2(double(T)) + 3.0);
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestT = T;
         }
+        if (numTiles == 1) break;
     }
+    return bestT;
 }
 }; // namespace
 
-template <class Image_T, class KernelImage_T> void ConvolveImage(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
+template <class Image_T, class KernelImage_T> void ConvolveImageFFT(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
 {
+    typedef typename Image_T::PixType::ElType ElT;
     const int N = Kernel.w();
     const int N2 = N / 2;
     ASSERT_R((N & 1) && N >= 3); // Filter must be an odd width so it can center on a pixel.
+    const int C = Image_T::PixType::Chan;
     const int wid = In.w(), hgt = In.h();
     Out.SetSize(wid, hgt);
+    if (wid < 1 || hgt < 1) return;
+
+    // Output pixels ox..ox+Bw-1 of a tile come from input pixels ox-N2..ox-N2+Tw-1 without wrapping around.
+    const int Tw = FFTConvolveTileSize(wid, N), Th = FFTConvolveTileSize(hgt, N);
+    const int Bw = Tw - N + 1, Bh = Th - N + 1;
+    const int tilesX = (wid + Bw - 1) / Bw, tilesY = (hgt + Bh - 1) / Bh;
+    const size_t tileEls = size_t(Tw) * Th;
+    const FFT2D F(Tw, Th);
+
+    // The spectrum of the kernel reflected through the origin, so that the product computes ConvolveMiddle()'s sum,
+    // and scaled to undo the gain of the inverse transform
+    std::vector<std::complex<float>> KF(tileEls);
+    for (int yk = 0; yk < N; yk++)
+        for (int xk = 0; xk < N; xk++) KF[size_t((Th - yk) % Th) * Tw + (Tw - xk) % Tw] = float(Kernel(xk, yk)[0]) / float(tileEls);
+    F.Forward(KF.data());
+
+    // Summed-area table of the kernel, for the weight of the part of it that covers the image near the edges
+    std::vector<double> KSum(size_t(N + 1) * (N + 1), 0.0);
+    for (int yk = 0; yk < N; yk++)
+        for (int xk = 0; xk < N; xk++)
+            KSum[(yk + 1) * (N + 1) + xk + 1] = Kernel(xk, yk)[0] + KSum[yk * (N + 1) + xk + 1] + KSum[(yk + 1) * (N + 1) + xk] - KSum[yk * (N + 1) + xk];
+    auto coveredWeight = [&](const int x, const int y) {
+        const int kx0 = std::max(0, N2 - x), kx1 = std::min(N, wid + N2 - x);
+        const int ky0 = std::max(0, N2 - y), ky1 = std::min(N, hgt + N2 - y);
+        return KSum[ky1 * (N + 1) + kx1] - KSum[ky0 * (N + 1) + kx1] - KSum[ky1 * (N + 1) + kx0] + KSum[ky0 * (N + 1) + kx0];
+    };
+
+    // Each job is one channel of one tile. Since the kernel is real, one complex transform does two jobs at once,
+    // one in the real parts and one in the imaginary parts.
+    const int numJobs = tilesX * tilesY * C, numPairs = (numJobs + 1) / 2;
+    ParallelForRanges(numPairs, 1, [&](const int p0, const int p1) {
+        std::vector<std::complex<float>> A(tileEls);
+        float* Af = reinterpret_cast<float*>(A.data());
+
+        for (int p = p0; p < p1; p++) {
+            for (int part = 0; part < 2; part++) {
+                const int j = 2 * p + part, t = j / C, c = j % C;
+                const int ox = (t % tilesX) * Bw - N2, oy = (t / tilesX) * Bh - N2;
+                for (int v = 0; v < Th; v++) {
+                    float* a = Af + size_t(v) * Tw * 2 + part;
+                    const int y = oy + v;
+                    const int u0 = (j < numJobs && y >= 0 && y < hgt) ? clamp(-ox, 0, Tw) : Tw, u1 = std::max(u0, std::min(Tw, wid - ox));
+                    for (int u = 0; u < u0; u++) a[u * 2] = 0;
+                    for (int u = u0; u < u1; u++) a[u * 2] = static_cast<float>(In(ox + u, y)[c]);
+                    for (int u = u1; u < Tw; u++) a[u * 2] = 0;
+                }
+            }
 
-    // Do top and bottom edges.
-    for (int y = 0; y < N2; y++)
-        for (int x = N2; x < wid - N2; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
-    for (int y = hgt - N2; y < hgt; y++)
-        for (int x = N2; x < wid - N2; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
+            F.Forward(A.data());
+            for (size_t i = 0; i < tileEls; i++) {
+                const std::complex<float> a = A[i], k = KF[i];
+                A[i] = std::complex<float>(a.real() * k.real() - a.imag() * k.imag(), a.real() * k.imag() + a.imag() * k.real());
+            }
+            F.Inverse(A.data());
+
+            for (int part = 0; part < 2 && 2 * p + part < numJobs; part++) {
+                const int j = 2 * p + part, t = j / C, c = j % C;
+                const int ox = (t % tilesX) * Bw, oy = (t / tilesX) * Bh;
+                for (int y = oy; y < std::min(oy + Bh, hgt); y++) {
+                    const float* a = Af + size_t(y - oy) * Tw * 2 + part;
+                    const bool edgeRow = y < N2 || y >= hgt - N2;
+                    for (int x = ox; x < std::min(ox + Bw, wid); x++) {
+                        float s = a[(x - ox) * 2];
+                        if (edgeRow || x < N2 || x >= wid - N2) s = float(s / coveredWeight(x, y));
+                        Out(x, y)[c] = static_cast<ElT>(s);
+                    }
+                }
+            }
+        }
+    });
+}
 
-    // Do left and right edges.
-    for (int y = 0; y < hgt; y++) {
-        for (int x = 0; x < N2; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
-        for (int x = wid - N2; x < wid; x++) Out(x, y) = sample_kernel_weighted(In, Kernel, x, y);
-    }
+template void ConvolveImageFFT(f1Image& Out, const f1Image& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f3Image& Out, const f3Image& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f4Image& Out, const f4Image& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f1ImageView& Out, const f1ImageView& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f3ImageView& Out, const f3ImageView& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f4ImageView& Out, const f4ImageView& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f1TiledImage& Out, const f1TiledImage& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f3TiledImage& Out, const f3TiledImage& In, const f1Image& Kernel);
+template void ConvolveImageFFT(f4TiledImage& Out, const f4TiledImage& In, const f1Image& Kernel);
 
-    if (N == 5)
-        ConvolveMiddleN<Image_T, KernelImage_T, 5>(Out, In, Kernel); // If kernel size is known at compile time.
-    else if (N == 9)
-        ConvolveMiddleN<Image_T, KernelImage_T, 9>(Out, In, Kernel); // If kernel size is known at compile time.
+template <class Image_T, class KernelImage_T> void ConvolveImage(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel)
+{
+    if (Kernel.w() >= ConvolveFFTMinWidth)
+        ConvolveImageFFT(Out, In, Kernel);
     else
-        ConvolveMiddle(Out, In, Kernel); // If kernel size is not known at compile time.
+        ConvolveImageDirect(Out, In, Kernel);
 }
 
-// Gaussian blur for any image type; filtWid must be odd.
-template <class Image_T> void GaussianBlur(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::MathType stdev)
+template void ConvolveImage(f1Image& Out, const f1Image& In, const f1Image& Kernel);
+template void ConvolveImage(f3Image& Out, const f3Image& In, const f1Image& Kernel);
+template void ConvolveImage(f4Image& Out, const f4Image& In, const f1Image& Kernel);
+template void ConvolveImage(f1ImageView& Out, const f1ImageView& In, const f1Image& Kernel);
+template void ConvolveImage(f3ImageView& Out, const f3ImageView& In, const f1Image& Kernel);
+template void ConvolveImage(f4ImageView& Out, const f4ImageView& In, const f1Image& Kernel);
+template void ConvolveImage(f1TiledImage& Out, const f1TiledImage& In, const f1Image& Kernel);
+template void ConvolveImage(f3TiledImage& Out, const f3TiledImage& In, const f1Image& Kernel);
+template void ConvolveImage(f4TiledImage& Out, const f4TiledImage& In, const f1Image& Kernel);
+
+namespace {
+// Normalized 1D Gaussian of N taps. Its outer product with itself is MakeGaussianKernel(N, sigma).
+std::vector<float> MakeGaussianKernel1D(const int N, const float sigma)
+{
+    const int N2 = N / 2;
+    std::vector<float> K(N);
+    float Sum = 0;
+    for (int i = -N2; i <= N2; i++) Sum += K[i + N2] = float(Gaussian(double(i), double(sigma)));
+    for (int i = 0; i < N; i++) K[i] /= Sum;
+    return K;
+}
+
+// Row y of Img as elements converted to float, but not normalized, so integer pixels keep their full precision.
+template <class Image_T> void BlurLoadRow(float* d, const Image_T& Img, const int y)
+{
+    const int C = Image_T::PixType::Chan;
+    for (int x = 0; x < Img.w(); x++) {
+        const typename Image_T::PixType& p = Img(x, y);
+        for (int c = 0; c < C; c++) d[x * C + c] = static_cast<float>(p[c]);
+    }
+}
+
+// Store float elements to row y of Img. Integer elements are rounded and clamped to their range.
+template <class Image_T> void BlurStoreRow(Image_T& Img, const int y, const float* s)
+{
+    typedef typename Image_T::PixType::ElType ElT;
+    const int C = Image_T::PixType::Chan;
+    for (int x = 0; x < Img.w(); x++) {
+        typename Image_T::PixType& p = Img(x, y);
+        for (int c = 0; c < C; c++) {
+            if constexpr (std::is_integral_v<ElT>)
+                p[c] = static_cast<ElT>(clamp(s[x * C + c], 0.f, float(std::numeric_limits<ElT>::max())) + 0.5f);
+            else
+                p[c] = static_cast<ElT>(s[x * C + c]);
+        }
+    }
+}
+
+// Convolve a row of wid pixels of C float elements each with the 1D kernel K.
+// Taps that fall off the ends are dropped and the rest renormalized. Since the 2D Gaussian is separable, doing this
+// in both passes gives the same result as ConvolveImage's sample_kernel_weighted() with the 2D kernel.
+void BlurRow(float* d, const float* s, const int wid, const int C, const std::vector<float>& K)
+{
+    const int N = int(K.size()), N2 = N / 2;
+
+    const int mid0 = std::min(N2, wid), mid1 = std::max(mid0, wid - N2);
+    if (mid1 > mid0 && !SIMDConvolveRow(d + mid0 * C, s + mid0 * C, size_t(mid1 - mid0) * C, C, K.data(), N)) {
+        for (int i = mid0 * C; i < mid1 * C; i++) {
+            float sum = 0;
+            for (int k = 0; k < N; k++) sum += K[k] * s[i + (k - N2) * C];
+            d[i] = sum;
+        }
+    }
+
+    auto edge = [&](const int x) {
+        const int kl = std::max(0, N2 - x), kh = std::min(N, wid + N2 - x);
+        float weight = 0;
+        for (int k = kl; k < kh; k++) weight += K[k];
+        for (int c = 0; c < C; c++) {
+            float sum = 0;
+            for (int k = kl; k < kh; k++) sum += K[k] * s[(x + k - N2) * C + c];
+            d[x * C + c] = sum / weight;
+        }
+    };
+    for (int x = 0; x < mid0; x++) edge(x);
+    for (int x = mid1; x < wid; x++) edge(x);
+}
+
+// Row y of the column pass over the hgt rows of Tmp, each rowEls floats long
+void BlurCol(float* d, const std::vector<float>& Tmp, const int y, const int hgt, const size_t rowEls, const std::vector<float>& K)
+{
+    const int N = int(K.size()), N2 = N / 2;
+    const float* rows[256];
+    std::vector<const float*> bigRows;
+    const float** R = rows;
+    if (N > 256) {
+        bigRows.resize(N);
+        R = bigRows.data();
+    }
+
+    const int kl = std::max(0, N2 - y), kh = std::min(N, hgt + N2 - y);
+    for (int k = kl; k < kh; k++) R[k - kl] = Tmp.data() + size_t(y + k - N2) * rowEls;
+
+    // Near the top and bottom, renormalize the taps that are inside the image.
+    const float* Kp = K.data() + kl;
+    std::vector<float> Kedge;
+    if (kh - kl < N) {
+        float weight = 0;
+        for (int k = kl; k < kh; k++) weight += K[k];
+        Kedge.resize(kh - kl);
+        for (int k = kl; k < kh; k++) Kedge[k - kl] = K[k] / weight;
+        Kp = Kedge.data();
+    }
+
+    if (!SIMDConvolveCol(d, R, rowEls, Kp, kh - kl)) {
+        for (size_t i = 0; i < rowEls; i++) {
+            float sum = 0;
+            for (int k = 0; k < kh - kl; k++) sum += Kp[k] * R[k][i];
+            d[i] = sum;
+        }
+    }
+}
+}; // namespace
+
+// Separable Gaussian blur for any image type; filtWid must be odd.
+// A row pass into a float buffer, then a column pass back to Out, each split across threads by rows.
+// Since In is only read by the first pass, Out may be In.
+template <class Image_T> void GaussianBlur(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::FloatMathType stdev)
 {
     ASSERT_R((filtWid & 1) && filtWid >= 3); // Filter must be an odd width so it can center on a pixel.
 
-    typedef tPixel<typename Image_T::PixType::ElType, 1> KernelPixelType;
-    typedef tImage<KernelPixelType> KernelImageType;
+    const int C = Image_T::PixType::Chan;
+    const int wid = In.w(), hgt = In.h();
+    const size_t rowEls = size_t(wid) * C;
+    if (wid < 1 || hgt < 1) {
+        Out.SetSize(wid, hgt);
+        return;
+    }
 
-    KernelImageType Kernel = MakeGaussianKernel<KernelImageType>(filtWid, stdev);
+    const std::vector<float> K = MakeGaussianKernel1D(filtWid, float(stdev));
+    const int grain = std::max(1, ConvertParallelPixels / wid);
+
+    std::vector<float> Tmp(rowEls * hgt);
+    ParallelForRanges(hgt, grain, [&](const int y0, const int y1) {
+        std::vector<float> Row(rowEls);
+        for (int y = y0; y < y1; y++) {
+            BlurLoadRow(Row.data(), In, y);
+            BlurRow(Tmp.data() + y * rowEls, Row.data(), wid, C, K);
+        }
+    });
 
-    ConvolveImage(Out, In, Kernel);
+    Out.SetSize(wid, hgt);
+    ParallelForRanges(hgt, grain, [&](const int y0, const int y1) {
+        std::vector<float> Row(rowEls);
+        for (int y = y0; y < y1; y++) {
+            BlurCol(Row.data(), Tmp, y, hgt, rowEls, K);
+            BlurStoreRow(Out, y, Row.data());
+        }
+    });
 }
 
 template void GaussianBlur<f1Image>(f1Image& Out, const f1Image& In, const int filtWid, float stdev);
 template void GaussianBlur<f3Image>(f3Image& Out, const f3Image& In, const int filtWid, float stdev);
 template void GaussianBlur<f4Image>(f4Image& Out, const f4Image& In, const int filtWid, float stdev);
+template void GaussianBlur<uc1Image>(uc1Image& Out, const uc1Image& In, const int filtWid, float stdev);
+template void GaussianBlur<uc3Image>(uc3Image& Out, const uc3Image& In, const int filtWid, float stdev);
+template void GaussianBlur<uc4Image>(uc4Image& Out, const uc4Image& In, const int filtWid, float stdev);
+template void GaussianBlur<us1Image>(us1Image& Out, const us1Image& In, const int filtWid, float stdev);
+template void GaussianBlur<us3Image>(us3Image& Out, const us3Image& In, const int filtWid, float stdev);
+template void GaussianBlur<us4Image>(us4Image& Out, const us4Image& In, const int filtWid, float stdev);
+template void GaussianBlur<h1Image>(h1Image& Out, const h1Image& In, const int filtWid, float stdev);
+template void GaussianBlur<h3Image>(h3Image& Out, const h3Image& In, const int filtWid, float stdev);
+template void GaussianBlur<h4Image>(h4Image& Out, const h4Image& In, const int filtWid, float stdev);
+template void GaussianBlur<f1ImageView>(f1ImageView& Out, const f1ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<f3ImageView>(f3ImageView& Out, const f3ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<f4ImageView>(f4ImageView& Out, const f4ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<uc1ImageView>(uc1ImageView& Out, const uc1ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<uc3ImageView>(uc3ImageView& Out, const uc3ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<uc4ImageView>(uc4ImageView& Out, const uc4ImageView& In, const int filtWid, float stdev);
+template void GaussianBlur<f1TiledImage>(f1TiledImage& Out, const f1TiledImage& In, const int filtWid, float stdev);
+template void GaussianBlur<f3TiledImage>(f3TiledImage& Out, const f3TiledImage& In, const int filtWid, float stdev);
+template void GaussianBlur<f4TiledImage>(f4TiledImage& Out, const f4TiledImage& In, const int filtWid, float stdev);
+
+// Each plane is blurred as a one-channel image.
+template <class Pixel_T>
+void GaussianBlur(tPlanarImage<Pixel_T>& Out, const tPlanarImage<Pixel_T>& In, const int filtWid, const typename Pixel_T::FloatMathType stdev)
+{
+    Out.SetSize(In.w(), In.h());
+    for (int c = 0; c < In.chan(); c++) GaussianBlur(Out.plane(c), In.plane(c), filtWid, stdev);
+}
+
+template void GaussianBlur(f3PlanarImage& Out, const f3PlanarImage& In, const int filtWid, float stdev);
+template void GaussianBlur(f4PlanarImage& Out, const f4PlanarImage& In, const int filtWid, float stdev);
+
+namespace {
+// Coefficients of the Young and van Vliet third-order recursive Gaussian, run forward then backward:
+// w[n] = B x[n] + a1 w[n-1] + a2 w[n-2] + a3 w[n-3], then y[n] = B w[n] + a1 y[n+1] + a2 y[n+2] + a3 y[n+3].
+// M gives the backward pass's initial state from the end of the forward pass, following Triggs and Sdika, so that the
+// result is what filtering a signal that continues its last value forever would give.
+struct RecursiveGaussianCoefs {
+    double B, a1, a2, a3;
+    double M[3][3];
+
+    explicit RecursiveGaussianCoefs(const double sigma)
+    {
+        ASSERT_R(sigma >= 0.5);
+        const double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * sqrt(1 - 0.26891 * sigma);
+        const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+        a1 = (2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q) / b0;
+        a2 = -(1.4281 * q * q + 1.26661 * q * q * q) / b0;
+        a3 = 0.422205 * q * q * q / b0;
+        B = 1 - (a1 + a2 + a3);
+
+        // Past the end the input is constant, so the deviations from it of w and then y obey the homogeneous recursions.
+        // Run them far enough past the end for the response to die out, from each unit forward state.
+        const int L = int(20 * sigma) + 100;
+        std::vector<double> e(L + 3), d(L + 3);
+        for (int j = 0; j < 3; j++) {
+            e[0] = j == 2, e[1] = j == 1, e[2] = j == 0; // w[N-3], w[N-2], w[N-1]
+            for (int n = 3; n < L + 3; n++) e[n] = a1 * e[n - 1] + a2 * e[n - 2] + a3 * e[n - 3];
+            d[L] = d[L + 1] = d[L + 2] = 0;
+            for (int n = L - 1; n >= 3; n--) d[n] = B * e[n] + a1 * d[n + 1] + a2 * d[n + 2] + a3 * d[n + 3];
+            for (int i = 0; i < 3; i++) M[i][j] = d[3 + i]; // y[N+i]
+        }
+    }
+};
+
+// Filter the n elements of s, stride apart, into d. W is scratch space for n + 3 doubles. d may be s.
+void RecursiveGaussian1D(float* d, const float* s, const int n, const int stride, const RecursiveGaussianCoefs& G, double* W)
+{
+    const double u0 = s[0], uN = s[ptrdiff_t(n - 1) * stride];
+    W[0] = W[1] = W[2] = u0; // A constant signal before the start is its own steady state.
+    for (int i = 0; i < n; i++) W[i + 3] = G.B * s[ptrdiff_t(i) * stride] + G.a1 * W[i + 2] + G.a2 * W[i + 1] + G.a3 * W[i];
+
+    double y[3];
+    for (int i = 0; i < 3; i++) y[i] = uN + G.M[i][0] * (W[n + 2] - uN) + G.M[i][1] * (W[n + 1] - uN) + G.M[i][2] * (W[n] - uN);
+    double y1 = y[0], y2 = y[1], y3 = y[2];
+    for (int i = n - 1; i >= 0; i--) {
+        const double y0 = G.B * W[i + 3] + G.a1 * y1 + G.a2 * y2 + G.a3 * y3;
+        d[ptrdiff_t(i) * stride] = float(y0);
+        y3 = y2, y2 = y1, y1 = y0;
+    }
+}
+
+// Filter elements [e0, e1) of each of the hgt rows of Tmp down the columns, in place.
+// All the columns in the range step together, so the inner loops run along rows.
+void RecursiveGaussianCols(float* Tmp, const size_t rowEls, const int hgt, const size_t e0, const size_t e1, const RecursiveGaussianCoefs& G)
+{
+    const size_t bw = e1 - e0;
+    std::vector<double> W((hgt + 3) * bw), Y(3 * bw);
+    const float* first = Tmp + e0;
+    const float* last = Tmp + (hgt - 1) * rowEls + e0;
+
+    for (int k = 0; k < 3; k++)
+        for (size_t e = 0; e < bw; e++) W[k * bw + e] = first[e];
+    for (int y = 0; y < hgt; y++) {
+        const float* s = Tmp + y * rowEls + e0;
+        double* w = &W[(y + 3) * bw];
+        const double *w1 = w - bw, *w2 = w - 2 * bw, *w3 = w - 3 * bw;
+        for (size_t e = 0; e < bw; e++) w[e] = G.B * s[e] + G.a1 * w1[e] + G.a2 * w2[e] + G.a3 * w3[e];
+    }
+
+    double *y1 = &Y[0], *y2 = &Y[bw], *y3 = &Y[2 * bw];
+    const double *wN1 = &W[(hgt + 2) * bw], *wN2 = &W[(hgt + 1) * bw], *wN3 = &W[hgt * bw];
+    for (size_t e = 0; e < bw; e++) {
+        const double u = last[e];
+        y1[e] = u + G.M[0][0] * (wN1[e] - u) + G.M[0][1] * (wN2[e] - u) + G.M[0][2] * (wN3[e] - u);
+        y2[e] = u + G.M[1][0] * (wN1[e] - u) + G.M[1][1] * (wN2[e] - u) + G.M[1][2] * (wN3[e] - u);
+        y3[e] = u + G.M[2][0] * (wN1[e] - u) + G.M[2][1] * (wN2[e] - u) + G.M[2][2] * (wN3[e] - u);
+    }
+    for (int y = hgt - 1; y >= 0; y--) {
+        float* d = Tmp + y * rowEls + e0;
+        const double* w = &W[(y + 3) * bw];
+        for (size_t e = 0; e < bw; e++) {
+            const double y0 = G.B * w[e] + G.a1 * y1[e] + G.a2 * y2[e] + G.a3 * y3[e];
+            d[e] = float(y0);
+            y3[e] = y0; // Becomes y1 after the rotation
+        }
+        std::swap(y3, y2); // y3 <- old y2, y2 <- new
+        std::swap(y2, y1); // y2 <- old y1, y1 <- new
+    }
+}
+}; // namespace
+
+// Recursive Gaussian blur. The cost per pixel doesn't depend on stdev.
+// A row pass into a float buffer split across threads by rows, then a column pass split across threads by bands of columns.
+template <class Image_T> void RecursiveGaussianBlur(Image_T& Out, const Image_T& In, const typename Image_T::PixType::FloatMathType stdev)
+{
+    const int C = Image_T::PixType::Chan;
+    const int wid = In.w(), hgt = In.h();
+    const size_t rowEls = size_t(wid) * C;
+    if (wid < 1 || hgt < 1) {
+        Out.SetSize(wid, hgt);
+        return;
+    }
+
+    const RecursiveGaussianCoefs G(stdev);
+    std::vector<float> Tmp(rowEls * hgt);
+
+    ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+        std::vector<float> Row(rowEls);
+        std::vector<double> W(wid + 3);
+        for (int y = y0; y < y1; y++) {
+            BlurLoadRow(Row.data(), In, y);
+            for (int c = 0; c < C; c++) RecursiveGaussian1D(Tmp.data() + y * rowEls + c, Row.data() + c, wid, C, G, W.data());
+        }
+    });
+
+    // Bands of columns narrow enough that the band of W stays in cache
+    const int BandEls = 256;
+    const int numBands = int((rowEls + BandEls - 1) / BandEls);
+    ParallelForRanges(numBands, std::max(1, ConvertParallelPixels / (hgt * BandEls)), [&](const int b0, const int b1) {
+        for (int b = b0; b < b1; b++) RecursiveGaussianCols(Tmp.data(), rowEls, hgt, b * size_t(BandEls), std::min(rowEls, (b + 1) * size_t(BandEls)), G);
+    });
+
+    Out.SetSize(wid, hgt);
+    ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) BlurStoreRow(Out, y, Tmp.data() + y * rowEls);
+    });
+}
+
+template void RecursiveGaussianBlur(f1Image& Out, const f1Image& In, const float stdev);
+template void RecursiveGaussianBlur(f3Image& Out, const f3Image& In, const float stdev);
+template void RecursiveGaussianBlur(f4Image& Out, const f4Image& In, const float stdev);
+template void RecursiveGaussianBlur(f1ImageView& Out, const f1ImageView& In, const float stdev);
+template void RecursiveGaussianBlur(f3ImageView& Out, const f3ImageView& In, const float stdev);
+template void RecursiveGaussianBlur(f4ImageView& Out, const f4ImageView& In, const float stdev);
+template void RecursiveGaussianBlur(f1TiledImage& Out, const f1TiledImage& In, const float stdev);
+template void RecursiveGaussianBlur(f3TiledImage& Out, const f3TiledImage& In, const float stdev);
+template void RecursiveGaussianBlur(f4TiledImage& Out, const f4TiledImage& In, const float stdev);
@@ -6,21 +6,40 @@
 #pragma once
 
 #include "Image/tImage.h"
+#include "Image/tImageView.h"
+#include "Image/tPlanarImage.h"
+#include "Image/tTiledImage.h"
 
 #include <vector>
 
-// Take one individual sample from image
+// Take one individual sample from image. Also take a tTiledImage.
 template <class Image_T> bool sample1(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y);
 template <class Image_T> bool sample2(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y);
 template <class Image_T> bool sample4(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y);
 
+// Unless noted, the Image_T functions take either tImage or tImageView. With a view they work in place on its window,
+// and a view to be written must already be the size of the output. Where noted, they also take a tTiledImage.
+// The tPlanarImage overloads run each channel as its own flat plane, so their inner loops use the full SIMD width.
+
 // Box filter for MIP level generation, etc.
 template <class Image_T> void Downsample2x2(Image_T& Out, const Image_T& Img);
 
 // Arbitrary image resizing, both up and down, with any aspect ratio change.
 // Should work with all image formats.
+// Box filters down by two until within 2x of the target size, then samples bicubic to upsample or bilinear to downsample,
+// with the corner pixels of input and output aligned.
 template <class Image_T> void Resize(Image_T& Out, const Image_T& Img, const int w1, const int h1);
 
+// The filters for the filtered Resize. Mitchell is the B = C = 1/3 cubic that sample4 uses. Lanczos3 is sharpest but rings.
+enum ResizeFilter_e { RESIZE_BOX, RESIZE_TRIANGLE, RESIZE_MITCHELL, RESIZE_LANCZOS3 };
+
+// Resize with a separable filter in two passes, with the weights for each output column and row computed once.
+// Pixel centers are aligned, and when downsampling the filter is stretched to the output pixel spacing, so every input
+// pixel contributes and there is no need to box filter first. Runs in float, SIMD, on multiple threads, and integer
+// outputs round to nearest. If isSRGB, the color channels are filtered in linear light, not the encoded values; alpha is
+// filtered as is. Takes every tImage element type except the signed and unsigned ints.
+template <class Image_T> void Resize(Image_T& Out, const Image_T& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB = false);
+
 // Map a float image to an unsigned char image.
 template <class OutImage_T, class InImage_T>
 void ToneMapLinear(OutImage_T& Out, const InImage_T& Img, const typename InImage_T::PixType::ElType Scale, const typename InImage_T::PixType::ElType Bias);
@@ -30,19 +49,76 @@ template <class OutImage_T, class InImage_T>
 void ToneMapExtrema(OutImage_T& Out, const InImage_T& Img, const typename InImage_T::PixType& MinP, const typename InImage_T::PixType& MaxP);
 
 // Map a float image to an unsigned char image, finding the extrema that map to 0..255.
+// Also takes unsigned short images, whose extrema are found and mapped as raw integers, through a table.
+// The extrema are found by bands of rows on multiple threads and combined, and the mapping also runs on multiple threads.
 template <class OutImage_T, class InImage_T> void ToneMapFindExtrema(OutImage_T& Out, const InImage_T& Img);
 
-// Clamp each pixel to the extrema of its neighbors.
-template <class Image_T> void Despeckle(Image_T& dstImg, const Image_T& srcImg);
+enum ToneMapOp_e { TONEMAP_CLAMP, TONEMAP_REINHARD, TONEMAP_FILMIC };
+
+// Map a high dynamic range image to an unsigned char image for display. Each color channel x is scaled by Exposure and
+// mapped by Op: TONEMAP_CLAMP clips it at 1, TONEMAP_REINHARD is x / (1 + x), and TONEMAP_FILMIC is Narkowicz's fit to
+// the ACES filmic curve, x (2.51 x + 0.03) / (x (2.43 x + 0.59) + 0.14). Then if encodeSRGB, the colors are encoded to
+// sRGB. Either way the results are rounded. Alpha is copied. Takes float, half, and unsigned short images; unsigned short
+// is normalized to 0..1 first and maps through a table of all 65536 values.
+template <class OutImage_T, class InImage_T>
+void ToneMap(OutImage_T& Out, const InImage_T& Img, const ToneMapOp_e Op, const float Exposure = 1.f, const bool encodeSRGB = true);
+
+// Map each channel c of a planar float image to unsigned char as Img[c] * Scale[c] + Bias[c].
+template <class OutPixel_T, class InPixel_T>
+void ToneMapLinear(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img, const InPixel_T& Scale, const InPixel_T& Bias);
+
+// The planar versions of ToneMapExtrema and ToneMapFindExtrema, mapping all channels alike just like the interleaved ones.
+template <class OutPixel_T, class InPixel_T>
+void ToneMapExtrema(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img, const InPixel_T& MinP, const InPixel_T& MaxP);
+template <class OutPixel_T, class InPixel_T> void ToneMapFindExtrema(tPlanarImage<OutPixel_T>& Out, const tPlanarImage<InPixel_T>& Img);
+
+// Channel-wise morphology over the (2 * radius + 1)^2 square around each pixel, with the edge pixels extended outward.
+// Erode takes the min and Dilate the max. MorphOpen erodes then dilates, removing bright specks smaller than the square,
+// and MorphClose dilates then erodes, filling dark ones. These use van Herk and Gil-Werman's algorithm in separable
+// passes, so the cost per pixel doesn't grow with the radius. Take every tImage element type but the signed and
+// unsigned ints. Out may be Img.
+template <class Image_T> void Erode(Image_T& Out, const Image_T& Img, const int radius);
+template <class Image_T> void Dilate(Image_T& Out, const Image_T& Img, const int radius);
+template <class Image_T> void MorphOpen(Image_T& Out, const Image_T& Img, const int radius);
+template <class Image_T> void MorphClose(Image_T& Out, const Image_T& Img, const int radius);
+
+// Clamp each pixel channel-wise to the extrema of its neighbors within radius. Only pixels inside the image are neighbors,
+// so specks on the border are removed too. Costs the same for any radius, like Erode.
+template <class Image_T> void Despeckle(Image_T& dstImg, const Image_T& srcImg, const int radius = 1);
 
 // Return an approximation of the median luminance.
 template <class Image_T> typename Image_T::PixType::ElType getApproxMedian(const Image_T& Img, const int NumSamples);
 
+// The channel-wise P[i]-th fraction percentile of all the pixels, exactly, for each P[i] in 0..1. The result for p is the
+// element of rank floor(p * (n - 1)) in sorted order, so 0.5 is the lower median. Counts a histogram of every element
+// value for unsigned char and unsigned short. Float uses a radix select on its bits: one pass counts the high 16 bits,
+// then a pass for each requested percentile and channel counts the low 16 bits of the elements in its bucket.
+template <class Image_T> std::vector<typename Image_T::PixType> getPercentiles(const Image_T& Img, const std::vector<float>& P);
+
+// The channel-wise exact lower median of all the pixels.
+template <class Image_T> typename Image_T::PixType getMedian(const Image_T& Img);
+
+// Replace each pixel channel-wise by the median of the (2 * radius + 1)^2 window around it, with the edge pixels
+// extended outward. Uses Perreault and Hebert's constant-time algorithm, so the cost per pixel doesn't grow with the
+// radius, and bands of rows run on multiple threads. radius is at most 127. Float channels are quantized to 256 levels
+// across their range, and the result is the center of the median's level.
+template <class Image_T> void MedianFilter(Image_T& Out, const Image_T& Img, const int radius);
+
 // Quantize all the pixels into buckets (separately for each channel) and return a histogram for each channel.
 // Values beyond minc and maxc are not counted.
 // You define a return type that is usually a uiPixel w/ as many channels as the image.
+// Bands of rows count on multiple threads, each into its own histogram, and the histograms are summed at the end.
 template <class Pixel_T, class Image_T, class Elem_T>
 std::vector<Pixel_T> getHistogram(const Image_T& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc);
+template <class Pixel_T, class ImgPixel_T, class Elem_T>
+std::vector<Pixel_T> getHistogram(const tPlanarImage<ImgPixel_T>& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc);
+
+// The same buckets, but each is the fraction of the pixels that fall in it, or with cumulative, in it or any bucket below
+// it, which is the CDF. Values beyond minc and maxc count toward the total but not any bucket, so the last bucket of the
+// CDF is less than one if there are any. Pixel_T is a float pixel with as many channels as the image.
+// Takes an image or a planar image.
+template <class Pixel_T, class Image_T, class Elem_T>
+std::vector<Pixel_T> getHistogramFraction(const Image_T& Img, const int NumBuckets, const Elem_T minc, const Elem_T maxc, const bool cumulative = false);
 
 // Copy channel number src_ch of image SrcIm to channel dest_ch of image DstIm.
 // Things work fine if SrcIm is DstIm.
@@ -50,14 +126,22 @@ std::vector<Pixel_T> getHistogram(const Image_T& Img, const int NumBuckets, cons
 // Converts from src channel format to dest using channel_cast.
 // Channel numbers start with 0.
 template <class DstPixel_T, class SrcPixel_T> void CopyChan(tImage<DstPixel_T>& DstIm, const int dst_ch, const tImage<SrcPixel_T>& SrcIm, const int src_ch);
+// With planar images this is a whole-plane conversion.
+template <class DstPixel_T, class SrcPixel_T>
+void CopyChan(tPlanarImage<DstPixel_T>& DstIm, const int dst_ch, const tPlanarImage<SrcPixel_T>& SrcIm, const int src_ch);
 
 // Copies or composites a rectangle using a choice of many compositing modes
 // from SrcIm of size bwid x bhgt with upper-left corner srcx,srcy to upper-left corner dstx,dsty in DstIm.
-// The two images may be different types. Doesn't resize the dest image.
+// The two images may be different types, and each may be a tImage or a tImageView. Doesn't resize the dest image.
 // The images may be the same, but the result is undefined if the quads overlap.
-template <class DstPixel_T, class SrcPixel_T>
-void CopyRect(tImage<DstPixel_T>& DstIm, const tImage<SrcPixel_T>& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid,
-              const int bhgt, const int mode = 0, SrcPixel_T Key = SrcPixel_T(), float alpha = 0.0f);
+// Modes: 0 copies, 1 composites src OVER dst by src alpha, 2 copies the src pixels that aren't Key, 3 multiplies by src
+// and lerps by src alpha, 4 composites OVER by the constant alpha, 5 adds, and 6 copies channel Key[0]. Modes 1 and 3
+// need four channel pixels. The mode is dispatched once per call and the rectangle is processed a row at a time: a copy
+// between the same pixel type is a memcpy per row, and keyed copies of byte and short pixels, adds, and the OVER modes
+// use the SIMD kernels. Large rectangles run in bands of rows on multiple threads.
+template <class DstImage_T, class SrcImage_T>
+void CopyRect(DstImage_T& DstIm, const SrcImage_T& SrcIm, const int srcx, const int srcy, const int dstx, const int dsty, const int bwid, const int bhgt,
+              const int mode = 0, typename SrcImage_T::PixType Key = typename SrcImage_T::PixType(), float alpha = 0.0f);
 
 // Create an NxN Gaussian blur kernel with standard deviation sigma.
 // Usually represent the kernel as an f1Image
@@ -65,13 +149,42 @@ template <class KernelImage_T> KernelImage_T MakeGaussianKernel(const int N, con
 
 // Convolution for any image type.
 // Kernel width must be odd. Kernel should be a one channel image of the pixel's MathType.
+// Output pixel x,y is the sum of Kernel(i, j) * In(x - N/2 + i, y - N/2 + j). Where the kernel hangs off the image,
+// the sum is over the pixels it covers and is divided by the sum of the kernel weights that cover them.
+// Kernels at least ConvolveFFTMinWidth wide use ConvolveImageFFT(); narrower ones use ConvolveImageDirect().
 template <class Image_T, class KernelImage_T> void ConvolveImage(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel);
-
-// Gaussian blur for any image type; filtWid must be odd.
-template <class Image_T> void GaussianBlur(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::MathType stdev);
+// Kernel width at which ConvolveImage() switches to ConvolveImageFFT(). ConvolveSpeedTest measures the FFT as faster
+// from 9 wide on a 1024 x 1024 f3Image; this keeps the exact direct sum for the 9 wide kernel, where it's about even.
+const int ConvolveFFTMinWidth = 11;
+// ConvolveImage() by summing the kernel at each pixel. Its cost is proportional to the kernel area.
+template <class Image_T, class KernelImage_T> void ConvolveImageDirect(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel);
+// ConvolveImage() by FFT. Tiles of the image are transformed, multiplied by the kernel's spectrum, and transformed
+// back, keeping only the part of each tile that didn't wrap around. Tiles run on multiple threads.
+// Its cost per pixel grows only with the log of the tile size, but it has float rounding error of about 1e-6 of the
+// image's range.
+template <class Image_T, class KernelImage_T> void ConvolveImageFFT(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel);
+
+// Gaussian blur for any image type; filtWid must be odd. Also takes a tTiledImage. Out may be In.
+// Runs as two separable passes in float on multiple threads. Integer pixels are rounded.
+template <class Image_T> void GaussianBlur(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::FloatMathType stdev);
+// Gaussian blur with a recursive (IIR) filter whose cost doesn't depend on stdev, for very wide blurs. stdev must be at least 0.5.
+// Away from the edges it approximates GaussianBlur with a filter width of 6 stdev or more to within about 1% of the image's range.
+// At the edges, rather than renormalizing, it treats the image as continuing its edge pixels forever. Out may be In.
+// Also takes a tTiledImage.
+template <class Image_T> void RecursiveGaussianBlur(Image_T& Out, const Image_T& In, const typename Image_T::PixType::FloatMathType stdev);
+// Gaussian blur of each plane of a planar image as a one-channel image.
+template <class Pixel_T>
+void GaussianBlur(tPlanarImage<Pixel_T>& Out, const tPlanarImage<Pixel_T>& In, const int filtWid, const typename Pixel_T::FloatMathType stdev);
 
 // FiltWid x filtWid gaussian blur for any image type. Each pixel's contribution is further modulated by the color space distance from the target pixel
-// filtWid must be odd. Repeat iterations times.
+// filtWid must be odd. Repeat iterations times. Also takes a tTiledImage. Out may be In.
+// Runs in float on multiple threads, with a table for the color weight. Integer pixels are filtered in their own units and rounded.
+template <class Image_T>
+void VCD(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::FloatMathType ImageStDev,
+         const typename Image_T::PixType::FloatMathType ColorStDev, const int iterations = 1);
+// An approximate VCD whose cost doesn't depend on the spatial stdev. ImageStDev and ColorStDev mean the same as for VCD(),
+// but the spatial Gaussian isn't truncated to a filter width. One-channel images use a bilateral grid and three-channel
+// images a permutohedral lattice. VCDTest reports its error and speed against VCD(). Also takes a tTiledImage.
 template <class Image_T>
-void VCD(Image_T& Out, const Image_T& In, const int filtWid, const typename Image_T::PixType::MathType ImageStDev,
-         const typename Image_T::PixType::MathType ColorStDev, const int iterations = 1);
+void VCDApprox(Image_T& Out, const Image_T& In, const typename Image_T::PixType::FloatMathType ImageStDev,
+               const typename Image_T::PixType::FloatMathType ColorStDev, const int iterations = 1);
@@ -0,0 +1,198 @@
+//////////////////////////////////////////////////////////////////////
+// ImageConvert.h - Fast conversion of pixels and images between pixel types
+//
+// Copyright David K. McAllister, 2026.
+
+// ConvertPixels() converts a run of pixels and gives exactly what the tPixel converting constructor gives, pixel by pixel.
+// It picks the fastest route for the pair of types:
+// - Same type: a straight copy.
+// - Same channel count between half and float: the bulk HalfToFloat() and FloatToHalf() in ImageKernels.h.
+// - Same channel count between unsigned char, unsigned short, float, and half: the SIMD conversion kernels in ImageKernels.h.
+// - Any other conversion from unsigned char: a 256-entry table of converted elements.
+// - Anything else: the per-pixel conversion.
+// Pixel types derived from tPixel, such as rgbePixel, may define their own conversions, so they always convert per pixel.
+//
+// It can also convert between sRGB and linear. The transfer function applies to the color channels, not to alpha,
+// which is the last channel of a 2- or 4-channel pixel. Conversions from unsigned char use a table with the transfer
+// baked in, and encoding to unsigned char searches a table of the 255 linear values halfway between sRGB codes.
+// Unlike channel_cast, conversions with a transfer function round to nearest rather than truncating.
+//
+// ConvertImage() converts a whole image, splitting the rows across threads when the image is large.
+// tImage's converting copy constructor and assignment use it.
+
+#pragma once
+
+#include "Image/ImageKernels.h"
+#include "Image/tPixel.h"
+#include "Util/Assert.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+enum ColorXfer_e { XFER_NONE, XFER_SRGB_TO_LINEAR, XFER_LINEAR_TO_SRGB };
+
+// The sRGB transfer function and its inverse, on 0..1.
+DMC_DECL float SRGBToLinear(const float c) { return c <= 0.04045f ? c * (1.f / 12.92f) : powf((c + 0.055f) * (1.f / 1.055f), 2.4f); }
+DMC_DECL float LinearToSRGB(const float c) { return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.f / 2.4f) - 0.055f; }
+
+DMC_DECL float ApplyColorXfer(const float c, const ColorXfer_e xfer)
+{
+    if (xfer == XFER_SRGB_TO_LINEAR) return SRGBToLinear(c);
+    if (xfer == XFER_LINEAR_TO_SRGB) return LinearToSRGB(c);
+    return c;
+}
+
+// Convert a float channel to Elem_T like channel_cast, but rounding to nearest for the normalized integer types.
+template <class Elem_T> DMC_DECL Elem_T RoundFromFloat(const float f)
+{
+    Elem_T d;
+    if constexpr (element_traits<Elem_T>::normalized)
+        basePixel::channel_cast(d, f + 0.5f / float(element_traits<Elem_T>::one()));
+    else
+        basePixel::channel_cast(d, f);
+    return d;
+}
+
+// Each unsigned char value converted to Elem_T, with the given transfer function.
+template <class Elem_T> struct tByteConvertLUT {
+    Elem_T T[256];
+
+    tByteConvertLUT(const ColorXfer_e xfer)
+    {
+        for (int k = 0; k < 256; k++) {
+            if (xfer == XFER_NONE)
+                basePixel::channel_cast(T[k], (unsigned char)k);
+            else
+                T[k] = RoundFromFloat<Elem_T>(ApplyColorXfer(k / 255.f, xfer));
+        }
+    }
+};
+
+template <class Elem_T> const Elem_T* ByteConvertLUT(const ColorXfer_e xfer)
+{
+    static const tByteConvertLUT<Elem_T> LUTs[3] = {XFER_NONE, XFER_SRGB_TO_LINEAR, XFER_LINEAR_TO_SRGB};
+    return LUTs[xfer].T;
+}
+
+// Encode a linear 0..1 value as the nearest 8-bit sRGB code.
+// The thresholds between codes are at least 1 / (255 * 12.92) apart, which is more than 1 / 4096, so a 4096-bin table
+// gives the code at the bottom of v's bin, and one comparison with the next threshold finishes the search exactly.
+inline unsigned char EncodeSRGB8(const float v)
+{
+    struct tThresholds {
+        float T[256];           // T[k] is the linear value halfway between codes k and k+1. T[255] is past 1.
+        unsigned char Lo[4096]; // Lo[b] is the code for the value b / 4096.
+        tThresholds()
+        {
+            for (int k = 0; k < 255; k++) T[k] = SRGBToLinear((k + 0.5f) / 255.f);
+            T[255] = 2.f;
+            for (int b = 0, k = 0; b < 4096; b++) {
+                while (T[k] <= b / 4096.f) k++;
+                Lo[b] = (unsigned char)k;
+            }
+        }
+    };
+    static const tThresholds Th;
+
+    if (!(v > 0.f)) return 0; // Also catches NaN
+    if (v >= 1.f) return 255;
+    const unsigned char k = Th.Lo[int(v * 4096.f)];
+    return (unsigned char)(k + (v >= Th.T[k]));
+}
+
+// Which channel of Pixel_T is alpha, or -1 if none.
+template <class Pixel_T> constexpr int AlphaChan() { return (Pixel_T::Chan == 2 || Pixel_T::Chan == 4) ? Pixel_T::Chan - 1 : -1; }
+
+// Fill d from s with the same channel mapping as the tPixel converting constructor. f(e, c) converts element e of source channel c.
+template <class DstPixel_T, class SrcPixel_T, class Func_T> DMC_DECL void MapChannels(DstPixel_T& d, const SrcPixel_T& s, const Func_T& f)
+{
+    const int SC = SrcPixel_T::Chan, DC = DstPixel_T::Chan;
+    if constexpr (SC == 1 || (SC == 2 && DC != 2)) {
+        for (int i = 0; i < DC; i++) d[i] = f(s[0], 0); // Replicate channel 0
+    } else if constexpr (SC == 3 && DC == 4) {
+        for (int i = 0; i < 3; i++) d[i] = f(s[i], i);
+        d[3] = element_traits<typename DstPixel_T::ElType>::one(); // Set alpha to 1.0.
+    } else {
+        for (int i = 0; i < SC && i < DC; i++) d[i] = f(s[i], i); // Channel-wise copy
+    }
+}
+
+// Convert the n pixels of s into d.
+template <class DstPixel_T, class SrcPixel_T> void ConvertPixels(DstPixel_T* d, const SrcPixel_T* s, const size_t n, const ColorXfer_e xfer = XFER_NONE)
+{
+    typedef typename DstPixel_T::ElType DstEl;
+    typedef typename SrcPixel_T::ElType SrcEl;
+    const bool IsTPixels = std::is_same<DstPixel_T, tPixel<DstEl, DstPixel_T::Chan>>::value && std::is_same<SrcPixel_T, tPixel<SrcEl, SrcPixel_T::Chan>>::value;
+    const bool FlatEls = sizeof(DstPixel_T) == sizeof(DstEl) * DstPixel_T::Chan && sizeof(SrcPixel_T) == sizeof(SrcEl) * SrcPixel_T::Chan;
+    const int AlphaC = AlphaChan<SrcPixel_T>();
+
+    if constexpr (!IsTPixels) {
+        ASSERT_RM(xfer == XFER_NONE, "Color transfer functions need tPixel types");
+        for (size_t i = 0; i < n; i++) d[i] = static_cast<DstPixel_T>(s[i]);
+    } else if constexpr (std::is_same<SrcEl, unsigned char>::value && !std::is_same<DstPixel_T, SrcPixel_T>::value) {
+        if (xfer == XFER_NONE && DstPixel_T::Chan == SrcPixel_T::Chan && FlatEls &&
+            SIMDConvert(reinterpret_cast<DstEl*>(d), reinterpret_cast<const SrcEl*>(s), n * SrcPixel_T::Chan))
+            return;
+
+        const DstEl* Lut = ByteConvertLUT<DstEl>(xfer);
+        const DstEl* PlainLut = ByteConvertLUT<DstEl>(XFER_NONE);
+        for (size_t i = 0; i < n; i++) MapChannels(d[i], s[i], [&](const unsigned char e, const int c) { return (c == AlphaC ? PlainLut : Lut)[e]; });
+    } else {
+        if (xfer == XFER_NONE) {
+            if constexpr (std::is_same<DstPixel_T, SrcPixel_T>::value) {
+                std::copy(s, s + n, d);
+                return;
+            }
+            if constexpr (DstPixel_T::Chan == SrcPixel_T::Chan && FlatEls && std::is_same<DstEl, float>::value && std::is_same<SrcEl, half>::value) {
+                HalfToFloat(reinterpret_cast<float*>(d), reinterpret_cast<const half*>(s), n * SrcPixel_T::Chan);
+                return;
+            }
+            if constexpr (DstPixel_T::Chan == SrcPixel_T::Chan && FlatEls && std::is_same<DstEl, half>::value && std::is_same<SrcEl, float>::value) {
+                FloatToHalf(reinterpret_cast<half*>(d), reinterpret_cast<const float*>(s), n * SrcPixel_T::Chan);
+                return;
+            }
+            if (DstPixel_T::Chan == SrcPixel_T::Chan && FlatEls &&
+                SIMDConvert(reinterpret_cast<DstEl*>(d), reinterpret_cast<const SrcEl*>(s), n * SrcPixel_T::Chan))
+                return;
+            for (size_t i = 0; i < n; i++) d[i] = static_cast<DstPixel_T>(s[i]);
+            return;
+        }
+
+        // Transfer functions on non-byte sources go through float
+        for (size_t i = 0; i < n; i++) {
+            MapChannels(d[i], s[i], [&](const SrcEl e, const int c) {
+                DstEl r;
+                if (c == AlphaC) {
+                    basePixel::channel_cast(r, e);
+                } else {
+                    float f;
+                    basePixel::channel_cast(f, e);
+                    if constexpr (std::is_same<DstEl, unsigned char>::value)
+                        r = xfer == XFER_LINEAR_TO_SRGB ? EncodeSRGB8(f) : RoundFromFloat<DstEl>(ApplyColorXfer(f, xfer));
+                    else
+                        r = RoundFromFloat<DstEl>(ApplyColorXfer(f, xfer));
+                }
+                return r;
+            });
+        }
+    }
+}
+
+// Images with at least this many pixels are converted on multiple threads, in bands of about this many pixels.
+const int ConvertParallelPixels = 1 << 16;
+
+// Convert SrcIm into DstIm, which may have a different pixel type. Each may be a tImage or tImageView.
+// A tImage is resized to match SrcIm. The images must not overlap unless they are the same.
+template <class DstImage_T, class SrcImage_T> void ConvertImage(DstImage_T& DstIm, const SrcImage_T& SrcIm, const ColorXfer_e xfer = XFER_NONE)
+{
+    if (DstIm.w() != SrcIm.w() || DstIm.h() != SrcIm.h()) DstIm.SetSize(SrcIm.w(), SrcIm.h());
+    if (SrcIm.w() < 1 || SrcIm.h() < 1) return;
+
+    DstIm.row(0); // Unshare the raster before the threads write rows of it
+    const int wid = SrcIm.w();
+    ParallelForRanges(SrcIm.h(), std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) ConvertPixels(DstIm.row(y), SrcIm.row(y), size_t(wid), xfer);
+    });
+}
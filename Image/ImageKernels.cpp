@@ -0,0 +1,203 @@
+//////////////////////////////////////////////////////////////////////
+// ImageKernels.cpp - Run-time dispatch of the SIMD image kernels
+//
+// Copyright David K. McAllister, 2026.
+
+#include "Image/ImageKernels.h"
+
+#include "Image/tPixel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define DMC_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+// Branch-free half conversions by bit manipulation, giving the same bits as class half without its 256 KB toFloat table.
+// ImageKernelsSIMD.h has vector versions of both, which use these for the leftovers.
+namespace {
+DMC_DECL unsigned int floatBits(const float f)
+{
+    unsigned int u;
+    memcpy(&u, &f, 4);
+    return u;
+}
+
+DMC_DECL float bitsFloat(const unsigned int u)
+{
+    float f;
+    memcpy(&f, &u, 4);
+    return f;
+}
+
+DMC_DECL float HalfBitsToFloat(const unsigned short h)
+{
+    const unsigned int shiftedExp = 0x7c00 << 13;
+    unsigned int o = (h & 0x7fff) << 13;
+    const unsigned int e = o & shiftedExp;
+    o += (127 - 15) << 23;
+    o += e == shiftedExp ? (128 - 16) << 23 : 0; // Infinity or NaN
+    const float fd = bitsFloat(o + (1 << 23)) - bitsFloat(113 << 23); // Renormalize denormals
+    o = e == 0 ? floatBits(fd) : o;
+    return bitsFloat(o | (h & 0x8000) << 16);
+}
+
+DMC_DECL unsigned short FloatToHalfBits(const float f)
+{
+    const unsigned int x = floatBits(f);
+    const unsigned int a = x & 0x7fffffff;
+    const int ex = a >> 23;
+    const unsigned int m = a & 0x007fffff;
+
+    const unsigned int hn = (a - (112 << 23) + 0x1000) >> 13;                                  // Normal; may round up to infinity
+    const unsigned int hd = ex < 113 ? ((unsigned int)(bitsFloat(a) * 33554432.f) + 1) >> 1 : 0; // Denormal: |f| * 2^24, ties up
+    const unsigned int hs = 0x7c00 | (m >> 13) | (m != 0 && (m >> 13) == 0);                    // Infinity or NaN
+
+    unsigned int h = ex == 255 ? hs : 0x7c00;
+    h = ex < 143 ? hn : h;
+    h = ex < 113 ? hd : h;
+    h |= (x >> 16) & 0x8000;
+    return (unsigned short)(ex < 102 ? 0 : h);
+}
+}; // namespace
+
+#ifdef DMC_SIMD_KERNELS
+
+// Compile the kernels once per instruction set. MSVC allows any intrinsic anywhere; gcc needs to be told.
+#ifdef DMC_MACHINE_gcc
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+#define DMC_SIMD_NS SSE4
+#define DMC_SIMD_WIDTH 128
+#include "Image/ImageKernelsSIMD.h"
+#undef DMC_SIMD_NS
+#undef DMC_SIMD_WIDTH
+#ifdef DMC_MACHINE_gcc
+#pragma GCC pop_options
+#endif
+
+#ifdef DMC_MACHINE_gcc
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,f16c")
+#endif
+#define DMC_SIMD_NS AVX2
+#define DMC_SIMD_WIDTH 256
+#include "Image/ImageKernelsSIMD.h"
+#undef DMC_SIMD_NS
+#undef DMC_SIMD_WIDTH
+#ifdef DMC_MACHINE_gcc
+#pragma GCC pop_options
+#endif
+
+#endif
+
+namespace {
+SIMDLevel_e& ActiveLevel()
+{
+#ifdef DMC_SIMD_KERNELS
+    static SIMDLevel_e Level = CPUSIMDLevel();
+#else
+    static SIMDLevel_e Level = SIMD_NONE;
+#endif
+    return Level;
+}
+}; // namespace
+
+SIMDLevel_e GetSIMDLevel() { return ActiveLevel(); }
+
+void SetSIMDLevel(const SIMDLevel_e Level)
+{
+#ifdef DMC_SIMD_KERNELS
+    ActiveLevel() = std::min(Level, CPUSIMDLevel());
+#endif
+}
+
+// There are no AVX-512 kernels yet, so those CPUs use the AVX2 ones.
+#ifdef DMC_SIMD_KERNELS
+#define DMC_SIMD_DISPATCH(CALL)                                   \
+    switch (ActiveLevel()) {                                      \
+    case SIMD_AVX512:                                             \
+    case SIMD_AVX2: return AVX2::CALL;                            \
+    case SIMD_SSE4: return SSE4::CALL;                            \
+    default: return false;                                        \
+    }
+#else
+#define DMC_SIMD_DISPATCH(CALL) return false;
+#endif
+
+#define DMC_SIMD_ELEM_KERNELS(ELEM_T)                                                                                                         \
+    bool SIMDElemOp(const ElemOp_e op, ELEM_T* d, const ELEM_T* s, const size_t n) { DMC_SIMD_DISPATCH(ElemOp(op, d, s, n)) }                  \
+    bool SIMDElemOpPixel(const ElemOp_e op, ELEM_T* d, const size_t n, const ELEM_T* pix, const int chan)                                     \
+    {                                                                                                                                         \
+        DMC_SIMD_DISPATCH(ElemOpPixel(op, d, n, pix, chan))                                                                                   \
+    }                                                                                                                                         \
+    bool SIMDMinMax(const ELEM_T* s, const size_t n, const int chan, ELEM_T* cmin, ELEM_T* cmax) { DMC_SIMD_DISPATCH(MinMax(s, n, chan, cmin, cmax)) } \
+    bool SIMDMinOrMax(const bool isMax, ELEM_T* d, const ELEM_T* a, const ELEM_T* b, const size_t n) { DMC_SIMD_DISPATCH(MinOrMax(isMax, d, a, b, n)) } \
+    bool SIMDSumChan(const ELEM_T* s, const size_t n, const int chan, double* sums) { DMC_SIMD_DISPATCH(SumChan(s, n, chan, sums)) }          \
+    bool SIMDEqual(const ELEM_T* a, const ELEM_T* b, const size_t n, bool& equal) { DMC_SIMD_DISPATCH(Equal(a, b, n, equal)) }
+
+DMC_SIMD_ELEM_KERNELS(unsigned char)
+DMC_SIMD_ELEM_KERNELS(unsigned short)
+DMC_SIMD_ELEM_KERNELS(float)
+DMC_SIMD_ELEM_KERNELS(half)
+
+bool SIMDFill(void* d, const size_t nbytes, const void* pix, const int pixBytes) { DMC_SIMD_DISPATCH(Fill(d, nbytes, pix, pixBytes)) }
+bool SIMDKeyedCopy(void* d, const void* s, const size_t n, const void* key, const int pixBytes) { DMC_SIMD_DISPATCH(KeyedCopy(d, s, n, key, pixBytes)) }
+
+bool SIMDConvert(float* d, const unsigned char* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertToFloat(d, s, n)) }
+bool SIMDConvert(float* d, const unsigned short* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertToFloat(d, s, n)) }
+bool SIMDConvert(unsigned char* d, const float* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertFromFloat(d, s, n)) }
+bool SIMDConvert(unsigned short* d, const float* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertFromFloat(d, s, n)) }
+bool SIMDConvert(unsigned char* d, const unsigned short* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertUSToUC(d, s, n)) }
+bool SIMDConvert(unsigned short* d, const unsigned char* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertUCToUS(d, s, n)) }
+bool SIMDConvert(half* d, const unsigned char* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertToHalf(d, s, n)) }
+bool SIMDConvert(half* d, const unsigned short* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertToHalf(d, s, n)) }
+bool SIMDConvert(unsigned char* d, const half* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertFromHalf(d, s, n)) }
+bool SIMDConvert(unsigned short* d, const half* s, const size_t n) { DMC_SIMD_DISPATCH(ConvertFromHalf(d, s, n)) }
+
+bool SIMDConvolveRow(float* d, const float* s, const size_t n, const int stride, const float* K, const int N)
+{
+    DMC_SIMD_DISPATCH(ConvolveRow(d, s, n, stride, K, N))
+}
+bool SIMDConvolveCol(float* d, const float* const* rows, const size_t n, const float* K, const int N) { DMC_SIMD_DISPATCH(ConvolveCol(d, rows, n, K, N)) }
+bool SIMDResampleRow(float* d, const float* s, const size_t n, const int* Start, const float* W, const int N)
+{
+    DMC_SIMD_DISPATCH(ResampleRow(d, s, n, Start, W, N))
+}
+bool SIMDVCDTap(float* const* Acc, float* Wsum, const float* const* S, const float* const* P, const int C, const size_t n, const float K,
+                const float* Table, const float maxIndex, const float scale)
+{
+    DMC_SIMD_DISPATCH(VCDTap(Acc, Wsum, S, P, C, n, K, Table, maxIndex, scale))
+}
+
+void HalfToFloat(float* d, const half* s, const size_t n)
+{
+    switch (ActiveLevel()) {
+#ifdef DMC_SIMD_KERNELS
+    case SIMD_AVX512:
+    case SIMD_AVX2: AVX2::HalfToFloat(d, s, n); return;
+    case SIMD_SSE4: SSE4::HalfToFloat(d, s, n); return;
+#endif
+    default:
+        for (size_t i = 0; i < n; i++) d[i] = HalfBitsToFloat(s[i].bits());
+    }
+}
+
+void FloatToHalf(half* d, const float* s, const size_t n)
+{
+    switch (ActiveLevel()) {
+#ifdef DMC_SIMD_KERNELS
+    case SIMD_AVX512:
+    case SIMD_AVX2: AVX2::FloatToHalf(d, s, n); return;
+    case SIMD_SSE4: SSE4::FloatToHalf(d, s, n); return;
+#endif
+    default:
+        for (size_t i = 0; i < n; i++) d[i].setBits(FloatToHalfBits(s[i]));
+    }
+}
+
+#undef DMC_SIMD_ELEM_KERNELS
+#undef DMC_SIMD_DISPATCH
@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////////////////////
+// ImageKernels.h - SIMD kernels for the bulk pixel operations in tImage
+//
+// Copyright David K. McAllister, 2026.
+
+// These operate on flat arrays of pixel elements so that tImage can hand them its raster directly.
+// The instruction set is chosen at run time based on cpuid. Each kernel returns false if it has no
+// SIMD version for the given element type or arguments, in which case the caller runs its scalar loop.
+// Results are identical to the scalar tPixel code, including saturation and rounding of the normalized types,
+// except that the float and half channel sums add in a different order and so may differ in rounding.
+// Element types with kernels are unsigned char, unsigned short, float, and half (half requires AVX2).
+// There are also conversion kernels between unsigned char, unsigned short, float, and half.
+
+#pragma once
+
+#include "Half/half.h"
+#include "Util/Utils.h"
+
+#include <cstddef>
+
+enum ElemOp_e { ELEM_ADD, ELEM_SUB, ELEM_MUL, ELEM_DIV };
+
+// The instruction set the kernels are currently using.
+SIMDLevel_e GetSIMDLevel();
+
+// Use at most the given instruction set, e.g. to compare against the scalar code. Can't exceed what the CPU supports.
+void SetSIMDLevel(const SIMDLevel_e Level);
+
+// d[i] = d[i] op s[i] for n elements
+template <class Elem_T> bool SIMDElemOp(const ElemOp_e, Elem_T*, const Elem_T*, const size_t) { return false; }
+bool SIMDElemOp(const ElemOp_e op, unsigned char* d, const unsigned char* s, const size_t n);
+bool SIMDElemOp(const ElemOp_e op, unsigned short* d, const unsigned short* s, const size_t n);
+bool SIMDElemOp(const ElemOp_e op, float* d, const float* s, const size_t n);
+bool SIMDElemOp(const ElemOp_e op, half* d, const half* s, const size_t n);
+
+// d[i] = d[i] op pix[i % chan] for n elements; chan is 1 to 4
+template <class Elem_T> bool SIMDElemOpPixel(const ElemOp_e, Elem_T*, const size_t, const Elem_T*, const int) { return false; }
+bool SIMDElemOpPixel(const ElemOp_e op, unsigned char* d, const size_t n, const unsigned char* pix, const int chan);
+bool SIMDElemOpPixel(const ElemOp_e op, unsigned short* d, const size_t n, const unsigned short* pix, const int chan);
+bool SIMDElemOpPixel(const ElemOp_e op, float* d, const size_t n, const float* pix, const int chan);
+bool SIMDElemOpPixel(const ElemOp_e op, half* d, const size_t n, const half* pix, const int chan);
+
+// Fill nbytes of d with copies of the pixBytes-byte pixel at pix. For any pixel type up to 32 bytes.
+bool SIMDFill(void* d, const size_t nbytes, const void* pix, const int pixBytes);
+
+// Copy the n pixels of pixBytes bytes at s to d, skipping those bytewise equal to the pixel at key. pixBytes is 1, 2, 4, or 8.
+bool SIMDKeyedCopy(void* d, const void* s, const size_t n, const void* key, const int pixBytes);
+
+// Channel-wise min and max of n elements with chan channels; chan is 1 to 4
+template <class Elem_T> bool SIMDMinMax(const Elem_T*, const size_t, const int, Elem_T*, Elem_T*) { return false; }
+bool SIMDMinMax(const unsigned char* s, const size_t n, const int chan, unsigned char* cmin, unsigned char* cmax);
+bool SIMDMinMax(const unsigned short* s, const size_t n, const int chan, unsigned short* cmin, unsigned short* cmax);
+bool SIMDMinMax(const float* s, const size_t n, const int chan, float* cmin, float* cmax);
+bool SIMDMinMax(const half* s, const size_t n, const int chan, half* cmin, half* cmax);
+
+// d[i] = min(a[i], b[i]), or max if isMax, for n elements. d may be a or b.
+template <class Elem_T> bool SIMDMinOrMax(const bool, Elem_T*, const Elem_T*, const Elem_T*, const size_t) { return false; }
+bool SIMDMinOrMax(const bool isMax, unsigned char* d, const unsigned char* a, const unsigned char* b, const size_t n);
+bool SIMDMinOrMax(const bool isMax, unsigned short* d, const unsigned short* a, const unsigned short* b, const size_t n);
+bool SIMDMinOrMax(const bool isMax, float* d, const float* a, const float* b, const size_t n);
+bool SIMDMinOrMax(const bool isMax, half* d, const half* a, const half* b, const size_t n);
+
+// Channel-wise sum of n elements with chan channels; chan is 1 to 4. Float and half sums may differ from the scalar sum in rounding.
+template <class Elem_T> bool SIMDSumChan(const Elem_T*, const size_t, const int, double*) { return false; }
+bool SIMDSumChan(const unsigned char* s, const size_t n, const int chan, double* sums);
+bool SIMDSumChan(const unsigned short* s, const size_t n, const int chan, double* sums);
+bool SIMDSumChan(const float* s, const size_t n, const int chan, double* sums);
+bool SIMDSumChan(const half* s, const size_t n, const int chan, double* sums);
+
+// d[i] = s[i] converted from Src_T to Dst_T exactly like basePixel::channel_cast, for n elements
+template <class Dst_T, class Src_T> bool SIMDConvert(Dst_T*, const Src_T*, const size_t) { return false; }
+bool SIMDConvert(float* d, const unsigned char* s, const size_t n);
+bool SIMDConvert(float* d, const unsigned short* s, const size_t n);
+bool SIMDConvert(unsigned char* d, const float* s, const size_t n);
+bool SIMDConvert(unsigned short* d, const float* s, const size_t n);
+bool SIMDConvert(unsigned char* d, const unsigned short* s, const size_t n);
+bool SIMDConvert(unsigned short* d, const unsigned char* s, const size_t n);
+bool SIMDConvert(half* d, const unsigned char* s, const size_t n);
+bool SIMDConvert(half* d, const unsigned short* s, const size_t n);
+bool SIMDConvert(unsigned char* d, const half* s, const size_t n);
+bool SIMDConvert(unsigned short* d, const half* s, const size_t n);
+
+// Convert n halfs to floats, or n floats to halfs, in bulk. Unlike the SIMD kernels these always do the conversion.
+// They give the same bits as class half, but without its 64K-entry toFloat table, which crowds the cache in bulk loops.
+// Widening uses F16C where there is AVX2. F16C rounds ties to even, not away from zero like half, so narrowing, and
+// widening on other CPUs, use branch-free bit manipulation, vectorized when there is SSE4.1.
+// The one difference from class half is that F16C quiets signaling NaNs.
+void HalfToFloat(float* d, const half* s, const size_t n);
+void FloatToHalf(half* d, const float* s, const size_t n);
+
+// One pass of a separable convolution on n float elements. Each sum adds the products of the taps in order, like the scalar loop.
+// Row: d[i] = sum_k K[k] * s[i + (k - N / 2) * stride], where stride is the elements per pixel. All N taps must be in bounds.
+// Column: d[i] = sum_k K[k] * rows[k][i]
+bool SIMDConvolveRow(float* d, const float* s, const size_t n, const int stride, const float* K, const int N);
+bool SIMDConvolveCol(float* d, const float* const* rows, const size_t n, const float* K, const int N);
+
+// One pass of a polyphase resampling of n outputs: d[o] = sum_k W[o * N + k] * s[Start[o] + k] for k < N.
+// N must be a multiple of 8, and all the taps must be in bounds, so pad s and give the extra taps zero weight.
+bool SIMDResampleRow(float* d, const float* s, const size_t n, const int* Start, const float* W, const int N);
+
+// One tap of a VCD window on n pixels stored as C <= 4 float planes: S is the planes at the tap and P at the window centers.
+// For each i, with d2 = sum_c (S[c][i] - P[c][i])^2 and f = min(d2 * scale, maxIndex), the weight w is K times Table
+// linearly interpolated at f. Then Acc[c][i] += w * S[c][i] and Wsum[i] += w. Table needs an entry past maxIndex.
+bool SIMDVCDTap(float* const* Acc, float* Wsum, const float* const* S, const float* const* P, const int C, const size_t n, const float K,
+                const float* Table, const float maxIndex, const float scale);
+
+// Sets equal to whether the n elements of a and b are all equal
+template <class Elem_T> bool SIMDEqual(const Elem_T*, const Elem_T*, const size_t, bool&) { return false; }
+bool SIMDEqual(const unsigned char* a, const unsigned char* b, const size_t n, bool& equal);
+bool SIMDEqual(const unsigned short* a, const unsigned short* b, const size_t n, bool& equal);
+bool SIMDEqual(const float* a, const float* b, const size_t n, bool& equal);
+bool SIMDEqual(const half* a, const half* b, const size_t n, bool& equal);
@@ -0,0 +1,894 @@
+//////////////////////////////////////////////////////////////////////
+// ImageKernelsSIMD.h - SSE4.1 and AVX2 bodies of the kernels declared in ImageKernels.h
+//
+// Copyright David K. McAllister, 2026.
+
+// This is deliberately not #pragma once. ImageKernels.cpp includes it once per instruction set, after defining
+// DMC_SIMD_NS, the namespace to put this instance in, and DMC_SIMD_WIDTH, the vector width in bits (128 or 256).
+// On gcc the includer also wraps it in a #pragma GCC target so the intrinsics are legal.
+//
+// Elements are processed as a flat array. A pixel pattern of Chan elements is expanded to Chan vectors,
+// which repeat exactly, so every kernel works for any channel count up to 4 with no shuffles.
+// Every kernel exactly matches the scalar tPixel arithmetic, so results don't depend on which CPU runs them.
+
+namespace DMC_SIMD_NS {
+
+#if DMC_SIMD_WIDTH == 256
+typedef __m256i VI;
+typedef __m256 VF;
+DMC_DECL VI loadi(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+DMC_DECL void storei(void* p, VI v) { _mm256_storeu_si256((__m256i*)p, v); }
+DMC_DECL VI zeroi() { return _mm256_setzero_si256(); }
+DMC_DECL VI add32(VI a, VI b) { return _mm256_add_epi32(a, b); }
+DMC_DECL VI sub32(VI a, VI b) { return _mm256_sub_epi32(a, b); }
+DMC_DECL VI set1i(int i) { return _mm256_set1_epi32(i); }
+DMC_DECL VI andi(VI a, VI b) { return _mm256_and_si256(a, b); }
+DMC_DECL VI andnoti(VI a, VI b) { return _mm256_andnot_si256(a, b); }
+DMC_DECL VI ori(VI a, VI b) { return _mm256_or_si256(a, b); }
+DMC_DECL VI cmpeq32(VI a, VI b) { return _mm256_cmpeq_epi32(a, b); }
+DMC_DECL VI cmpgt32(VI a, VI b) { return _mm256_cmpgt_epi32(a, b); }
+DMC_DECL VI selecti(VI m, VI a, VI b) { return _mm256_blendv_epi8(b, a, m); } // m ? a : b
+template <int S> DMC_DECL VI srli32(VI a) { return _mm256_srli_epi32(a, S); }
+template <int S> DMC_DECL VI slli32(VI a) { return _mm256_slli_epi32(a, S); }
+DMC_DECL VF castif(VI a) { return _mm256_castsi256_ps(a); }
+DMC_DECL VI castfi(VF a) { return _mm256_castps_si256(a); }
+DMC_DECL VI cvttf(VF a) { return _mm256_cvttps_epi32(a); }
+DMC_DECL VF cvtif(VI a) { return _mm256_cvtepi32_ps(a); }
+DMC_DECL VF gatherf(const float* p, VI i) { return _mm256_i32gather_ps(p, i, 4); }
+DMC_DECL VF loadf(const float* p) { return _mm256_loadu_ps(p); }
+DMC_DECL void storef(float* p, VF v) { _mm256_storeu_ps(p, v); }
+DMC_DECL VF zerof() { return _mm256_setzero_ps(); }
+DMC_DECL VF set1f(float f) { return _mm256_set1_ps(f); }
+DMC_DECL VF addf(VF a, VF b) { return _mm256_add_ps(a, b); }
+DMC_DECL VF subf(VF a, VF b) { return _mm256_sub_ps(a, b); }
+DMC_DECL VF mulf(VF a, VF b) { return _mm256_mul_ps(a, b); }
+DMC_DECL VF divf(VF a, VF b) { return _mm256_div_ps(a, b); }
+DMC_DECL VF minf(VF a, VF b) { return _mm256_min_ps(a, b); }
+DMC_DECL VF maxf(VF a, VF b) { return _mm256_max_ps(a, b); }
+DMC_DECL bool alleqf(VF a, VF b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)) == 0xff; }
+DMC_DECL bool alleqi(VI a, VI b) { return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) == -1; }
+DMC_DECL float hsumf(VF a)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+}
+#else
+typedef __m128i VI;
+typedef __m128 VF;
+DMC_DECL VI loadi(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+DMC_DECL void storei(void* p, VI v) { _mm_storeu_si128((__m128i*)p, v); }
+DMC_DECL VI zeroi() { return _mm_setzero_si128(); }
+DMC_DECL VI add32(VI a, VI b) { return _mm_add_epi32(a, b); }
+DMC_DECL VI sub32(VI a, VI b) { return _mm_sub_epi32(a, b); }
+DMC_DECL VI set1i(int i) { return _mm_set1_epi32(i); }
+DMC_DECL VI andi(VI a, VI b) { return _mm_and_si128(a, b); }
+DMC_DECL VI andnoti(VI a, VI b) { return _mm_andnot_si128(a, b); }
+DMC_DECL VI ori(VI a, VI b) { return _mm_or_si128(a, b); }
+DMC_DECL VI cmpeq32(VI a, VI b) { return _mm_cmpeq_epi32(a, b); }
+DMC_DECL VI cmpgt32(VI a, VI b) { return _mm_cmpgt_epi32(a, b); }
+DMC_DECL VI selecti(VI m, VI a, VI b) { return _mm_blendv_epi8(b, a, m); } // m ? a : b
+template <int S> DMC_DECL VI srli32(VI a) { return _mm_srli_epi32(a, S); }
+template <int S> DMC_DECL VI slli32(VI a) { return _mm_slli_epi32(a, S); }
+DMC_DECL VF castif(VI a) { return _mm_castsi128_ps(a); }
+DMC_DECL VI castfi(VF a) { return _mm_castps_si128(a); }
+DMC_DECL VI cvttf(VF a) { return _mm_cvttps_epi32(a); }
+DMC_DECL VF cvtif(VI a) { return _mm_cvtepi32_ps(a); }
+DMC_DECL VF gatherf(const float* p, VI i) // No gather before AVX2, so load the lanes one at a time
+{
+    return _mm_setr_ps(p[_mm_cvtsi128_si32(i)], p[_mm_extract_epi32(i, 1)], p[_mm_extract_epi32(i, 2)], p[_mm_extract_epi32(i, 3)]);
+}
+DMC_DECL VF loadf(const float* p) { return _mm_loadu_ps(p); }
+DMC_DECL void storef(float* p, VF v) { _mm_storeu_ps(p, v); }
+DMC_DECL VF zerof() { return _mm_setzero_ps(); }
+DMC_DECL VF set1f(float f) { return _mm_set1_ps(f); }
+DMC_DECL VF addf(VF a, VF b) { return _mm_add_ps(a, b); }
+DMC_DECL VF subf(VF a, VF b) { return _mm_sub_ps(a, b); }
+DMC_DECL VF mulf(VF a, VF b) { return _mm_mul_ps(a, b); }
+DMC_DECL VF divf(VF a, VF b) { return _mm_div_ps(a, b); }
+DMC_DECL VF minf(VF a, VF b) { return _mm_min_ps(a, b); }
+DMC_DECL VF maxf(VF a, VF b) { return _mm_max_ps(a, b); }
+DMC_DECL bool alleqf(VF a, VF b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xf; }
+DMC_DECL bool alleqi(VI a, VI b) { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xffff; }
+DMC_DECL float hsumf(VF a)
+{
+    const __m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+}
+#endif
+
+const int VBytes = DMC_SIMD_WIDTH / 8;
+
+// The bits of half(f) for each float lane, in the low 16 bits of each 32-bit lane. Branch free, and the same as
+// FloatToHalfBits() in ImageKernels.cpp: ties round away from zero, |f| < 2^-25 becomes +0, and NaNs keep their payload.
+// F16C can't be used since it rounds ties to even.
+DMC_DECL VI halfBits(VF v)
+{
+    const VI x = castfi(v);
+    const VI a = andi(x, set1i(0x7fffffff));
+    const VI ex = srli32<23>(a);
+    const VI m = andi(a, set1i(0x007fffff));
+
+    // Normal half. Rounding may carry into the exponent, up to infinity.
+    const VI hn = srli32<13>(add32(sub32(a, set1i(112 << 23)), set1i(0x1000)));
+    // Denormal half: |f| * 2^24 rounded to nearest, ties up
+    const VI hd = srli32<1>(add32(cvttf(mulf(castif(a), set1f(33554432.f))), set1i(1)));
+    // Infinity, or NaN with at least one significand bit set
+    const VI m13 = srli32<13>(m);
+    const VI hs = ori(ori(set1i(0x7c00), m13), andnoti(cmpeq32(m, zeroi()), andi(cmpeq32(m13, zeroi()), set1i(1))));
+
+    VI h = set1i(0x7c00); // Overflow to infinity
+    h = selecti(cmpeq32(ex, set1i(255)), hs, h);
+    h = selecti(cmpgt32(set1i(143), ex), hn, h);
+    h = selecti(cmpgt32(set1i(113), ex), hd, h);
+    h = ori(h, andi(srli32<16>(x), set1i(0x8000)));
+    return andnoti(cmpgt32(set1i(102), ex), h); // Too small: unsigned zero
+}
+
+// Halfs in the low 16 bits of each 32-bit lane widened to float. Branch free, and the same as HalfBitsToFloat().
+DMC_DECL VF halfBitsToFloat(VI h)
+{
+    const VI shiftedExp = set1i(0x7c00 << 13);
+    VI o = slli32<13>(andi(h, set1i(0x7fff)));
+    const VI e = andi(o, shiftedExp);
+    o = add32(o, set1i((127 - 15) << 23));
+    o = add32(o, andi(cmpeq32(e, shiftedExp), set1i((128 - 16) << 23))); // Infinity or NaN
+    const VI den = cmpeq32(e, zeroi());
+    const VF fd = subf(castif(add32(o, set1i(1 << 23))), castif(set1i(113 << 23))); // Renormalize denormals
+    o = selecti(den, castfi(fd), o);
+    return castif(ori(o, slli32<16>(andi(h, set1i(0x8000)))));
+}
+
+// Store the halfs of halfBits() to p
+DMC_DECL void storeHalfBits(half* p, VI h)
+{
+#if DMC_SIMD_WIDTH == 256
+    _mm_storeu_si128((__m128i*)p, _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(h, h), 0x08)));
+#else
+    _mm_storel_epi64((__m128i*)p, _mm_packus_epi32(h, h));
+#endif
+}
+
+// Per-element-type vector operations.
+// V is the register type that arithmetic happens in. A is the accumulator register for sums, K of which hold the
+// widened elements of one V, with AN lanes each.
+template <class Elem_T> struct Traits {
+    static const bool Supported = false;
+};
+
+template <> struct Traits<float> {
+    static const bool Supported = true;
+    static const bool HasDiv = true;
+    typedef float E;
+    typedef VF V;
+    typedef VF A;
+    static const int N = VBytes / 4;
+    static const int K = 1;
+    static const int AN = N;
+    static const size_t FlushBlocks = 256; // Move the float sums to double often to keep them accurate
+
+    DMC_DECL static V load(const E* p) { return loadf(p); }
+    DMC_DECL static void store(E* p, V v) { storef(p, v); }
+    DMC_DECL static V add(V a, V b) { return addf(a, b); }
+    DMC_DECL static V sub(V a, V b) { return subf(a, b); }
+    DMC_DECL static V mul(V a, V b) { return mulf(a, b); }
+    DMC_DECL static V div(V a, V b) { return divf(a, b); }
+    DMC_DECL static V vmin(V a, V b) { return minf(a, b); } // Returns b if a is NaN, like std::min(b, a)
+    DMC_DECL static V vmax(V a, V b) { return maxf(a, b); }
+    DMC_DECL static bool alleq(V a, V b) { return alleqf(a, b); }
+    DMC_DECL static void storeMinMax(E* p, V v) { storef(p, v); }
+    DMC_DECL static A azero() { return zerof(); }
+    DMC_DECL static void accum(A* acc, V v) { acc[0] = addf(acc[0], v); }
+    DMC_DECL static void astore(double* out, const A* acc)
+    {
+        float tmp[AN];
+        storef(tmp, acc[0]);
+        for (int j = 0; j < AN; j++) out[j] = tmp[j];
+    }
+};
+
+template <> struct Traits<unsigned char> {
+    static const bool Supported = true;
+    static const bool HasDiv = false;
+    typedef unsigned char E;
+    typedef VI V;
+    typedef VI A;
+    static const int N = VBytes;
+    static const int K = 4;
+    static const int AN = N / 4;
+    static const size_t FlushBlocks = 1 << 16; // Each lane gets one element per block, so this can't overflow
+
+    DMC_DECL static V load(const E* p) { return loadi(p); }
+    DMC_DECL static void store(E* p, V v) { storei(p, v); }
+#if DMC_SIMD_WIDTH == 256
+    DMC_DECL static V add(V a, V b) { return _mm256_adds_epu8(a, b); }
+    DMC_DECL static V sub(V a, V b) { return _mm256_subs_epu8(a, b); }
+    // Alvy Ray Smith's rounding, like mult_asgn<unsigned char>.
+    DMC_DECL static V mul(V a, V b)
+    {
+        const V z = _mm256_setzero_si256(), h = _mm256_set1_epi16(0x80);
+        V tl = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, z), _mm256_unpacklo_epi8(b, z)), h);
+        V th = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, z), _mm256_unpackhi_epi8(b, z)), h);
+        tl = _mm256_srli_epi16(_mm256_add_epi16(tl, _mm256_srli_epi16(tl, 8)), 8);
+        th = _mm256_srli_epi16(_mm256_add_epi16(th, _mm256_srli_epi16(th, 8)), 8);
+        return _mm256_packus_epi16(tl, th);
+    }
+    DMC_DECL static V vmin(V a, V b) { return _mm256_min_epu8(a, b); }
+    DMC_DECL static V vmax(V a, V b) { return _mm256_max_epu8(a, b); }
+    DMC_DECL static void accum(A* acc, V v)
+    {
+        const __m128i lo = _mm256_castsi256_si128(v), hi = _mm256_extracti128_si256(v, 1);
+        acc[0] = _mm256_add_epi32(acc[0], _mm256_cvtepu8_epi32(lo));
+        acc[1] = _mm256_add_epi32(acc[1], _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        acc[2] = _mm256_add_epi32(acc[2], _mm256_cvtepu8_epi32(hi));
+        acc[3] = _mm256_add_epi32(acc[3], _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+    }
+#else
+    DMC_DECL static V add(V a, V b) { return _mm_adds_epu8(a, b); }
+    DMC_DECL static V sub(V a, V b) { return _mm_subs_epu8(a, b); }
+    // Alvy Ray Smith's rounding, like mult_asgn<unsigned char>.
+    DMC_DECL static V mul(V a, V b)
+    {
+        const V z = _mm_setzero_si128(), h = _mm_set1_epi16(0x80);
+        V tl = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, z), _mm_unpacklo_epi8(b, z)), h);
+        V th = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, z), _mm_unpackhi_epi8(b, z)), h);
+        tl = _mm_srli_epi16(_mm_add_epi16(tl, _mm_srli_epi16(tl, 8)), 8);
+        th = _mm_srli_epi16(_mm_add_epi16(th, _mm_srli_epi16(th, 8)), 8);
+        return _mm_packus_epi16(tl, th);
+    }
+    DMC_DECL static V vmin(V a, V b) { return _mm_min_epu8(a, b); }
+    DMC_DECL static V vmax(V a, V b) { return _mm_max_epu8(a, b); }
+    DMC_DECL static void accum(A* acc, V v)
+    {
+        acc[0] = _mm_add_epi32(acc[0], _mm_cvtepu8_epi32(v));
+        acc[1] = _mm_add_epi32(acc[1], _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+        acc[2] = _mm_add_epi32(acc[2], _mm_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+        acc[3] = _mm_add_epi32(acc[3], _mm_cvtepu8_epi32(_mm_srli_si128(v, 12)));
+    }
+#endif
+    DMC_DECL static V div(V a, V) { return a; } // Not used since HasDiv is false
+    DMC_DECL static bool alleq(V a, V b) { return alleqi(a, b); }
+    DMC_DECL static void storeMinMax(E* p, V v) { storei(p, v); }
+    DMC_DECL static A azero() { return zeroi(); }
+    DMC_DECL static void astore(double* out, const A* acc)
+    {
+        for (int k = 0; k < K; k++) {
+            unsigned int tmp[AN];
+            storei(tmp, acc[k]);
+            for (int j = 0; j < AN; j++) out[k * AN + j] = tmp[j];
+        }
+    }
+};
+
+template <> struct Traits<unsigned short> {
+    static const bool Supported = true;
+    static const bool HasDiv = false;
+    typedef unsigned short E;
+    typedef VI V;
+    typedef VI A;
+    static const int N = VBytes / 2;
+    static const int K = 2;
+    static const int AN = N / 2;
+    static const size_t FlushBlocks = 1 << 16; // Each lane gets one element per block, so this can't overflow
+
+    DMC_DECL static V load(const E* p) { return loadi(p); }
+    DMC_DECL static void store(E* p, V v) { storei(p, v); }
+#if DMC_SIMD_WIDTH == 256
+    DMC_DECL static V add(V a, V b) { return _mm256_adds_epu16(a, b); }
+    DMC_DECL static V sub(V a, V b) { return _mm256_subs_epu16(a, b); }
+    // Alvy Ray Smith's rounding, like mult_asgn<unsigned short>. The products need 32 bits.
+    DMC_DECL static V mul(V a, V b)
+    {
+        const V lo = _mm256_mullo_epi16(a, b), hi = _mm256_mulhi_epu16(a, b), h = _mm256_set1_epi32(0x8000);
+        V t0 = _mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), h);
+        V t1 = _mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), h);
+        t0 = _mm256_srli_epi32(_mm256_add_epi32(t0, _mm256_srli_epi32(t0, 16)), 16);
+        t1 = _mm256_srli_epi32(_mm256_add_epi32(t1, _mm256_srli_epi32(t1, 16)), 16);
+        return _mm256_packus_epi32(t0, t1);
+    }
+    DMC_DECL static V vmin(V a, V b) { return _mm256_min_epu16(a, b); }
+    DMC_DECL static V vmax(V a, V b) { return _mm256_max_epu16(a, b); }
+    DMC_DECL static void accum(A* acc, V v)
+    {
+        acc[0] = _mm256_add_epi32(acc[0], _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+        acc[1] = _mm256_add_epi32(acc[1], _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+    }
+#else
+    DMC_DECL static V add(V a, V b) { return _mm_adds_epu16(a, b); }
+    DMC_DECL static V sub(V a, V b) { return _mm_subs_epu16(a, b); }
+    // Alvy Ray Smith's rounding, like mult_asgn<unsigned short>. The products need 32 bits.
+    DMC_DECL static V mul(V a, V b)
+    {
+        const V lo = _mm_mullo_epi16(a, b), hi = _mm_mulhi_epu16(a, b), h = _mm_set1_epi32(0x8000);
+        V t0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), h);
+        V t1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), h);
+        t0 = _mm_srli_epi32(_mm_add_epi32(t0, _mm_srli_epi32(t0, 16)), 16);
+        t1 = _mm_srli_epi32(_mm_add_epi32(t1, _mm_srli_epi32(t1, 16)), 16);
+        return _mm_packus_epi32(t0, t1);
+    }
+    DMC_DECL static V vmin(V a, V b) { return _mm_min_epu16(a, b); }
+    DMC_DECL static V vmax(V a, V b) { return _mm_max_epu16(a, b); }
+    DMC_DECL static void accum(A* acc, V v)
+    {
+        acc[0] = _mm_add_epi32(acc[0], _mm_cvtepu16_epi32(v));
+        acc[1] = _mm_add_epi32(acc[1], _mm_cvtepu16_epi32(_mm_srli_si128(v, 8)));
+    }
+#endif
+    DMC_DECL static V div(V a, V) { return a; } // Not used since HasDiv is false
+    DMC_DECL static bool alleq(V a, V b) { return alleqi(a, b); }
+    DMC_DECL static void storeMinMax(E* p, V v) { storei(p, v); }
+    DMC_DECL static A azero() { return zeroi(); }
+    DMC_DECL static void astore(double* out, const A* acc)
+    {
+        for (int k = 0; k < K; k++) {
+            unsigned int tmp[AN];
+            storei(tmp, acc[k]);
+            for (int j = 0; j < AN; j++) out[k * AN + j] = tmp[j];
+        }
+    }
+};
+
+#if DMC_SIMD_WIDTH == 256
+// Halfs are widened to float with F16C and do their math in float, just like class half does.
+// Narrowing uses halfBits() to get half's own rounding (round half away from zero), so results match the scalar code.
+template <> struct Traits<half> {
+    static const bool Supported = true;
+    static const bool HasDiv = true;
+    typedef half E;
+    typedef VF V;
+    typedef VF A;
+    static const int N = 8;
+    static const int K = 1;
+    static const int AN = N;
+    static const size_t FlushBlocks = 256;
+
+    DMC_DECL static V load(const E* p) { return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p)); }
+    DMC_DECL static void store(E* p, V v) { storeHalfBits(p, halfBits(v)); }
+    DMC_DECL static V add(V a, V b) { return addf(a, b); }
+    DMC_DECL static V sub(V a, V b) { return subf(a, b); }
+    DMC_DECL static V mul(V a, V b) { return mulf(a, b); }
+    DMC_DECL static V div(V a, V b) { return divf(a, b); }
+    DMC_DECL static V vmin(V a, V b) { return minf(a, b); }
+    DMC_DECL static V vmax(V a, V b) { return maxf(a, b); }
+    DMC_DECL static bool alleq(V a, V b) { return alleqf(a, b); }
+    DMC_DECL static void storeMinMax(E* p, V v) { store(p, v); } // Exact since the values came from halfs
+    DMC_DECL static A azero() { return zerof(); }
+    DMC_DECL static void accum(A* acc, V v) { acc[0] = addf(acc[0], v); }
+    DMC_DECL static void astore(double* out, const A* acc)
+    {
+        float tmp[AN];
+        storef(tmp, acc[0]);
+        for (int j = 0; j < AN; j++) out[j] = tmp[j];
+    }
+};
+#endif
+
+// Returns a op b, for vectors and for the scalar leftovers.
+template <class T, ElemOp_e Op> DMC_DECL typename T::V applyOp(typename T::V a, typename T::V b)
+{
+    if constexpr (Op == ELEM_ADD)
+        return T::add(a, b);
+    else if constexpr (Op == ELEM_SUB)
+        return T::sub(a, b);
+    else if constexpr (Op == ELEM_MUL)
+        return T::mul(a, b);
+    else
+        return T::div(a, b);
+}
+
+template <class Elem_T, ElemOp_e Op> DMC_DECL void applyOpScalar(Elem_T& a, const Elem_T& b)
+{
+    if constexpr (Op == ELEM_ADD)
+        add_asgn(a, b);
+    else if constexpr (Op == ELEM_SUB)
+        sub_asgn(a, b);
+    else if constexpr (Op == ELEM_MUL)
+        mult_asgn(a, b);
+    else
+        a /= b;
+}
+
+template <class Elem_T, ElemOp_e Op> void elemOpArr(Elem_T* d, const Elem_T* s, const size_t n)
+{
+    typedef Traits<Elem_T> T;
+    size_t i = 0;
+    for (; i + T::N <= n; i += T::N) T::store(d + i, applyOp<T, Op>(T::load(d + i), T::load(s + i)));
+    for (; i < n; i++) applyOpScalar<Elem_T, Op>(d[i], s[i]);
+}
+
+template <class Elem_T, ElemOp_e Op> void elemOpPix(Elem_T* d, const size_t n, const Elem_T* pix, const int chan)
+{
+    typedef Traits<Elem_T> T;
+    const int B = chan * T::N; // Elements per block
+
+    Elem_T patEl[4 * T::N];
+    for (int j = 0; j < B; j++) patEl[j] = pix[j % chan];
+    typename T::V pat[4];
+    for (int k = 0; k < chan; k++) pat[k] = T::load(patEl + k * T::N);
+
+    size_t i = 0;
+    for (; i + B <= n; i += B)
+        for (int k = 0; k < chan; k++) T::store(d + i + k * T::N, applyOp<T, Op>(T::load(d + i + k * T::N), pat[k]));
+    for (; i < n; i++) applyOpScalar<Elem_T, Op>(d[i], pix[i % chan]);
+}
+
+template <class Elem_T> bool ElemOp(const ElemOp_e op, Elem_T* d, const Elem_T* s, const size_t n)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        switch (op) {
+        case ELEM_ADD: elemOpArr<Elem_T, ELEM_ADD>(d, s, n); return true;
+        case ELEM_SUB: elemOpArr<Elem_T, ELEM_SUB>(d, s, n); return true;
+        case ELEM_MUL: elemOpArr<Elem_T, ELEM_MUL>(d, s, n); return true;
+        case ELEM_DIV:
+            if constexpr (T::HasDiv) {
+                elemOpArr<Elem_T, ELEM_DIV>(d, s, n);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+template <class Elem_T> bool ElemOpPixel(const ElemOp_e op, Elem_T* d, const size_t n, const Elem_T* pix, const int chan)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        if (chan < 1 || chan > 4) return false;
+        switch (op) {
+        case ELEM_ADD: elemOpPix<Elem_T, ELEM_ADD>(d, n, pix, chan); return true;
+        case ELEM_SUB: elemOpPix<Elem_T, ELEM_SUB>(d, n, pix, chan); return true;
+        case ELEM_MUL: elemOpPix<Elem_T, ELEM_MUL>(d, n, pix, chan); return true;
+        case ELEM_DIV:
+            if constexpr (T::HasDiv) {
+                elemOpPix<Elem_T, ELEM_DIV>(d, n, pix, chan);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// Fill nbytes of d with copies of the pixBytes bytes at pix. Works for any pixel type.
+inline bool Fill(void* d_, const size_t nbytes, const void* pix, const int pixBytes)
+{
+    if (pixBytes < 1 || pixBytes > 32) return false;
+    unsigned char* d = (unsigned char*)d_;
+    const int B = pixBytes * VBytes; // One block holds VBytes pixels, which is a whole number of vectors
+
+    unsigned char patBytes[32 * VBytes];
+    for (int j = 0; j < B; j++) patBytes[j] = ((const unsigned char*)pix)[j % pixBytes];
+    VI pat[32];
+    for (int k = 0; k < pixBytes; k++) pat[k] = loadi(patBytes + k * VBytes);
+
+    size_t i = 0;
+    for (; i + B <= nbytes; i += B)
+        for (int k = 0; k < pixBytes; k++) storei(d + i + k * VBytes, pat[k]);
+    if (i < nbytes) memcpy(d + i, patBytes, nbytes - i); // i is at a block boundary, so the pattern is in phase
+
+    return true;
+}
+
+#if DMC_SIMD_WIDTH == 256
+template <int PB> DMC_DECL VI cmpeqPix(VI a, VI b)
+{
+    if constexpr (PB == 1) return _mm256_cmpeq_epi8(a, b);
+    if constexpr (PB == 2) return _mm256_cmpeq_epi16(a, b);
+    if constexpr (PB == 4) return _mm256_cmpeq_epi32(a, b);
+    if constexpr (PB == 8) return _mm256_cmpeq_epi64(a, b);
+}
+#else
+template <int PB> DMC_DECL VI cmpeqPix(VI a, VI b)
+{
+    if constexpr (PB == 1) return _mm_cmpeq_epi8(a, b);
+    if constexpr (PB == 2) return _mm_cmpeq_epi16(a, b);
+    if constexpr (PB == 4) return _mm_cmpeq_epi32(a, b);
+    if constexpr (PB == 8) return _mm_cmpeq_epi64(a, b);
+}
+#endif
+
+template <int PB> void keyedCopy(unsigned char* d, const unsigned char* s, const size_t nbytes, const unsigned char* key)
+{
+    unsigned char keyBytes[VBytes];
+    for (int j = 0; j < VBytes; j++) keyBytes[j] = key[j % PB];
+    const VI k = loadi(keyBytes);
+
+    size_t i = 0;
+    for (; i + VBytes <= nbytes; i += VBytes) {
+        const VI v = loadi(s + i);
+        storei(d + i, selecti(cmpeqPix<PB>(v, k), loadi(d + i), v));
+    }
+    for (; i < nbytes; i += PB)
+        if (memcmp(s + i, key, PB)) memcpy(d + i, s + i, PB);
+}
+
+// Copy the n pixels of pixBytes bytes at s to d, except those whose bytes equal the pixel at key. pixBytes is 1, 2, 4, or 8.
+inline bool KeyedCopy(void* d_, const void* s_, const size_t n, const void* key_, const int pixBytes)
+{
+    unsigned char* d = (unsigned char*)d_;
+    const unsigned char* s = (const unsigned char*)s_;
+    const unsigned char* key = (const unsigned char*)key_;
+    switch (pixBytes) {
+    case 1: keyedCopy<1>(d, s, n, key); return true;
+    case 2: keyedCopy<2>(d, s, n * 2, key); return true;
+    case 4: keyedCopy<4>(d, s, n * 4, key); return true;
+    case 8: keyedCopy<8>(d, s, n * 8, key); return true;
+    default: return false;
+    }
+}
+
+// Channel-wise extrema of n elements with chan channels.
+template <class Elem_T> bool MinMax(const Elem_T* s, const size_t n, const int chan, Elem_T* cmin, Elem_T* cmax)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        const int B = chan * T::N;
+        if (chan < 1 || chan > 4 || n < size_t(B)) return false;
+
+        typename T::V vmn[4], vmx[4];
+        for (int k = 0; k < chan; k++) vmn[k] = vmx[k] = T::load(s + k * T::N);
+
+        size_t i = B;
+        for (; i + B <= n; i += B) {
+            for (int k = 0; k < chan; k++) {
+                typename T::V v = T::load(s + i + k * T::N);
+                vmn[k] = T::vmin(v, vmn[k]);
+                vmx[k] = T::vmax(v, vmx[k]);
+            }
+        }
+
+        Elem_T mn[4 * T::N], mx[4 * T::N];
+        for (int k = 0; k < chan; k++) {
+            T::storeMinMax(mn + k * T::N, vmn[k]);
+            T::storeMinMax(mx + k * T::N, vmx[k]);
+        }
+        for (int c = 0; c < chan; c++) cmin[c] = mn[c], cmax[c] = mx[c];
+        for (int j = chan; j < B; j++) {
+            cmin[j % chan] = std::min(cmin[j % chan], mn[j]);
+            cmax[j % chan] = std::max(cmax[j % chan], mx[j]);
+        }
+        for (; i < n; i++) {
+            cmin[i % chan] = std::min(cmin[i % chan], s[i]);
+            cmax[i % chan] = std::max(cmax[i % chan], s[i]);
+        }
+
+        return true;
+    }
+}
+
+// d[i] = min(a[i], b[i]), or max if isMax, for n elements.
+template <class Elem_T> bool MinOrMax(const bool isMax, Elem_T* d, const Elem_T* a, const Elem_T* b, const size_t n)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        size_t i = 0;
+        if (isMax) {
+            for (; i + T::N <= n; i += T::N) T::storeMinMax(d + i, T::vmax(T::load(a + i), T::load(b + i)));
+            for (; i < n; i++) d[i] = std::max(b[i], a[i]);
+        } else {
+            for (; i + T::N <= n; i += T::N) T::storeMinMax(d + i, T::vmin(T::load(a + i), T::load(b + i)));
+            for (; i < n; i++) d[i] = std::min(b[i], a[i]);
+        }
+        return true;
+    }
+}
+
+// Channel-wise sum of n elements with chan channels.
+template <class Elem_T> bool SumChan(const Elem_T* s, const size_t n, const int chan, double* sums)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        if (chan < 1 || chan > 4) return false;
+        const int B = chan * T::N;
+        const int NA = chan * T::K; // Accumulator registers
+
+        for (int c = 0; c < chan; c++) sums[c] = 0;
+
+        typename T::A acc[4 * T::K];
+        size_t i = 0;
+        while (i + B <= n) {
+            for (int a = 0; a < NA; a++) acc[a] = T::azero();
+            for (size_t blk = 0; blk < T::FlushBlocks && i + B <= n; blk++, i += B)
+                for (int k = 0; k < chan; k++) T::accum(acc + k * T::K, T::load(s + i + k * T::N));
+
+            for (int k = 0; k < chan; k++) {
+                double lanes[T::K * T::AN];
+                T::astore(lanes, acc + k * T::K);
+                for (int j = 0; j < T::K * T::AN; j++) sums[(k * T::N + j) % chan] += lanes[j];
+            }
+        }
+        for (; i < n; i++) sums[i % chan] += double(s[i]);
+
+        return true;
+    }
+}
+
+// Test whether the two arrays are equal using the element type's operator==.
+template <class Elem_T> bool Equal(const Elem_T* a, const Elem_T* b, const size_t n, bool& equal)
+{
+    typedef Traits<Elem_T> T;
+    if constexpr (!T::Supported) {
+        return false;
+    } else {
+        equal = false;
+        size_t i = 0;
+        for (; i + T::N <= n; i += T::N)
+            if (!T::alleq(T::load(a + i), T::load(b + i))) return true;
+        for (; i < n; i++)
+            if (!(a[i] == b[i])) return true;
+        equal = true;
+        return true;
+    }
+}
+
+// Conversions between element types. Each gives exactly what basePixel::channel_cast gives.
+// Normalized integers are widened to float lanes and divided by their one(), and floats are scaled, clamped, and truncated.
+
+#if DMC_SIMD_WIDTH == 256
+const int CvtN = 8; // Elements per float vector
+DMC_DECL VF widen(const unsigned char* p) { return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+DMC_DECL VF widen(const unsigned short* p) { return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+// Truncate lanes that are already in range to 16 bits, in the low half
+DMC_DECL __m128i narrow16(VF v)
+{
+    const VI i = _mm256_cvttps_epi32(v);
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(i, i), 0x08));
+}
+DMC_DECL void narrow(unsigned short* p, VF v) { _mm_storeu_si128((__m128i*)p, narrow16(v)); }
+DMC_DECL void narrow(unsigned char* p, VF v)
+{
+    const __m128i h = narrow16(v);
+    _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(h, h));
+}
+#else
+const int CvtN = 4;
+DMC_DECL VF widen(const unsigned char* p)
+{
+    int x;
+    memcpy(&x, p, 4);
+    return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(x)));
+}
+DMC_DECL VF widen(const unsigned short* p) { return _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+DMC_DECL __m128i narrow16(VF v)
+{
+    const VI i = _mm_cvttps_epi32(v);
+    return _mm_packus_epi32(i, i);
+}
+DMC_DECL void narrow(unsigned short* p, VF v) { _mm_storel_epi64((__m128i*)p, narrow16(v)); }
+DMC_DECL void narrow(unsigned char* p, VF v)
+{
+    const __m128i h = narrow16(v);
+    const int x = _mm_cvtsi128_si32(_mm_packus_epi16(h, h));
+    memcpy(p, &x, 4);
+}
+#endif
+
+// unsigned char or unsigned short to float
+template <class Src_T> bool ConvertToFloat(float* d, const Src_T* s, const size_t n)
+{
+    const VF one = set1f(float(element_traits<Src_T>::one()));
+    size_t i = 0;
+    for (; i + CvtN <= n; i += CvtN) storef(d + i, divf(widen(s + i), one));
+    for (; i < n; i++) basePixel::channel_cast(d[i], s[i]);
+    return true;
+}
+
+// float to unsigned char or unsigned short. NaN becomes 0, as in clamp().
+template <class Dst_T> bool ConvertFromFloat(Dst_T* d, const float* s, const size_t n)
+{
+    const VF one = set1f(float(element_traits<Dst_T>::one())), z = zerof();
+    size_t i = 0;
+    for (; i + CvtN <= n; i += CvtN) narrow(d + i, minf(maxf(mulf(loadf(s + i), one), z), one));
+    for (; i < n; i++) basePixel::channel_cast(d[i], s[i]);
+    return true;
+}
+
+// unsigned short to unsigned char, rounding
+inline bool ConvertUSToUC(unsigned char* d, const unsigned short* s, const size_t n)
+{
+    const int N = VBytes / 2;
+    size_t i = 0;
+#if DMC_SIMD_WIDTH == 256
+    const VI one = _mm256_set1_epi16(1);
+    for (; i + N <= n; i += N) {
+        const VI r = _mm256_srli_epi16(_mm256_add_epi16(_mm256_srli_epi16(loadi(s + i), 7), one), 1);
+        _mm_storeu_si128((__m128i*)(d + i), _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(r, r), 0x08)));
+    }
+#else
+    const VI one = _mm_set1_epi16(1);
+    for (; i + N <= n; i += N) {
+        const VI r = _mm_srli_epi16(_mm_add_epi16(_mm_srli_epi16(loadi(s + i), 7), one), 1);
+        _mm_storel_epi64((__m128i*)(d + i), _mm_packus_epi16(r, r));
+    }
+#endif
+    for (; i < n; i++) basePixel::channel_cast(d[i], s[i]);
+    return true;
+}
+
+// unsigned char to unsigned short by replicating the byte
+inline bool ConvertUCToUS(unsigned short* d, const unsigned char* s, const size_t n)
+{
+    const int N = VBytes / 2;
+    size_t i = 0;
+#if DMC_SIMD_WIDTH == 256
+    for (; i + N <= n; i += N) {
+        const VI w = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(s + i)));
+        storei(d + i, _mm256_or_si256(w, _mm256_slli_epi16(w, 8)));
+    }
+#else
+    for (; i + N <= n; i += N) {
+        const VI w = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(s + i)));
+        storei(d + i, _mm_or_si128(w, _mm_slli_epi16(w, 8)));
+    }
+#endif
+    for (; i < n; i++) basePixel::channel_cast(d[i], s[i]);
+    return true;
+}
+
+// half to float. F16C where there is AVX2, which quiets signaling NaNs, and otherwise halfBitsToFloat().
+inline void HalfToFloat(float* d, const half* s, const size_t n)
+{
+    size_t i = 0;
+#if DMC_SIMD_WIDTH == 256
+    for (; i + CvtN <= n; i += CvtN) storef(d + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(s + i))));
+#else
+    for (; i + CvtN <= n; i += CvtN) storef(d + i, halfBitsToFloat(_mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(s + i)))));
+#endif
+    for (; i < n; i++) d[i] = HalfBitsToFloat(s[i].bits());
+}
+
+// float to half, rounding like class half
+inline void FloatToHalf(half* d, const float* s, const size_t n)
+{
+    size_t i = 0;
+    for (; i + CvtN <= n; i += CvtN) storeHalfBits(d + i, halfBits(loadf(s + i)));
+    for (; i < n; i++) d[i].setBits(FloatToHalfBits(s[i]));
+}
+
+// Conversions between half and the normalized types go through float a block at a time.
+// channel_cast does the same, so this is still exact.
+const size_t CvtBlock = 256;
+
+template <class Src_T> bool ConvertToHalf(half* d, const Src_T* s, const size_t n)
+{
+    float tmp[CvtBlock];
+    for (size_t i = 0; i < n; i += CvtBlock) {
+        const size_t m = std::min(CvtBlock, n - i);
+        ConvertToFloat(tmp, s + i, m);
+        DMC_SIMD_NS::FloatToHalf(d + i, tmp, m);
+    }
+    return true;
+}
+
+template <class Dst_T> bool ConvertFromHalf(Dst_T* d, const half* s, const size_t n)
+{
+    float tmp[CvtBlock];
+    for (size_t i = 0; i < n; i += CvtBlock) {
+        const size_t m = std::min(CvtBlock, n - i);
+        DMC_SIMD_NS::HalfToFloat(tmp, s + i, m);
+        ConvertFromFloat(d + i, tmp, m);
+    }
+    return true;
+}
+
+// Separable convolution passes. Each lane multiplies and adds the taps in order, exactly like the scalar loop.
+// Two vectors are in flight at a time to cover the add latency.
+const int ConvN = VBytes / 4; // Floats per vector
+
+inline bool ConvolveRow(float* d, const float* s, const size_t n, const int stride, const float* K, const int N)
+{
+    s -= ptrdiff_t(N / 2) * stride;
+    size_t i = 0;
+    for (; i + 2 * ConvN <= n; i += 2 * ConvN) {
+        VF a0 = zerof(), a1 = zerof();
+        const float* p = s + i;
+        for (int k = 0; k < N; k++, p += stride) {
+            const VF w = set1f(K[k]);
+            a0 = addf(a0, mulf(w, loadf(p)));
+            a1 = addf(a1, mulf(w, loadf(p + ConvN)));
+        }
+        storef(d + i, a0);
+        storef(d + i + ConvN, a1);
+    }
+    for (; i < n; i++) {
+        float sum = 0;
+        for (int k = 0; k < N; k++) sum += K[k] * s[i + ptrdiff_t(k) * stride];
+        d[i] = sum;
+    }
+    return true;
+}
+
+inline bool ConvolveCol(float* d, const float* const* rows, const size_t n, const float* K, const int N)
+{
+    size_t i = 0;
+    for (; i + 2 * ConvN <= n; i += 2 * ConvN) {
+        VF a0 = zerof(), a1 = zerof();
+        for (int k = 0; k < N; k++) {
+            const VF w = set1f(K[k]);
+            a0 = addf(a0, mulf(w, loadf(rows[k] + i)));
+            a1 = addf(a1, mulf(w, loadf(rows[k] + i + ConvN)));
+        }
+        storef(d + i, a0);
+        storef(d + i + ConvN, a1);
+    }
+    for (; i < n; i++) {
+        float sum = 0;
+        for (int k = 0; k < N; k++) sum += K[k] * rows[k][i];
+        d[i] = sum;
+    }
+    return true;
+}
+
+// One pass of a polyphase resampling. The lanes are taps of one output, so the loads are contiguous, and two outputs
+// are in flight at a time to cover the add latency. N is padded with zero weights to a multiple of 8.
+inline bool ResampleRow(float* d, const float* s, const size_t n, const int* Start, const float* W, const int N)
+{
+    if (N % ConvN) return false;
+    size_t o = 0;
+    for (; o + 2 <= n; o += 2) {
+        VF a0 = zerof(), a1 = zerof();
+        const float *p0 = s + Start[o], *p1 = s + Start[o + 1], *w0 = W + o * N, *w1 = w0 + N;
+        for (int k = 0; k < N; k += ConvN) {
+            a0 = addf(a0, mulf(loadf(w0 + k), loadf(p0 + k)));
+            a1 = addf(a1, mulf(loadf(w1 + k), loadf(p1 + k)));
+        }
+        d[o] = hsumf(a0);
+        d[o + 1] = hsumf(a1);
+    }
+    for (; o < n; o++) {
+        VF a = zerof();
+        const float *p = s + Start[o], *w = W + o * N;
+        for (int k = 0; k < N; k += ConvN) a = addf(a, mulf(loadf(w + k), loadf(p + k)));
+        d[o] = hsumf(a);
+    }
+    return true;
+}
+
+// One tap of a VCD window. The range weight is looked up in the table with a gather, and the lanes are separate pixels.
+inline bool VCDTap(float* const* Acc, float* Wsum, const float* const* S, const float* const* P, const int C, const size_t n, const float K,
+                   const float* Table, const float maxIndex, const float scale)
+{
+    size_t i = 0;
+    for (; i + ConvN <= n; i += ConvN) {
+        VF s[4], d2 = zerof();
+        for (int c = 0; c < C; c++) {
+            s[c] = loadf(S[c] + i);
+            const VF d = subf(s[c], loadf(P[c] + i));
+            d2 = addf(d2, mulf(d, d));
+        }
+        const VF f = minf(mulf(d2, set1f(scale)), set1f(maxIndex));
+        const VI fi = cvttf(f);
+        const VF t = subf(f, cvtif(fi));
+        const VF g0 = gatherf(Table, fi), g1 = gatherf(Table + 1, fi);
+        const VF w = mulf(set1f(K), addf(g0, mulf(t, subf(g1, g0))));
+        for (int c = 0; c < C; c++) storef(Acc[c] + i, addf(loadf(Acc[c] + i), mulf(w, s[c])));
+        storef(Wsum + i, addf(loadf(Wsum + i), w));
+    }
+    for (; i < n; i++) {
+        float d2 = 0;
+        for (int c = 0; c < C; c++) {
+            const float d = S[c][i] - P[c][i];
+            d2 += d * d;
+        }
+        const float sd2 = d2 * scale;
+        const float f = sd2 < maxIndex ? sd2 : maxIndex; // Like minf(), NaN gives maxIndex
+        const int fi = int(f);
+        const float t = f - float(fi);
+        const float w = K * (Table[fi] + t * (Table[fi + 1] - Table[fi]));
+        for (int c = 0; c < C; c++) Acc[c][i] += w * S[c][i];
+        Wsum[i] += w;
+    }
+    return true;
+}
+
+}; // namespace DMC_SIMD_NS
@@ -292,7 +292,7 @@ void ImageLoadSave::LoadRas(const std::string& fname)
     if (Hedr.ras_type == RT_FORMAT_RGB) {
         if (Hedr.ras_maptype == RMT_NONE) {
             // Now read the color values.
-            for (int y = 0; y < hgt; y++) { InFile.read((char*)&Pix[y * wid * 3], wid * 3); }
+            for (int y = 0; y < hgt; y++) { InFile.read((char*)&Pix[size_t(y) * wid * 3], wid * 3); }
         } else if (Hedr.ras_maptype == RMT_EQUAL_RGB) {
             if (SP.verbose) std::cerr << "Reading color mapped image. Maplength = " << Hedr.ras_maplength << std::endl;
 
@@ -304,11 +304,11 @@ void ImageLoadSave::LoadRas(const std::string& fname)
                 InFile.read((char*)Colors, wid);
 
                 for (int x = 0; x < wid;) {
-                    Pix[y * wid + x] = ColorMap[Colors[x]][0];
+                    Pix[size_t(y) * wid + x] = ColorMap[Colors[x]][0];
                     x++;
-                    Pix[y * wid + x] = ColorMap[Colors[x]][1];
+                    Pix[size_t(y) * wid + x] = ColorMap[Colors[x]][1];
                     x++;
-                    Pix[y * wid + x] = ColorMap[Colors[x]][2];
+                    Pix[size_t(y) * wid + x] = ColorMap[Colors[x]][2];
                     x++;
                 }
             }
@@ -600,7 +600,7 @@ void ImageLoadSave::LoadJPEG(const std::string& fname)
     is_uint = false;
     is_float = false;
     Pix = ImageAlloc();
-    memcpy(Pix, image, wid * hgt * chan);
+    memcpy(Pix, image, size_t(wid) * hgt * chan);
     stbi_image_free(image);
 }
 
@@ -733,7 +733,7 @@ void ImageLoadSave::SaveTIFF(const std::string& fname) const
             TIFFClose(tif);
             throw DMcError("TIFFWriteScanline failed: " + string(fname));
         }
-        c += wid * chan * bytesperchan;
+        c += size_t(wid) * chan * bytesperchan;
     }
 
     // Close the file and return OK
@@ -760,7 +760,7 @@ void ImageLoadSave::LoadPNG(const std::string& fname)
     is_uint = false;
     is_float = false;
     Pix = ImageAlloc();
-    memcpy(Pix, image, wid * hgt * chan);
+    memcpy(Pix, image, size_t(wid) * hgt * chan);
     stbi_image_free(image);
 }
 
@@ -836,10 +836,10 @@ void ImageLoadSave::SaveMAT(const std::string& fname) const
             // Transpose the data. I hate this.
             unsigned short* ImTr = (unsigned short*)mxGetPr(pa);
             unsigned short* usPix = (unsigned short*)Pix;
-            int k = 0;
+            int64_t k = 0;
             for (int y = 0; y < hgt; y++) {
                 for (int x = 0; x < wid; x++) {
-                    for (int c = 0; c < chan; c++) { ImTr[(x * hgt + y) * chan + c] = usPix[k++]; }
+                    for (int c = 0; c < chan; c++) { ImTr[(size_t(x) * hgt + y) * chan + c] = usPix[k++]; }
                 }
             }
     } else {
@@ -900,7 +900,7 @@ void ImageLoadSave::LoadRGBE(const std::string& fname)
     float invexp = 1.0f / exposure;
 
     /* Convert RGBE representation to float,float,float representation */
-    int k = 0;
+    int64_t k = 0;
     float* P = (float*)Pix;
     for (row = 0; row < hgt; row++) {
         freadscan(oneRow, helpit, wid, filep);
@@ -957,7 +957,7 @@ void ImageLoadSave::SaveRGBE(const std::string& fname) const
         }
         // fwritescan(oneRow, helpit, wid, filep);
 #endif
-        fwritescan((COLOR*)&P[row * wid * 3], helpit, wid, filep);
+        fwritescan((COLOR*)&P[size_t(row) * wid * 3], helpit, wid, filep);
     }
     fclose(filep);
 
@@ -1010,6 +1010,9 @@ template <class Image_T> const baseImage* ImageLoadSave::ConvertToSaveFormat(con
         }
     }
 
+    // The savers expect tightly packed rows, and copies are always tight.
+    if (outImg == srcImg && !srcImg->contiguous()) outImg = new Image_T(*srcImg);
+
     return outImg;
 }
 template const baseImage* ImageLoadSave::ConvertToSaveFormat(const std::string& fname, const h1Image* srcImg);
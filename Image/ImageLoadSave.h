@@ -7,6 +7,7 @@
 
 #include "Image/LoadSaveParams.h"
 
+#include <cstdint>
 #include <string>
 
 class baseImage;
@@ -29,8 +30,8 @@ public:
 
     ~ImageLoadSave();
 
-    int size() const { return wid * hgt; }
-    int size_bytes() const { return size() * chan * ((is_uint || is_float) ? 4 : is_ushort ? 2 : 1); }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    int64_t size_bytes() const { return size() * chan * ((is_uint || is_float) ? 4 : is_ushort ? 2 : 1); }
 
     // Hooks the given raster image into this image object.
     void SetImage(unsigned char* p, const int w, const int h, const int ch, const bool is_uint_ = false, const bool is_ushort_ = false,
@@ -0,0 +1,325 @@
+//////////////////////////////////////////////////////////////////////
+// ImageMorphology.cpp - Erosion, dilation, opening, closing, and despeckling over square windows
+//
+// Copyright David K. McAllister, 2026.
+
+#include "Image/ImageAlgorithms.h"
+
+#include "Image/ImageConvert.h"
+#include "Image/ImageKernels.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+// d = min(a, b), or max if isMax, for n elements. d may be a or b.
+template <class Elem_T> void minOrMax(const bool isMax, Elem_T* d, const Elem_T* a, const Elem_T* b, const size_t n)
+{
+    if (SIMDMinOrMax(isMax, d, a, b, n)) return;
+    if (isMax)
+        for (size_t i = 0; i < n; i++) d[i] = std::max(b[i], a[i]);
+    else
+        for (size_t i = 0; i < n; i++) d[i] = std::min(b[i], a[i]);
+}
+
+// D[i] is the elementwise min, or max, of rows S[i + a] ... S[i + b], with the row numbers clamped to 0 ... n - 1, for
+// n rows of rowEls elements. D must not share rows with S.
+//
+// This is van Herk and Gil-Werman's algorithm. The window is k = b - a + 1 rows. Cut the clamped rows into blocks of k
+// starting at row a. Each window then spans the end of one block and the start of the next, so it is the extreme of a
+// suffix of the first block, run backward through the block, and a prefix of the second, run forward as the window
+// advances. That's three min or max per element whatever k is. The passes are whole rows, so they use the SIMD kernel,
+// and bands of columns run on multiple threads, each keeping a block of suffix rows only as wide as its band.
+template <class Elem_T> void slideRows(const bool isMax, Elem_T* const* D, const Elem_T* const* S, const int n, const size_t rowEls, const int a, const int b)
+{
+    const int k = b - a + 1;
+    auto src = [&](const int q) { return S[std::clamp(q + a, 0, n - 1)]; }; // Row q of the blocks
+
+    const size_t BandEls = std::max(size_t(64), (size_t(1) << 18) / (sizeof(Elem_T) * k)) & ~size_t(63); // Suffix rows fit in cache
+    const int numBands = int((rowEls + BandEls - 1) / BandEls);
+    ParallelForRanges(numBands, std::max(1, int(ConvertParallelPixels / (int64_t(n) * BandEls))), [&](const int b0, const int b1) {
+        const size_t e0 = b0 * BandEls, e1 = std::min(rowEls, b1 * BandEls), len = e1 - e0;
+        std::vector<Elem_T> Suf(size_t(k) * len), Pre(len);
+
+        for (int q0 = 0; q0 < n; q0 += k) {
+            Elem_T* last = &Suf[size_t(k - 1) * len];
+            std::copy(src(q0 + k - 1) + e0, src(q0 + k - 1) + e1, last);
+            for (int t = k - 2; t >= 0; t--) minOrMax(isMax, &Suf[size_t(t) * len], &Suf[size_t(t + 1) * len], src(q0 + t) + e0, len);
+
+            // The window at q0 is exactly this block, and the rest take a prefix of the next block.
+            std::copy(Suf.begin(), Suf.begin() + len, D[q0] + e0);
+            for (int t = 1; t < std::min(k, n - q0); t++) {
+                const Elem_T* p = src(q0 + k + t - 1) + e0;
+                if (t == 1)
+                    std::copy(p, p + len, Pre.data());
+                else
+                    minOrMax(isMax, Pre.data(), Pre.data(), p, len);
+                minOrMax(isMax, D[q0 + t] + e0, &Suf[size_t(t) * len], Pre.data(), len);
+            }
+        }
+    });
+}
+
+// D[x][y] = S[y][x] for w columns and h rows of S, in tiles so that both sides stay in cache.
+template <class Pixel_T> void transposeRows(Pixel_T* const* D, const Pixel_T* const* S, const int w, const int h)
+{
+    const int Tile = 32;
+    ParallelForRanges((h + Tile - 1) / Tile, std::max(1, ConvertParallelPixels / (Tile * w)), [&](const int t0, const int t1) {
+        for (int y0 = t0 * Tile; y0 < std::min(h, t1 * Tile); y0 += Tile)
+            for (int x0 = 0; x0 < w; x0 += Tile)
+                for (int y = y0; y < std::min(h, y0 + Tile); y++)
+                    for (int x = x0; x < std::min(w, x0 + Tile); x++) D[x][y] = S[y][x];
+    });
+}
+
+// A w x h raster of pixels with pointers to its rows, for the passes to work on
+template <class Pixel_T> struct Plane {
+    typedef typename Pixel_T::ElType Elem_T;
+    std::vector<Pixel_T> Pix;
+    std::vector<Pixel_T*> Rows;
+    std::vector<Elem_T*> Els;
+
+    Plane(const int w, const int h) : Pix(size_t(w) * h), Rows(h), Els(h)
+    {
+        for (int y = 0; y < h; y++) {
+            Rows[y] = Pix.data() + size_t(y) * w;
+            Els[y] = reinterpret_cast<Elem_T*>(Rows[y]);
+        }
+    }
+};
+
+// Rows to read
+template <class Image_T> std::vector<typename Image_T::PixType*> imageRows(const Image_T& Img)
+{
+    std::vector<typename Image_T::PixType*> Rows(Img.h());
+    for (int y = 0; y < Img.h(); y++) Rows[y] = const_cast<typename Image_T::PixType*>(&Img(0, y));
+    return Rows;
+}
+
+// Rows to write, which gives a tImage its own raster if it shares one
+template <class Image_T> std::vector<typename Image_T::PixType*> outRows(Image_T& Img)
+{
+    std::vector<typename Image_T::PixType*> Rows(Img.h());
+    for (int y = 0; y < Img.h(); y++) Rows[y] = &Img(0, y);
+    return Rows;
+}
+
+template <class Pixel_T> std::vector<typename Pixel_T::ElType*> elemRows(const std::vector<Pixel_T*>& Rows)
+{
+    std::vector<typename Pixel_T::ElType*> Els(Rows.size());
+    for (size_t y = 0; y < Rows.size(); y++) Els[y] = reinterpret_cast<typename Pixel_T::ElType*>(Rows[y]);
+    return Els;
+}
+
+// Windows this many pixels wide or narrower slide across the rows directly. Wider ones transpose the rows so slideRows
+// can run down them.
+const int DirectCols = 7;
+
+// D[y][x] is the channel-wise min, or max, of S[y][x + a] ... S[y][x + b], with the columns clamped to 0 ... w - 1, for h
+// rows of w pixels. D must not share rows with S.
+template <class Pixel_T> void slideCols(const bool isMax, Pixel_T* const* D, const Pixel_T* const* S, const int w, const int h, const int a, const int b)
+{
+    typedef typename Pixel_T::ElType Elem_T;
+    const int C = Pixel_T::Chan;
+
+    if (b - a + 1 > DirectCols) {
+        Plane<Pixel_T> T(h, w), T2(h, w);
+        transposeRows(T.Rows.data(), S, w, h);
+        slideRows(isMax, T2.Els.data(), T.Els.data(), w, size_t(h) * C, a, b);
+        transposeRows(D, T2.Rows.data(), h, w);
+        return;
+    }
+
+    // Each pixel of the window is the row shifted by a whole number of pixels, so extend the edges of a copy of the row
+    // and take the extreme of the shifted copies.
+    const int padL = std::max(0, -a), padR = std::max(0, b);
+    ParallelForRanges(h, std::max(1, ConvertParallelPixels / w), [&](const int y0, const int y1) {
+        std::vector<Pixel_T> Buf(size_t(padL) + w + padR);
+        for (int y = y0; y < y1; y++) {
+            std::fill(Buf.begin(), Buf.begin() + padL, S[y][0]);
+            std::copy(S[y], S[y] + w, Buf.begin() + padL);
+            std::fill(Buf.begin() + padL + w, Buf.end(), S[y][w - 1]);
+            const Elem_T* s = reinterpret_cast<const Elem_T*>(Buf.data() + padL);
+            Elem_T* d = reinterpret_cast<Elem_T*>(D[y]);
+            std::copy(s + a * C, s + (a + w) * C, d);
+            for (int t = a + 1; t <= b; t++) minOrMax(isMax, d, d, s + t * C, size_t(w) * C);
+        }
+    });
+}
+
+// Out(x, y) is the channel-wise min, or max, of Img over the window of radius r around x, y with the edges extended.
+template <class Image_T> void extremeFilter(Image_T& Out, const Image_T& Img, const bool isMax, const int r)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    const int w = Img.w(), h = Img.h();
+    ASSERT_R(r >= 0);
+    if (Img.size() < 1) {
+        Out.SetSize(w, h);
+        return;
+    }
+
+    // Read all of Img before sizing Out, since they may be the same image.
+    Plane<Pixel_T> V(w, h);
+    slideRows(isMax, V.Els.data(), elemRows(imageRows(Img)).data(), h, size_t(w) * Pixel_T::Chan, -r, r);
+    Out.SetSize(w, h);
+    slideCols(isMax, outRows(Out).data(), V.Rows.data(), w, h, -r, r);
+}
+
+// The channel-wise min, or max, over the window of radius r around each pixel of Img but not including the pixel itself.
+// Only pixels inside the image count. Extending the edges would make a border pixel its own neighbor, so the side of the
+// window that is off the image takes the other side instead. A 1 x 1 image has no neighbors, so Ex is the pixel itself.
+template <class Image_T> void neighborExtreme(Plane<typename Image_T::PixType>& Ex, const Image_T& Img, const bool isMax, const int r)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    const int w = Img.w(), h = Img.h();
+    const size_t rowEls = size_t(w) * Pixel_T::Chan;
+    const std::vector<Pixel_T*> In = imageRows(Img);
+
+    // The rows above and the rows below, across the whole window width
+    Plane<Pixel_T> A(w, h), B(w, h);
+    if (h > 1) {
+        slideRows(isMax, A.Els.data(), elemRows(In).data(), h, rowEls, -r, -1);
+        slideRows(isMax, B.Els.data(), elemRows(In).data(), h, rowEls, 1, r);
+        std::copy(B.Rows[0], B.Rows[0] + w, A.Rows[0]);
+        for (int y = 0; y < h - 1; y++) minOrMax(isMax, A.Els[y], A.Els[y], B.Els[y], rowEls);
+        slideCols(isMax, Ex.Rows.data(), A.Rows.data(), w, h, -r, r);
+    }
+
+    // The pixels to the left and to the right in the pixel's own row
+    if (w > 1) {
+        slideCols(isMax, A.Rows.data(), In.data(), w, h, -r, -1);
+        slideCols(isMax, B.Rows.data(), In.data(), w, h, 1, r);
+        for (int y = 0; y < h; y++) {
+            A.Rows[y][0] = B.Rows[y][0];
+            B.Rows[y][w - 1] = A.Rows[y][w - 1];
+            minOrMax(isMax, A.Els[y], A.Els[y], B.Els[y], rowEls);
+            if (h > 1)
+                minOrMax(isMax, Ex.Els[y], Ex.Els[y], A.Els[y], rowEls);
+            else
+                std::copy(A.Rows[y], A.Rows[y] + w, Ex.Rows[y]);
+        }
+    } else if (h == 1) {
+        Ex.Rows[0][0] = In[0][0];
+    }
+}
+}; // namespace
+
+template <class Image_T> void Erode(Image_T& Out, const Image_T& Img, const int radius) { extremeFilter(Out, Img, false, radius); }
+
+template <class Image_T> void Dilate(Image_T& Out, const Image_T& Img, const int radius) { extremeFilter(Out, Img, true, radius); }
+
+template <class Image_T> void MorphOpen(Image_T& Out, const Image_T& Img, const int radius)
+{
+    extremeFilter(Out, Img, false, radius);
+    extremeFilter(Out, Out, true, radius);
+}
+
+template <class Image_T> void MorphClose(Image_T& Out, const Image_T& Img, const int radius)
+{
+    extremeFilter(Out, Img, true, radius);
+    extremeFilter(Out, Out, false, radius);
+}
+
+// If a pixel is outside the bounding box of all its neighbors then clamp it into the box
+template <class Image_T> void Despeckle(Image_T& dstImg, const Image_T& srcImg, const int radius)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef typename Pixel_T::ElType Elem_T;
+    const int w = srcImg.w(), h = srcImg.h();
+    ASSERT_R(radius >= 1);
+    if (srcImg.size() < 1) {
+        dstImg.SetSize(w, h);
+        return;
+    }
+
+    Plane<Pixel_T> MinP(w, h), MaxP(w, h);
+    neighborExtreme(MinP, srcImg, false, radius);
+    neighborExtreme(MaxP, srcImg, true, radius);
+
+    const size_t rowEls = size_t(w) * Pixel_T::Chan;
+    for (int y = 0; y < h; y++) {
+        minOrMax(false, MaxP.Els[y], reinterpret_cast<const Elem_T*>(&srcImg(0, y)), MaxP.Els[y], rowEls);
+        minOrMax(true, MaxP.Els[y], MaxP.Els[y], MinP.Els[y], rowEls);
+    }
+
+    dstImg.SetSize(w, h);
+    for (int y = 0; y < h; y++) std::copy(MaxP.Rows[y], MaxP.Rows[y] + w, &dstImg(0, y));
+}
+
+template void Erode(f1Image& Out, const f1Image& Img, const int radius);
+template void Erode(f3Image& Out, const f3Image& Img, const int radius);
+template void Erode(f4Image& Out, const f4Image& Img, const int radius);
+template void Erode(h1Image& Out, const h1Image& Img, const int radius);
+template void Erode(h3Image& Out, const h3Image& Img, const int radius);
+template void Erode(h4Image& Out, const h4Image& Img, const int radius);
+template void Erode(uc1Image& Out, const uc1Image& Img, const int radius);
+template void Erode(uc3Image& Out, const uc3Image& Img, const int radius);
+template void Erode(uc4Image& Out, const uc4Image& Img, const int radius);
+template void Erode(us1Image& Out, const us1Image& Img, const int radius);
+template void Erode(us3Image& Out, const us3Image& Img, const int radius);
+template void Erode(us4Image& Out, const us4Image& Img, const int radius);
+template void Erode(f1ImageView& Out, const f1ImageView& Img, const int radius);
+template void Erode(uc1ImageView& Out, const uc1ImageView& Img, const int radius);
+template void Erode(us1ImageView& Out, const us1ImageView& Img, const int radius);
+
+template void Dilate(f1Image& Out, const f1Image& Img, const int radius);
+template void Dilate(f3Image& Out, const f3Image& Img, const int radius);
+template void Dilate(f4Image& Out, const f4Image& Img, const int radius);
+template void Dilate(h1Image& Out, const h1Image& Img, const int radius);
+template void Dilate(h3Image& Out, const h3Image& Img, const int radius);
+template void Dilate(h4Image& Out, const h4Image& Img, const int radius);
+template void Dilate(uc1Image& Out, const uc1Image& Img, const int radius);
+template void Dilate(uc3Image& Out, const uc3Image& Img, const int radius);
+template void Dilate(uc4Image& Out, const uc4Image& Img, const int radius);
+template void Dilate(us1Image& Out, const us1Image& Img, const int radius);
+template void Dilate(us3Image& Out, const us3Image& Img, const int radius);
+template void Dilate(us4Image& Out, const us4Image& Img, const int radius);
+template void Dilate(f1ImageView& Out, const f1ImageView& Img, const int radius);
+template void Dilate(uc1ImageView& Out, const uc1ImageView& Img, const int radius);
+template void Dilate(us1ImageView& Out, const us1ImageView& Img, const int radius);
+
+template void MorphOpen(f1Image& Out, const f1Image& Img, const int radius);
+template void MorphOpen(f3Image& Out, const f3Image& Img, const int radius);
+template void MorphOpen(f4Image& Out, const f4Image& Img, const int radius);
+template void MorphOpen(h1Image& Out, const h1Image& Img, const int radius);
+template void MorphOpen(h3Image& Out, const h3Image& Img, const int radius);
+template void MorphOpen(h4Image& Out, const h4Image& Img, const int radius);
+template void MorphOpen(uc1Image& Out, const uc1Image& Img, const int radius);
+template void MorphOpen(uc3Image& Out, const uc3Image& Img, const int radius);
+template void MorphOpen(uc4Image& Out, const uc4Image& Img, const int radius);
+template void MorphOpen(us1Image& Out, const us1Image& Img, const int radius);
+template void MorphOpen(us3Image& Out, const us3Image& Img, const int radius);
+template void MorphOpen(us4Image& Out, const us4Image& Img, const int radius);
+template void MorphOpen(f1ImageView& Out, const f1ImageView& Img, const int radius);
+template void MorphOpen(uc1ImageView& Out, const uc1ImageView& Img, const int radius);
+template void MorphOpen(us1ImageView& Out, const us1ImageView& Img, const int radius);
+
+template void MorphClose(f1Image& Out, const f1Image& Img, const int radius);
+template void MorphClose(f3Image& Out, const f3Image& Img, const int radius);
+template void MorphClose(f4Image& Out, const f4Image& Img, const int radius);
+template void MorphClose(h1Image& Out, const h1Image& Img, const int radius);
+template void MorphClose(h3Image& Out, const h3Image& Img, const int radius);
+template void MorphClose(h4Image& Out, const h4Image& Img, const int radius);
+template void MorphClose(uc1Image& Out, const uc1Image& Img, const int radius);
+template void MorphClose(uc3Image& Out, const uc3Image& Img, const int radius);
+template void MorphClose(uc4Image& Out, const uc4Image& Img, const int radius);
+template void MorphClose(us1Image& Out, const us1Image& Img, const int radius);
+template void MorphClose(us3Image& Out, const us3Image& Img, const int radius);
+template void MorphClose(us4Image& Out, const us4Image& Img, const int radius);
+template void MorphClose(f1ImageView& Out, const f1ImageView& Img, const int radius);
+template void MorphClose(uc1ImageView& Out, const uc1ImageView& Img, const int radius);
+template void MorphClose(us1ImageView& Out, const us1ImageView& Img, const int radius);
+
+template void Despeckle(f1Image& dstImg, const f1Image& srcImg, const int radius);
+template void Despeckle(f3Image& dstImg, const f3Image& srcImg, const int radius);
+template void Despeckle(f4Image& dstImg, const f4Image& srcImg, const int radius);
+template void Despeckle(h1Image& dstImg, const h1Image& srcImg, const int radius);
+template void Despeckle(h3Image& dstImg, const h3Image& srcImg, const int radius);
+template void Despeckle(h4Image& dstImg, const h4Image& srcImg, const int radius);
+template void Despeckle(uc1Image& dstImg, const uc1Image& srcImg, const int radius);
+template void Despeckle(uc3Image& dstImg, const uc3Image& srcImg, const int radius);
+template void Despeckle(uc4Image& dstImg, const uc4Image& srcImg, const int radius);
+template void Despeckle(us1Image& dstImg, const us1Image& srcImg, const int radius);
+template void Despeckle(us3Image& dstImg, const us3Image& srcImg, const int radius);
+template void Despeckle(us4Image& dstImg, const us4Image& srcImg, const int radius);
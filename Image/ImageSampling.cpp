@@ -5,9 +5,16 @@
 
 #include "Image/ImageAlgorithms.h"
 
-template <class Image_T> void Downsample2x2(Image_T& Out, const Image_T& Img)
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// Box filter for MIP level generation, etc.
+// The input and output types may differ so that a view can be downsampled into a new image.
+template <class OutImage_T, class InImage_T> void Downsample2x2Into(OutImage_T& Out, const InImage_T& Img)
 {
-    typedef typename Image_T::PixType::MathPixType MPT;
+    typedef typename InImage_T::PixType::MathPixType MPT;
 
     const int w1 = (1 + Img.w()) / 2; // Output image size
     const int h1 = (1 + Img.h()) / 2;
@@ -21,28 +28,23 @@ template <class Image_T> void Downsample2x2(Image_T& Out, const Image_T& Img)
         for (int x = 0; x < ws; x++) {
             Out(x, y) = (static_cast<MPT>(Img((x << 1), (y << 1))) + static_cast<MPT>(Img((x << 1) + 1, (y << 1))) +
                          static_cast<MPT>(Img((x << 1), (y << 1) + 1)) + static_cast<MPT>(Img((x << 1) + 1, (y << 1) + 1))) /
-                static_cast<typename Image_T::PixType::MathType>(4);
+                static_cast<typename InImage_T::PixType::MathType>(4);
         }
         if (w1 != ws)
             Out(ws, y) = (static_cast<MPT>(Img((ws << 1), (y << 1))) + static_cast<MPT>(Img((ws << 1), (y << 1) + 1))) /
-                static_cast<typename Image_T::PixType::MathType>(2);
+                static_cast<typename InImage_T::PixType::MathType>(2);
     }
     if (h1 != hs) {
         for (int x = 0; x < ws; x++) {
             Out(x, hs) = (static_cast<MPT>(Img((x << 1), (hs << 1))) + static_cast<MPT>(Img((x << 1) + 1, (hs << 1)))) /
-                static_cast<typename Image_T::PixType::MathType>(2);
+                static_cast<typename InImage_T::PixType::MathType>(2);
         }
         if (w1 != ws) Out(ws, hs) = Img((ws << 1), (hs << 1));
     }
 }
 
-template void Downsample2x2(f1Image& Out, const f1Image& Img);
-template void Downsample2x2(f3Image& Out, const f3Image& Img);
-template void Downsample2x2(f4Image& Out, const f4Image& Img);
-
-namespace {
 // Horizontal box filter for MIP level generation, etc.
-template <class Image_T> void Downsample2x1(Image_T& Out, const Image_T& Img)
+template <class OutImage_T, class InImage_T> void Downsample2x1(OutImage_T& Out, const InImage_T& Img)
 {
     const int w1 = (1 + Img.w()) / 2; // Output image size
     const int h1 = Img.h();
@@ -54,16 +56,16 @@ template <class Image_T> void Downsample2x1(Image_T& Out, const Image_T& Img)
 
     for (int y = 0; y < hs; y++) {
         for (int x = 0; x < ws; x++) {
-            Out(x, y) = (static_cast<typename Image_T::PixType::MathPixType>(Img((x << 1), y)) +
-                         static_cast<typename Image_T::PixType::MathPixType>(Img((x << 1) + 1, y))) /
-                static_cast<typename Image_T::PixType::MathType>(2);
+            Out(x, y) = (static_cast<typename InImage_T::PixType::MathPixType>(Img((x << 1), y)) +
+                         static_cast<typename InImage_T::PixType::MathPixType>(Img((x << 1) + 1, y))) /
+                static_cast<typename InImage_T::PixType::MathType>(2);
         }
         if (w1 != ws) Out(ws, y) = Img((ws << 1), y);
     }
 }
 
 // Vertical box filter for MIP level generation, etc.
-template <class Image_T> void Downsample1x2(Image_T& Out, const Image_T& Img)
+template <class OutImage_T, class InImage_T> void Downsample1x2(OutImage_T& Out, const InImage_T& Img)
 {
     const int w1 = Img.w(); // Output image size
     const int h1 = (1 + Img.h()) / 2;
@@ -75,9 +77,9 @@ template <class Image_T> void Downsample1x2(Image_T& Out, const Image_T& Img)
 
     for (int y = 0; y < hs; y++) {
         for (int x = 0; x < ws; x++) {
-            Out(x, y) = (static_cast<typename Image_T::PixType::MathPixType>(Img(x, (y << 1))) +
-                         static_cast<typename Image_T::PixType::MathPixType>(Img(x, (y << 1) + 1))) /
-                static_cast<typename Image_T::PixType::MathType>(2);
+            Out(x, y) = (static_cast<typename InImage_T::PixType::MathPixType>(Img(x, (y << 1))) +
+                         static_cast<typename InImage_T::PixType::MathPixType>(Img(x, (y << 1) + 1))) /
+                static_cast<typename InImage_T::PixType::MathType>(2);
         }
     }
     if (h1 != hs) {
@@ -110,7 +112,7 @@ template <class Image_T> struct sampler4 {
     DMC_DECL bool operator()(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
     {
         typedef typename element_traits<typename Image_T::PixType::ElType>::FloatMathType AccEl_T;
-        typedef Image_T::PixType Pixel_T;
+        typedef typename Image_T::PixType Pixel_T;
         typedef tPixel<AccEl_T, Pixel_T::Chan> AccPix_T;
 
         int xl = int(x) - 1;
@@ -164,7 +166,7 @@ template <class Image_T> struct sampler2 {
     DMC_DECL bool operator()(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
     {
         typedef typename element_traits<typename Image_T::PixType::ElType>::FloatMathType AccEl_T;
-        typedef Image_T::PixType Pixel_T;
+        typedef typename Image_T::PixType Pixel_T;
         typedef tPixel<AccEl_T, Pixel_T::Chan> AccPix_T;
 
         int x0 = int(x);
@@ -197,7 +199,7 @@ template <class Image_T> struct sampler1 {
     DMC_DECL bool operator()(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
     {
         typedef typename element_traits<typename Image_T::PixType::ElType>::FloatMathType AccEl_T;
-        typedef Image_T::PixType Pixel_T;
+        typedef typename Image_T::PixType Pixel_T;
         typedef tPixel<AccEl_T, Pixel_T::Chan> AccPix_T;
 
         int x0 = int(x + 0.5f);
@@ -210,68 +212,252 @@ template <class Image_T> struct sampler1 {
         return true;
     }
 };
-}; // namespace
 
-// For each pixel in output image, sample input image using SampF
-template <class Image_T, class Sampler_F> void ResizeWithSampler(Sampler_F SampF, Image_T& Out, const Image_T& Img, const int w1, const int h1)
-{
-    Out.SetSize(w1, h1);
-
-    if (Img.w() == w1 && Img.h() == h1) { // Short-circuit copy without resampling
-        Out = Img;
-        return;
+// The taps of one axis of a separable resampling. Output sample o is the sum over k < Count[o] of W[o * Taps + k] times
+// input sample Start[o] + k. The weights are computed once per output row or column rather than once per pixel, and
+// taps past the edge of the input are dropped and the rest renormalized. Taps is a multiple of 8, with zero weights
+// after Count[o], so SIMDResampleRow can run every output the same way.
+struct ResampleAxis {
+    int NIn, NOut;
+    int Taps, MaxCount;
+    std::vector<int> Start, Count;
+    std::vector<float> W;
+
+    ResampleAxis(const int nIn, const int nOut, const int maxTaps) : NIn(nIn), NOut(nOut), Taps((maxTaps + 7) & ~7), MaxCount(0)
+    {
+        Start.assign(nOut, 0);
+        Count.assign(nOut, 0);
+        W.assign(size_t(nOut) * Taps, 0.f);
     }
 
-    const float xstep = (Img.w() - 1) / float(w1 - 1);
-    const float ystep = (Img.h() - 1) / float(h1 - 1);
+    // Set output o to the n weights w for inputs first..first+n-1, keeping those in range and normalizing them.
+    void Set(const int o, int first, const float* w, int n)
+    {
+        if (first < 0) {
+            w -= first;
+            n += first;
+            first = 0;
+        }
+        n = std::min(n, NIn - first);
+        ASSERT_D(n > 0 && n <= Taps);
+
+        float sum = 0;
+        for (int k = 0; k < n; k++) sum += w[k];
+        float* d = &W[size_t(o) * Taps];
+        for (int k = 0; k < n; k++) d[k] = sum != 0.f ? w[k] / sum : (k == 0 ? 1.f : 0.f);
+        Start[o] = first;
+        Count[o] = n;
+        MaxCount = std::max(MaxCount, n);
+    }
+};
 
-    float yf = 0;
-    for (int y = 0; y < h1; y++) {
-        float xf = 0;
-        for (int x = 0; x < w1; x++) {
-            SampF(Out(x, y), Img, xf, yf);
-            xf += xstep;
+// The taps of the bilinear or bicubic samplers at input positions o * (nIn - 1) / (nOut - 1), so that the corner
+// pixels of input and output line up. These are the weights sampler2 and sampler4 would use at each pixel.
+ResampleAxis CornerAxis(const int nIn, const int nOut, const bool cubic)
+{
+    ResampleAxis A(nIn, nOut, 4);
+    const float step = nOut > 1 ? (nIn - 1) / float(nOut - 1) : 0.f;
+    for (int o = 0; o < nOut; o++) {
+        const float x = o * step;
+        if (cubic) {
+            const int xl = int(x) - 1;
+            const float w[4] = {CubicFilterF(x - float(xl)), CubicFilterN(x - float(xl + 1)), CubicFilterN(float(xl + 2) - x), CubicFilterF(float(xl + 3) - x)};
+            A.Set(o, xl, w, 4);
+        } else {
+            const int x0 = int(x);
+            const float xs = x - float(x0);
+            const float w[2] = {1.f - xs, xs};
+            A.Set(o, x0, w, 2);
         }
-        yf += ystep;
     }
+    return A;
 }
 
-template <class Image_T> void Resize(Image_T& Out, const Image_T& Img, const int w1, const int h1)
+// Half-width of each filter's support in units of the wider of the input and output pixel spacings
+float FilterSupport(const ResizeFilter_e Filter)
 {
-    ASSERT_R(w1 > 0 && h1 > 0)
+    switch (Filter) {
+    case RESIZE_BOX: return 0.5f;
+    case RESIZE_TRIANGLE: return 1.f;
+    case RESIZE_MITCHELL: return 2.f;
+    case RESIZE_LANCZOS3: return 3.f;
+    }
+    return 0.f;
+}
 
-    Image_T* OpImg = (Image_T*)&Img;
-    while (OpImg->w() / 2 >= w1 && OpImg->h() / 2 >= h1) {
-        Image_T* Smaller = new Image_T;
-        Downsample2x2(*Smaller, *OpImg); // Downsample by two and replace OpImg.
-        if (OpImg != &Img) delete OpImg;
-        OpImg = Smaller;
+float FilterWeight(const ResizeFilter_e Filter, float x)
+{
+    x = fabsf(x);
+    switch (Filter) {
+    case RESIZE_BOX: return x <= 0.5f ? 1.f : 0.f;
+    case RESIZE_TRIANGLE: return x < 1.f ? 1.f - x : 0.f;
+    case RESIZE_MITCHELL: return x < 1.f ? CubicFilterN(x) : x < 2.f ? CubicFilterF(x) : 0.f; // B = C = 1/3
+    case RESIZE_LANCZOS3:
+        if (x < 1e-5f) return 1.f;
+        if (x >= 3.f) return 0.f;
+        {
+            const float px = float(M_PI) * x;
+            return 3.f * sinf(px) * sinf(px * (1.f / 3.f)) / (px * px);
+        }
     }
+    return 0.f;
+}
 
-    while (OpImg->w() / 2 >= w1) {
-        Image_T* Smaller = new Image_T;
-        Downsample2x1(*Smaller, *OpImg); // Downsample by two and replace OpImg.
-        if (OpImg != &Img) delete OpImg;
-        OpImg = Smaller;
+// The taps of Filter for resampling nIn pixels to nOut with their centers aligned, stretched to the input pixel spacing
+// when downsampling so that every input pixel contributes. Box downsampling weights each input pixel by how much of it
+// lies in the output pixel's footprint, so a 2:1 box is exactly Downsample2x2; box upsampling is nearest neighbor.
+ResampleAxis FilterAxis(const int nIn, const int nOut, const ResizeFilter_e Filter)
+{
+    const double scale = nIn / double(nOut);
+    const double fscale = std::max(scale, 1.0);
+    const double support = FilterSupport(Filter) * fscale;
+    ResampleAxis A(nIn, nOut, int(ceil(2 * support)) + 3);
+    std::vector<float> w(A.Taps);
+
+    for (int o = 0; o < nOut; o++) {
+        const double center = (o + 0.5) * scale; // In input pixel units, where input pixel i covers [i, i + 1)
+        if (Filter == RESIZE_BOX && scale > 1) {
+            const double lo = center - 0.5 * scale, hi = center + 0.5 * scale;
+            const int first = int(floor(lo)), last = std::min(int(ceil(hi)), first + A.Taps);
+            for (int i = first; i < last; i++) w[i - first] = float(std::max(0.0, std::min(hi, i + 1.0) - std::max(lo, double(i))));
+            A.Set(o, first, w.data(), last - first);
+        } else if (Filter == RESIZE_BOX) {
+            const float one = 1.f;
+            A.Set(o, std::min(int(center), nIn - 1), &one, 1);
+        } else {
+            const int first = int(floor(center - support - 0.5)), last = std::min(int(ceil(center + support - 0.5)) + 1, first + A.Taps);
+            for (int i = first; i < last; i++) w[i - first] = FilterWeight(Filter, float((i + 0.5 - center) / fscale));
+            A.Set(o, first, w.data(), last - first);
+        }
     }
+    return A;
+}
 
-    while (OpImg->h() / 2 >= h1) {
-        Image_T* Smaller = new Image_T;
-        Downsample1x2(*Smaller, *OpImg); // Downsample by two and replace OpImg.
-        if (OpImg != &Img) delete OpImg;
-        OpImg = Smaller;
+// Resample Img into Out with the taps AX for the columns and AY for the rows. Each output row band horizontally
+// resamples the input rows it needs into a ring of float planes, one plane per channel, then sums those rows
+// vertically, so the input is converted to float once per band, and each pass runs on a flat array of floats.
+// If isSRGB, the color channels are filtered in linear light. If roundInts, integer outputs round to nearest rather
+// than truncating as the pixel converting constructor does.
+template <class Image_T, class InImage_T>
+void ResampleSeparable(Image_T& Out, const InImage_T& Img, const ResampleAxis& AX, const ResampleAxis& AY, const bool isSRGB, const bool roundInts)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef tPixel<float, Pixel_T::Chan> FPixel_T;
+    typedef typename Pixel_T::ElType Elem_T;
+    const int NC = Pixel_T::Chan;
+    const int w0 = Img.w(), w1 = AX.NOut, h1 = AY.NOut;
+    float Bias[NC]; // Rounds when added before the truncating conversion. The sRGB encoding already rounds the color channels.
+    for (int c = 0; c < NC; c++)
+        Bias[c] = (roundInts && element_traits<Elem_T>::normalized && (!isSRGB || c == AlphaChan<Pixel_T>())) ? 0.5f / float(element_traits<Elem_T>::one()) : 0.f;
+
+    Out.SetSize(w1, h1);
+    Out.row(0); // Unshare the raster before the threads write rows of it
+
+    // Enough output rows per band that redoing the input rows shared with the band above is a small part of the work
+    const int grain = std::max(4 * AY.MaxCount * h1 / std::max(Img.h(), 1) + 1, ConvertParallelPixels / std::max(w0, 1));
+    ParallelForRanges(h1, grain, [&](const int y0, const int y1) {
+        const int Ring = AY.MaxCount;
+        std::vector<FPixel_T> PixRow(std::max(w0, w1));
+        std::vector<float> InPlane(w0 + AX.Taps, 0.f); // Padded so every output's taps are in bounds
+        std::vector<float> RingBuf(size_t(Ring) * NC * w1), OutPlanes(size_t(NC) * w1);
+        std::vector<const float*> Rows(Ring);
+        auto ringRow = [&](const int y, const int c) { return &RingBuf[(size_t(y % Ring) * NC + c) * w1]; };
+
+        int next = AY.Start[y0]; // The next input row to resample horizontally
+        for (int y = y0; y < y1; y++) {
+            const int s = AY.Start[y], cnt = AY.Count[y];
+            for (next = std::max(next, s); next < s + cnt; next++) {
+                ConvertPixels(PixRow.data(), Img.row(next), w0, isSRGB ? XFER_SRGB_TO_LINEAR : XFER_NONE);
+                for (int c = 0; c < NC; c++) {
+                    for (int x = 0; x < w0; x++) InPlane[x] = PixRow[x][c];
+                    float* d = ringRow(next, c);
+                    if (!SIMDResampleRow(d, InPlane.data(), w1, AX.Start.data(), AX.W.data(), AX.Taps)) {
+                        for (int o = 0; o < w1; o++) {
+                            const float *p = &InPlane[AX.Start[o]], *w = &AX.W[size_t(o) * AX.Taps];
+                            float sum = 0;
+                            for (int k = 0; k < AX.Count[o]; k++) sum += w[k] * p[k];
+                            d[o] = sum;
+                        }
+                    }
+                }
+            }
+
+            const float* K = &AY.W[size_t(y) * AY.Taps];
+            for (int c = 0; c < NC; c++) {
+                for (int k = 0; k < cnt; k++) Rows[k] = ringRow(s + k, c);
+                float* d = &OutPlanes[size_t(c) * w1];
+                if (!SIMDConvolveCol(d, Rows.data(), w1, K, cnt)) {
+                    for (int x = 0; x < w1; x++) {
+                        float sum = 0;
+                        for (int k = 0; k < cnt; k++) sum += K[k] * Rows[k][x];
+                        d[x] = sum;
+                    }
+                }
+            }
+
+            for (int x = 0; x < w1; x++)
+                for (int c = 0; c < NC; c++) PixRow[x][c] = OutPlanes[size_t(c) * w1 + x] + Bias[c];
+            ConvertPixels(Out.row(y), PixRow.data(), w1, isSRGB ? XFER_LINEAR_TO_SRGB : XFER_NONE);
+        }
+    });
+}
+
+// Box filter Img down by two until it is less than twice the target size in both dimensions, then resample it into Out.
+// Img is the caller's image or view the first time and a downsampled tImage after that.
+template <class Image_T, class InImage_T> void ResizeFrom(Image_T& Out, const InImage_T& Img, const int w1, const int h1)
+{
+    if (Img.w() / 2 >= w1 || Img.h() / 2 >= h1) {
+        tImage<typename Image_T::PixType> Smaller;
+        if (Img.w() / 2 >= w1 && Img.h() / 2 >= h1)
+            Downsample2x2Into(Smaller, Img);
+        else if (Img.w() / 2 >= w1)
+            Downsample2x1(Smaller, Img);
+        else
+            Downsample1x2(Smaller, Img);
+
+        ResizeFrom(Out, Smaller, w1, h1);
+        return;
     }
 
-    // Image is less than twice the target size in both dimensions.
+    if (Img.w() == w1 && Img.h() == h1) { // Short-circuit copy without resampling
+        Out.SetSize(w1, h1);
+        for (int y = 0; y < h1; y++)
+            for (int x = 0; x < w1; x++) Out(x, y) = Img(x, y);
+        return;
+    }
 
     // Use bicubic for upsampling but bilinear for downsampling.
-    if (Out.w() > Img.w() || Out.h() > Img.h()) {
-        ResizeWithSampler(sampler4<Image_T>(), Out, *OpImg, w1, h1);
-    } else {
-        ResizeWithSampler(sampler2<Image_T>(), Out, *OpImg, w1, h1);
-    }
+    const bool cubic = w1 > Img.w() || h1 > Img.h();
+    ResampleSeparable(Out, Img, CornerAxis(Img.w(), w1, cubic), CornerAxis(Img.h(), h1, cubic), false, false);
+}
+}; // namespace
+
+template <class Image_T> void Downsample2x2(Image_T& Out, const Image_T& Img) { Downsample2x2Into(Out, Img); }
 
-    if (OpImg != &Img) delete OpImg;
+template void Downsample2x2(f1Image& Out, const f1Image& Img);
+template void Downsample2x2(f3Image& Out, const f3Image& Img);
+template void Downsample2x2(f4Image& Out, const f4Image& Img);
+template void Downsample2x2(h1Image& Out, const h1Image& Img);
+template void Downsample2x2(h3Image& Out, const h3Image& Img);
+template void Downsample2x2(h4Image& Out, const h4Image& Img);
+template void Downsample2x2(uc1Image& Out, const uc1Image& Img);
+template void Downsample2x2(uc3Image& Out, const uc3Image& Img);
+template void Downsample2x2(uc4Image& Out, const uc4Image& Img);
+template void Downsample2x2(us1Image& Out, const us1Image& Img);
+template void Downsample2x2(us3Image& Out, const us3Image& Img);
+template void Downsample2x2(us4Image& Out, const us4Image& Img);
+template void Downsample2x2(f1ImageView& Out, const f1ImageView& Img);
+template void Downsample2x2(f3ImageView& Out, const f3ImageView& Img);
+template void Downsample2x2(f4ImageView& Out, const f4ImageView& Img);
+template void Downsample2x2(uc1ImageView& Out, const uc1ImageView& Img);
+template void Downsample2x2(uc3ImageView& Out, const uc3ImageView& Img);
+template void Downsample2x2(uc4ImageView& Out, const uc4ImageView& Img);
+
+template <class Image_T> void Resize(Image_T& Out, const Image_T& Img, const int w1, const int h1)
+{
+    ASSERT_R(w1 > 0 && h1 > 0)
+
+    ResizeFrom(Out, Img, w1, h1);
 }
 
 template void Resize(f1Image& Out, const f1Image& Img, const int w1, const int h1);
@@ -280,6 +466,45 @@ template void Resize(f4Image& Out, const f4Image& Img, const int w1, const int h
 template void Resize(uc1Image& Out, const uc1Image& Img, const int w1, const int h1); // Tested Apr. 2016
 template void Resize(uc3Image& Out, const uc3Image& Img, const int w1, const int h1);
 template void Resize(uc4Image& Out, const uc4Image& Img, const int w1, const int h1); // Tested Dec. 2014
+template void Resize(f1ImageView& Out, const f1ImageView& Img, const int w1, const int h1);
+template void Resize(f3ImageView& Out, const f3ImageView& Img, const int w1, const int h1);
+template void Resize(f4ImageView& Out, const f4ImageView& Img, const int w1, const int h1);
+template void Resize(uc1ImageView& Out, const uc1ImageView& Img, const int w1, const int h1);
+template void Resize(uc3ImageView& Out, const uc3ImageView& Img, const int w1, const int h1);
+template void Resize(uc4ImageView& Out, const uc4ImageView& Img, const int w1, const int h1);
+
+template <class Image_T> void Resize(Image_T& Out, const Image_T& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB)
+{
+    ASSERT_R(w1 > 0 && h1 > 0 && Img.w() > 0 && Img.h() > 0);
+
+    if (Img.w() == w1 && Img.h() == h1) {
+        Out.SetSize(w1, h1);
+        for (int y = 0; y < h1; y++)
+            for (int x = 0; x < w1; x++) Out(x, y) = Img(x, y);
+        return;
+    }
+
+    ResampleSeparable(Out, Img, FilterAxis(Img.w(), w1, Filter), FilterAxis(Img.h(), h1, Filter), isSRGB, true);
+}
+
+template void Resize(f1Image& Out, const f1Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(f3Image& Out, const f3Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(f4Image& Out, const f4Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(h1Image& Out, const h1Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(h3Image& Out, const h3Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(h4Image& Out, const h4Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc1Image& Out, const uc1Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc3Image& Out, const uc3Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc4Image& Out, const uc4Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(us1Image& Out, const us1Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(us3Image& Out, const us3Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(us4Image& Out, const us4Image& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(f1ImageView& Out, const f1ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(f3ImageView& Out, const f3ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(f4ImageView& Out, const f4ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc1ImageView& Out, const uc1ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc3ImageView& Out, const uc3ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
+template void Resize(uc4ImageView& Out, const uc4ImageView& Img, const int w1, const int h1, const ResizeFilter_e Filter, const bool isSRGB);
 
 template <class Image_T> bool sample1(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
 {
@@ -289,6 +514,8 @@ template <class Image_T> bool sample1(typename Image_T::PixType& res, const Imag
 }
 template bool sample1(f3Pixel& res, const f3Image& Img, const float x, const float y);
 template bool sample1(uc3Pixel& res, const uc3Image& Img, const float x, const float y);
+template bool sample1(f3Pixel& res, const f3TiledImage& Img, const float x, const float y);
+template bool sample1(uc3Pixel& res, const uc3TiledImage& Img, const float x, const float y);
 
 template <class Image_T> bool sample2(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
 {
@@ -298,6 +525,8 @@ template <class Image_T> bool sample2(typename Image_T::PixType& res, const Imag
 }
 template bool sample2(f3Pixel& res, const f3Image& Img, const float x, const float y);
 template bool sample2(uc3Pixel& res, const uc3Image& Img, const float x, const float y);
+template bool sample2(f3Pixel& res, const f3TiledImage& Img, const float x, const float y);
+template bool sample2(uc3Pixel& res, const uc3TiledImage& Img, const float x, const float y);
 
 template <class Image_T> bool sample4(typename Image_T::PixType& res, const Image_T& Img, const float x, const float y)
 {
@@ -307,3 +536,5 @@ template <class Image_T> bool sample4(typename Image_T::PixType& res, const Imag
 }
 template bool sample4(f3Pixel& res, const f3Image& Img, const float x, const float y);
 template bool sample4(uc3Pixel& res, const uc3Image& Img, const float x, const float y);
+template bool sample4(f3Pixel& res, const f3TiledImage& Img, const float x, const float y);
+template bool sample4(uc3Pixel& res, const uc3TiledImage& Img, const float x, const float y);
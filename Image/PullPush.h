@@ -18,6 +18,7 @@
 #include "Util/ToolConfig.h"
 
 #include <iostream>
+#include <vector>
 
 template <class Weight_T> DMC_DECL Weight_T clampTo1(Weight_T x) { return x < 1.0f ? x : 1.0f; }
 
@@ -30,9 +31,8 @@ template <class Data_T, class Weight_T> DMC_DECL void Composite(Data_T& R, Weigh
 
 // Create an image smaller than the one I'm given, fill in as much of it as I know how.
 // Then call recursively to have the rest of it filled in. Then use it to fill in the rest of me.
-//
-// All values of Weights must be <= 1.
-template <class Data_T, class Weight_T> void PullPush(Data_T* Data, Weight_T* Weights, int wid, int hgt)
+// The smaller levels are carved out of Data1 and Weights1, which have room for all of them.
+template <class Data_T, class Weight_T> void PullPushLevel(Data_T* Data, Weight_T* Weights, int wid, int hgt, Data_T* Data1, Weight_T* Weights1)
 {
 #ifdef PP_DEBUG
     DoDebug("Inn", Data, Weights, wid, hgt);
@@ -45,10 +45,6 @@ template <class Data_T, class Weight_T> void PullPush(Data_T* Data, Weight_T* We
 
     std::cerr << "Shrinking to " << widp << "x" << hgtp << std::endl;
 
-    // XXX What about initializing these?
-    Data_T* Data1 = new Data_T[widp * hgtp];
-    Weight_T* Weights1 = new Weight_T[widp * hgtp];
-
     // Make the smaller level.
     int x, y;
     for (y = 0; y < hgtp; y++) {
@@ -131,7 +127,7 @@ template <class Data_T, class Weight_T> void PullPush(Data_T* Data, Weight_T* We
     }
 
     // Now that I've splatted onto the smaller level, have the rest of it filled in.
-    PullPush(Data1, Weights1, widp, hgtp);
+    PullPushLevel(Data1, Weights1, widp, hgtp, Data1 + widp * hgtp, Weights1 + widp * hgtp);
 
     // Now use the smaller image to fill me in.
     for (y = 0; y < hgt; y++) {
@@ -225,12 +221,25 @@ template <class Data_T, class Weight_T> void PullPush(Data_T* Data, Weight_T* We
         }
     }
 
-    delete[] Data1;
-    delete[] Weights1;
-
 #ifdef PP_DEBUG
     DoDebug("Out", Data, Weights, wid, hgt);
 #endif
 
     std::cerr << "Finished filling in the " << wid << "x" << hgt << std::endl;
 }
+
+// Fill in Data where Weights are less than 1 by interpolating from the rest. All values of Weights must be <= 1.
+// The levels of the pyramid are all allocated at once, like a tMipChain's, rather than one at a time.
+template <class Data_T, class Weight_T> void PullPush(Data_T* Data, Weight_T* Weights, int wid, int hgt)
+{
+    size_t total = 0;
+    for (int w = wid, h = hgt; w > 1 || h > 1;) {
+        w = (w + 1) >> 1;
+        h = (h + 1) >> 1;
+        total += size_t(w) * h;
+    }
+
+    std::vector<Data_T> Data1(total);
+    std::vector<Weight_T> Weights1(total);
+    PullPushLevel(Data, Weights, wid, hgt, Data1.data(), Weights1.data());
+}
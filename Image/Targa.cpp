@@ -45,12 +45,12 @@ typedef struct TGA_Header_ {
 
 // Color mapped image with one-byte indices at each pixel.
 // Unpacks it into a standard raster image with chan channels.
-static int decode_map8(const unsigned char* src0, unsigned char* dest0, const int size, const int chan, const unsigned char* color_map)
+static int decode_map8(const unsigned char* src0, unsigned char* dest0, const int64_t size, const int chan, const unsigned char* color_map)
 {
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    for (int i = 0; i < size; i++) {
+    for (int64_t i = 0; i < size; i++) {
         for (int c = 0; c < chan; c++) dest[chan - c - 1] = color_map[src[0] * chan + c];
         src++;
         dest += chan;
@@ -66,7 +66,7 @@ static int decode_rgb16(const unsigned char* src0, unsigned char* dest0, const i
     unsigned char* dest = dest0;
 
     if (R5G6B5) {
-        for (int i = 0; i < wid * hgt; i++) {
+        for (int64_t i = 0; i < int64_t(wid) * hgt; i++) {
             dest[0] = (src[1] << 0) & 0xf8;
             dest[1] = ((src[1] << 5) | (src[0] >> 3)) & 0xfc;
             dest[2] = (src[0] << 3) & 0xf8;
@@ -74,7 +74,7 @@ static int decode_rgb16(const unsigned char* src0, unsigned char* dest0, const i
             dest += 3;
         }
     } else { // X1R5G5B5
-        for (int i = 0; i < wid * hgt; i++) {
+        for (int64_t i = 0; i < int64_t(wid) * hgt; i++) {
             dest[0] = (src[1] << 1) & 0xf8;
             dest[1] = ((src[1] << 6) | (src[0] >> 2)) & 0xf8;
             dest[2] = (src[0] << 3) & 0xf8;
@@ -91,7 +91,7 @@ static int decode_rgb24(const unsigned char* src0, unsigned char* dest0, const i
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    for (int i = 0; i < wid * hgt; i++) {
+    for (int64_t i = 0; i < int64_t(wid) * hgt; i++) {
         dest[0] = src[2]; // Red
         dest[1] = src[1]; // Green
         dest[2] = src[0]; // Blue
@@ -107,7 +107,7 @@ static int decode_rgb32(const unsigned char* src0, unsigned char* dest0, const i
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    for (int i = 0; i < wid * hgt; i++) {
+    for (int64_t i = 0; i < int64_t(wid) * hgt; i++) {
         dest[0] = src[2]; // Red
         dest[1] = src[1]; // Green
         dest[2] = src[0]; // Blue
@@ -127,7 +127,7 @@ static int decode_rgb_rle16(const unsigned char* src0, unsigned char* dest0, con
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    while (dest < dest0 + wid * hgt * chan) {
+    while (dest < dest0 + int64_t(wid) * hgt * chan) {
         // Pixels encoded in "packets"
         // First byte is raw/rle flag(upper bit) and count(1-128 as 0-127 in lower 7 bits)
         // If raw, the next count chan-byte color values in the file are taken verbatim
@@ -137,8 +137,8 @@ static int decode_rgb_rle16(const unsigned char* src0, unsigned char* dest0, con
         int count = (*src & 0x7f) + 1; // How many raw pixels or color repeats
         src++;                         // Advance src beyond first byte to next color
 
-        if (dest + count * chan > dest0 + wid * hgt * chan) // Prevent from writing out of dest range
-            count = (dest0 + wid * hgt * chan - dest) / chan;
+        if (dest + count * chan > dest0 + int64_t(wid) * hgt * chan) // Prevent from writing out of dest range
+            count = (dest0 + int64_t(wid) * hgt * chan - dest) / chan;
 
         if (R5G6B5) {
             for (int j = 0; j < count; j++) {
@@ -166,7 +166,7 @@ static int decode_rgb_rle16(const unsigned char* src0, unsigned char* dest0, con
             src += 2;
     }
 
-    ASSERT_R(dest <= dest0 + wid * hgt * chan);
+    ASSERT_R(dest <= dest0 + int64_t(wid) * hgt * chan);
 
     return (0);
 }
@@ -179,7 +179,7 @@ static int decode_rgb_rle8(const unsigned char* src0, unsigned char* dest0, cons
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    while (dest < dest0 + wid * hgt * chan) {
+    while (dest < dest0 + int64_t(wid) * hgt * chan) {
         // Pixels encoded in "packets"
         // First byte is raw/rle flag(upper bit) and count(1-128 as 0-127 in lower 7 bits)
         // If raw, the next count chan-byte color values in the file are taken verbatim
@@ -189,8 +189,8 @@ static int decode_rgb_rle8(const unsigned char* src0, unsigned char* dest0, cons
         int count = (*src & 0x7f) + 1; // How many raw pixels or color repeats
         src++;                         // Advance src beyond first byte to 8-bit color
 
-        if (dest + count * chan > dest0 + wid * hgt * chan) // Prevent from writing out of dest range
-            count = (dest0 + wid * hgt * chan - dest) / chan;
+        if (dest + count * chan > dest0 + int64_t(wid) * hgt * chan) // Prevent from writing out of dest range
+            count = (dest0 + int64_t(wid) * hgt * chan - dest) / chan;
 
         for (int j = 0; j < count; j++) {
             dest[0] = src[0]; // Red
@@ -203,7 +203,7 @@ static int decode_rgb_rle8(const unsigned char* src0, unsigned char* dest0, cons
             src += chan;
     }
 
-    ASSERT_R(dest <= dest0 + wid * hgt * chan);
+    ASSERT_R(dest <= dest0 + int64_t(wid) * hgt * chan);
 
     return (0);
 }
@@ -216,7 +216,7 @@ static int decode_rgb_rle24(const unsigned char* src0, unsigned char* dest0, con
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    while (dest < dest0 + wid * hgt * chan) {
+    while (dest < dest0 + int64_t(wid) * hgt * chan) {
         // Pixels encoded in "packets"
         // First byte is raw/rle flag(upper bit) and count(1-128 as 0-127 in lower 7 bits)
         // If raw, the next count chan-byte color values in the file are taken verbatim
@@ -226,8 +226,8 @@ static int decode_rgb_rle24(const unsigned char* src0, unsigned char* dest0, con
         int count = (*src & 0x7f) + 1; // How many raw pixels or color repeats
         src++;                         // Advance src beyond first byte to 24-bit color
 
-        if (dest + count * chan > dest0 + wid * hgt * chan) // Prevent from writing out of dest range
-            count = (dest0 + wid * hgt * chan - dest) / chan;
+        if (dest + count * chan > dest0 + int64_t(wid) * hgt * chan) // Prevent from writing out of dest range
+            count = (dest0 + int64_t(wid) * hgt * chan - dest) / chan;
 
         for (int j = 0; j < count; j++) {
             dest[0] = src[2]; // Red
@@ -242,7 +242,7 @@ static int decode_rgb_rle24(const unsigned char* src0, unsigned char* dest0, con
             src += chan;
     }
 
-    ASSERT_R(dest <= dest0 + wid * hgt * chan);
+    ASSERT_R(dest <= dest0 + int64_t(wid) * hgt * chan);
 
     return (0);
 }
@@ -256,7 +256,7 @@ static int decode_rgb_rle32(const unsigned char* src0, unsigned char* dest0, con
     const unsigned char* src = src0;
     unsigned char* dest = dest0;
 
-    while (dest < dest0 + wid * hgt * chan) {
+    while (dest < dest0 + int64_t(wid) * hgt * chan) {
         // Pixels encoded in "packets"
         // First byte is raw/rle flag(upper bit) and count(1-128 as 0-127 in lower 7 bits)
         // If raw, the next count chan-byte color values in the file are taken verbatim
@@ -266,8 +266,8 @@ static int decode_rgb_rle32(const unsigned char* src0, unsigned char* dest0, con
         int count = (*src & 0x7f) + 1; // How many raw pixels or color repeats
         src++;                         // Advance src beyond first byte to 32-bit color
 
-        if (dest + count * chan > dest0 + wid * hgt * chan) // Prevent from writing out of dest range
-            count = (dest0 + wid * hgt * chan - dest) / chan;
+        if (dest + count * chan > dest0 + int64_t(wid) * hgt * chan) // Prevent from writing out of dest range
+            count = (dest0 + int64_t(wid) * hgt * chan - dest) / chan;
 
         for (int j = 0; j < count; j++) {
             dest[0] = src[2]; // Red
@@ -390,9 +390,9 @@ void ImageLoadSave::LoadTGA(const std::string& fname)
         ASSERT_RM(tbuf, "memory alloc failed");
 
         for (int y = 0; y < hgt / 2; y++) {
-            memcpy(tbuf, &Pix[y * lsize], lsize);
-            memcpy(&Pix[y * lsize], &Pix[(hgt - y - 1) * lsize], lsize);
-            memcpy(&Pix[(hgt - y - 1) * lsize], tbuf, lsize);
+            memcpy(tbuf, &Pix[size_t(y) * lsize], lsize);
+            memcpy(&Pix[size_t(y) * lsize], &Pix[size_t(hgt - y - 1) * lsize], lsize);
+            memcpy(&Pix[size_t(hgt - y - 1) * lsize], tbuf, lsize);
         }
         delete[] tbuf;
     }
@@ -447,10 +447,10 @@ DMC_DECL bool match(const unsigned char* src, int& count, const int chan)
     }
 }
 
-static int encode_rle(const unsigned char* src0, unsigned char* dest, const int size, const int chan)
+static int64_t encode_rle(const unsigned char* src0, unsigned char* dest, const int64_t size, const int chan)
 {
     const unsigned char* src = src0;
-    int dp = 0;
+    int64_t dp = 0;
 
     do {
         int count;
@@ -544,7 +544,7 @@ void ImageLoadSave::SaveTGA(const std::string& fname) const
     ASSERT_RM(out_data, "memory alloc failed");
 
     // Compress the data
-    int rle_size = encode_rle(Pix, out_data, size(), chan);
+    int64_t rle_size = encode_rle(Pix, out_data, size(), chan);
 
     // Write the data
     fwrite(out_data, rle_size, 1, ft);
@@ -6,6 +6,11 @@
 #include "Image/ImageAlgorithms.h"
 #include "Math/Random.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace {
@@ -16,179 +21,473 @@ template <class Gauss_T> struct GaussSqFunc_t {
     Gauss_T operator()(const Gauss_T c) const { return static_cast<Gauss_T>(GaussianSq(static_cast<double>(c), StDevSq)); }
 };
 
-// Sample the image with the kernel. Divide by sum of covered weights.
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T>
-DMC_DECL typename Image_T::PixType sample_kernel_vcd_weighted(const Image_T& Img, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq, const int xc,
-                                                              const int yc)
+// GaussSqFunc_t as a table over the squared color distance, linearly interpolated, so the taps don't call exp().
+// It's scaled to 1 at distance 0, which cancels when dividing by the sum of the weights. It reaches out to where the
+// weight is exp(-20) of its peak and is zero beyond, since GaussianSq()'s variance there is StDevSq squared.
+struct VCDRangeTable {
+    static const int Size = 4096;
+    float Table[Size + 1];
+    float scale, maxIndex;
+
+    VCDRangeTable(const float ColorStDev)
+    {
+        const GaussSqFunc_t<float> GSF(ColorStDev);
+        const float maxDistSq = 40.f * GSF.StDevSq * GSF.StDevSq;
+        scale = (Size - 1) / maxDistSq;
+        maxIndex = float(Size - 1);
+        const float peak = GSF(0.f);
+        for (int i = 0; i < Size - 1; i++) Table[i] = GSF(i / scale) / peak;
+        Table[Size - 1] = Table[Size] = 0.f;
+    }
+};
+
+// Filter row y of Src into row y of Dst. Each row is C planes of wid floats. Taps that fall off the image are skipped,
+// and every pixel is divided by the sum of the weights of its taps. Acc and Wsum are scratch for C and 1 planes.
+void VCDRow(float* Dst, const float* Src, const int y, const int wid, const int hgt, const int C, const std::vector<float>& K, const int N,
+            const VCDRangeTable& R, float* Acc, float* Wsum)
 {
-    const int N = Kernel.w();
     const int N2 = N / 2;
+    const size_t rowEls = size_t(wid) * C;
+    std::fill(Acc, Acc + rowEls, 0.f);
+    std::fill(Wsum, Wsum + wid, 0.f);
+
+    const float* Pr = Src + y * rowEls;
+    for (int ky = std::max(0, N2 - y); ky < std::min(N, hgt + N2 - y); ky++) {
+        const float* Sr = Src + (y + ky - N2) * rowEls;
+        for (int kx = 0; kx < N; kx++) {
+            const int xs = kx - N2, x0 = std::max(0, -xs), x1 = std::min(wid, wid - xs);
+            if (x1 <= x0) continue;
+
+            float* A[4];
+            const float *S[4], *P[4];
+            for (int c = 0; c < C; c++) {
+                A[c] = Acc + c * wid + x0;
+                S[c] = Sr + c * wid + x0 + xs;
+                P[c] = Pr + c * wid + x0;
+            }
+            const float k = K[ky * N + kx];
+            if (SIMDVCDTap(A, Wsum + x0, S, P, C, x1 - x0, k, R.Table, R.maxIndex, R.scale)) continue;
 
-    typename Image_T::PixType::MathPixType sum(0);
-    typename KernelImage_T::PixType::MathType weight = 0;
-    const typename Image_T::PixType Pc = Img(xc, yc);
-
-    int xl = std::max(xc - N2, 0), xh = std::min(xc + N2, Img.w() - 1);
-    int yl = std::max(yc - N2, 0), yh = std::min(yc + N2, Img.h() - 1);
-    for (int y = yl; y <= yh; y++) {
-        for (int x = xl; x <= xh; x++) {
-            const typename KernelImage_T::PixType::ElType K = Kernel(xc - x + N2, yc - y + N2);
-            const typename Image_T::PixType P = Img(x, y);
-            const typename Image_T::PixType::MathType ColorDistSqr = DiffSqr(Pc, P); // Compute sum of squared difference of channels in color space
-            const typename KernelImage_T::PixType::ElType G = GSq(ColorDistSqr);     // Compute gaussian(sqrt(ColorDistSqr))
-            const typename KernelImage_T::PixType::ElType W = K * G;
-            sum += P * W;
-            weight += W;
+            for (int i = 0; i < x1 - x0; i++) {
+                float d2 = 0;
+                for (int c = 0; c < C; c++) {
+                    const float d = S[c][i] - P[c][i];
+                    d2 += d * d;
+                }
+                const float sd2 = d2 * R.scale;
+                const float f = sd2 < R.maxIndex ? sd2 : R.maxIndex; // Like minf(), NaN gives maxIndex
+                const int fi = int(f);
+                const float t = f - float(fi);
+                const float w = k * (R.Table[fi] + t * (R.Table[fi + 1] - R.Table[fi]));
+                for (int c = 0; c < C; c++) A[c][i] += w * S[c][i];
+                Wsum[x0 + i] += w;
+            }
         }
     }
 
-    ASSERT_D(weight != 0);
-
-    return sum / weight;
+    float* D = Dst + y * rowEls;
+    for (int c = 0; c < C; c++)
+        for (int x = 0; x < wid; x++) D[c * wid + x] = Acc[c * wid + x] / Wsum[x];
 }
+}; // namespace
 
-// Sample the image with the kernel. Kernel is fully inside image.
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T>
-DMC_DECL typename Image_T::PixType sample_kernel_vcd_full(const Image_T& Img, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq, const int xc, const int yc)
+// FiltWid x FiltWid variable conductance diffusion blur for any image type. Each pixel's contribution is
+// modulated by the gaussian and the color space distance from the target pixel.
+// FiltWid must be odd. Repeat iterations times.
+// The image is held as float planes in two buffers that the iterations ping-pong between, and each iteration's rows
+// are split across threads. Integer pixels are filtered in their own units and rounded at the end.
+template <class Image_T>
+void VCD(Image_T& Out, const Image_T& In, const int FiltWid, const typename Image_T::PixType::FloatMathType ImageStDev,
+         const typename Image_T::PixType::FloatMathType ColorStDev, const int iterations)
 {
-    const int N = Kernel.w();
-    const int N2 = N / 2;
+    ASSERT_R((FiltWid & 1) && FiltWid >= 3); // Filter must be an odd width so it can center on a pixel.
+    ASSERT_R(ImageStDev > 0 && ColorStDev > 0);
 
-    typename Image_T::PixType::MathPixType sum(0);
-    typename KernelImage_T::PixType::MathType weight = 0;
-    const typename Image_T::PixType Pc = Img(xc, yc);
-    const typename KernelImage_T::PixType::ElType* Kp = (const typename KernelImage_T::PixType::ElType*)Kernel.pv();
-
-    for (int yk = 0; yk < N; yk++) {
-        int y = yc - N2 + yk;
-        for (int xk = 0; xk < N; xk++) {
-            int x = xc - N2 + xk;
-            const typename KernelImage_T::PixType::ElType K = *Kp++;
-            const typename Image_T::PixType P = Img(x, y);
-            const typename Image_T::PixType::MathType ColorDistSqr = DiffSqr(Pc, P); // Compute sum of squared difference of channels in color space
-            const typename KernelImage_T::PixType::ElType G = GSq(ColorDistSqr);     // Compute gaussian(sqrt(ColorDistSqr))
-            const typename KernelImage_T::PixType::ElType W = K * G;
-            sum += P * W;
-            weight += W;
-        }
+    typedef typename Image_T::PixType::ElType ElT;
+    const int C = Image_T::PixType::Chan;
+    const int wid = In.w(), hgt = In.h(), N = FiltWid;
+    const size_t rowEls = size_t(wid) * C;
+    if (wid < 1 || hgt < 1) {
+        Out.SetSize(wid, hgt);
+        return;
     }
 
-    ASSERT_D(weight != 0);
+    const f1Image KImg = MakeGaussianKernel<f1Image>(N, float(ImageStDev));
+    std::vector<float> K(size_t(N) * N);
+    for (int y = 0; y < N; y++)
+        for (int x = 0; x < N; x++) K[y * N + x] = KImg(x, y)[0];
+    const VCDRangeTable R(static_cast<float>(ColorStDev));
+
+    std::vector<float> Buf[2] = {std::vector<float>(rowEls * hgt), std::vector<float>(rowEls * hgt)};
+    const int rowGrain = std::max(1, ConvertParallelPixels / wid);
+    ParallelForRanges(hgt, rowGrain, [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++)
+            for (int x = 0; x < wid; x++)
+                for (int c = 0; c < C; c++) Buf[0][y * rowEls + c * wid + x] = static_cast<float>(In(x, y)[c]);
+    });
 
-    return sum / weight;
+    const int passes = std::max(iterations, 1);
+    for (int i = 0; i < passes; i++) {
+        const float* Src = Buf[i & 1].data();
+        float* Dst = Buf[(i + 1) & 1].data();
+        ParallelForRanges(hgt, std::max(1, rowGrain / (N * N)), [&](const int y0, const int y1) {
+            std::vector<float> Acc(rowEls), Wsum(wid);
+            for (int y = y0; y < y1; y++) VCDRow(Dst, Src, y, wid, hgt, C, K, N, R, Acc.data(), Wsum.data());
+        });
+    }
+
+    const std::vector<float>& Res = Buf[passes & 1];
+    Out.SetSize(wid, hgt);
+    ParallelForRanges(hgt, rowGrain, [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) {
+            for (int x = 0; x < wid; x++) {
+                typename Image_T::PixType& p = Out(x, y);
+                for (int c = 0; c < C; c++) {
+                    const float v = Res[y * rowEls + c * wid + x];
+                    if constexpr (std::is_integral_v<ElT>)
+                        p[c] = static_cast<ElT>(clamp(v, 0.f, float(std::numeric_limits<ElT>::max())) + 0.5f);
+                    else
+                        p[c] = static_cast<ElT>(v);
+                }
+            }
+        }
+    });
 }
 
-// Sample the image with the kernel. Kernel is fully inside image.
-// Kernel width, N, is known at compile time.
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T, int N>
-DMC_DECL typename Image_T::PixType sample_kernel_vcd_fullN(const Image_T& Img, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq, const int xc,
-                                                           const int yc)
+template void VCD<f1Image>(f1Image& Out, const f1Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCD<f3Image>(f3Image& Out, const f3Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCD<f4Image>(f4Image& Out, const f4Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCD<uc3Image>(uc3Image& Out, const uc3Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCD<f1TiledImage>(f1TiledImage& Out, const f1TiledImage& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCD<f3TiledImage>(f3TiledImage& Out, const f3TiledImage& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+
+namespace {
+// Bilateral grid filter of a one-channel image (Chen, Paris, and Durand 2007). Each pixel is splatted into a 3D grid
+// over x, y, and value, sampled once per stdev along each axis. The grid of (value, weight) pairs is blurred by a
+// Gaussian along each axis and each pixel reads its result back out at its x, y, and value, divided by the weight.
+template <class Image_T> void BilateralGrid(Image_T& Out, const Image_T& In, const float sigmaS, const float sigmaR)
 {
-    const int N2 = N / 2;
+    const int wid = In.w(), hgt = In.h();
+    const int Pad = 2; // Room for the blur's taps so the grid edges stay zero
+
+    float vmin = std::numeric_limits<float>::max(), vmax = -vmin;
+    for (int y = 0; y < hgt; y++)
+        for (int x = 0; x < wid; x++) vmin = std::min(vmin, float(In(x, y)[0])), vmax = std::max(vmax, float(In(x, y)[0]));
 
-    typename Image_T::PixType::MathPixType sum(0);
-    typename KernelImage_T::PixType::MathType weight = 0;
-    const typename Image_T::PixType Pc = Img(xc, yc);
-    const typename KernelImage_T::PixType::ElType* Kp = (const typename KernelImage_T::PixType::ElType*)Kernel.pv();
-
-    for (int yk = 0; yk < N; yk++) {
-        int y = yc - N2 + yk;
-        for (int xk = 0; xk < N; xk++) {
-            int x = xc - N2 + xk;
-            const typename KernelImage_T::PixType::ElType K = *Kp++;
-            const typename Image_T::PixType P = Img(x, y);
-            const typename Image_T::PixType::MathType ColorDistSqr = DiffSqr(Pc, P); // Compute sum of squared difference of channels in color space
-            const typename KernelImage_T::PixType::ElType G = GSq(ColorDistSqr);     // Compute gaussian(sqrt(ColorDistSqr))
-            const typename KernelImage_T::PixType::ElType W = K * G;
-            sum += P * W;
-            weight += W;
+    const int gw = int((wid - 1) / sigmaS) + 2 + 2 * Pad, gh = int((hgt - 1) / sigmaS) + 2 + 2 * Pad, gd = int((vmax - vmin) / sigmaR) + 2 + 2 * Pad;
+    const size_t strides[3] = {2, size_t(gw) * 2, size_t(gw) * gh * 2};
+    const int lens[3] = {gw, gh, gd};
+    std::vector<float> G(size_t(gw) * gh * gd * 2, 0.f);
+
+    // Trilinear coordinates of a pixel in the grid
+    auto gridPos = [&](const int x, const int y, const float v, int i[3], float f[3]) {
+        const float p[3] = {x / sigmaS + Pad, y / sigmaS + Pad, (v - vmin) / sigmaR + Pad};
+        for (int a = 0; a < 3; a++) {
+            i[a] = int(p[a]);
+            f[a] = p[a] - i[a];
+        }
+    };
+
+    for (int y = 0; y < hgt; y++) {
+        for (int x = 0; x < wid; x++) {
+            const float v = In(x, y)[0];
+            int i[3];
+            float f[3];
+            gridPos(x, y, v, i, f);
+            float* g = G.data() + i[0] * strides[0] + i[1] * strides[1] + i[2] * strides[2];
+            for (int c = 0; c < 8; c++) {
+                const float w = ((c & 1) ? f[0] : 1 - f[0]) * ((c & 2) ? f[1] : 1 - f[1]) * ((c & 4) ? f[2] : 1 - f[2]);
+                float* gc = g + ((c & 1) ? strides[0] : 0) + ((c & 2) ? strides[1] : 0) + ((c & 4) ? strides[2] : 0);
+                gc[0] += v * w;
+                gc[1] += w;
+            }
         }
     }
 
-    ASSERT_D(weight != 0);
+    // Splatting and slicing are each a tent filter of variance 1/6 cell, so blur by the rest of a unit variance.
+    const float BlurVar = 1.f - 2.f / 6.f;
+    float K[2 * Pad + 1];
+    for (int k = -Pad; k <= Pad; k++) K[k + Pad] = exp(-0.5f * k * k / BlurVar);
+
+    for (int a = 0; a < 3; a++) {
+        // Each line along axis a starts at a grid cell with coordinate a zero.
+        const int n = lens[a];
+        const int numLines = int(G.size() / 2 / n);
+        ParallelForRanges(numLines, std::max(1, ConvertParallelPixels / n), [&](const int l0, const int l1) {
+            std::vector<float> Line(size_t(n) * 2);
+            for (int l = l0; l < l1; l++) {
+                size_t start = 0, rest = l;
+                for (int b = 0; b < 3; b++) {
+                    if (b == a) continue;
+                    start += (rest % lens[b]) * strides[b];
+                    rest /= lens[b];
+                }
+                float* g = G.data() + start;
+                for (int i = 0; i < n; i++) Line[i * 2] = g[i * strides[a]], Line[i * 2 + 1] = g[i * strides[a] + 1];
+                for (int i = 0; i < n; i++) {
+                    float s0 = 0, s1 = 0;
+                    for (int k = std::max(-Pad, -i); k <= std::min(Pad, n - 1 - i); k++) s0 += K[k + Pad] * Line[(i + k) * 2], s1 += K[k + Pad] * Line[(i + k) * 2 + 1];
+                    g[i * strides[a]] = s0;
+                    g[i * strides[a] + 1] = s1;
+                }
+            }
+        });
+    }
 
-    return sum / weight;
+    Out.SetSize(wid, hgt);
+    ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) {
+            for (int x = 0; x < wid; x++) {
+                const float v = In(x, y)[0];
+                int i[3];
+                float f[3];
+                gridPos(x, y, v, i, f);
+                const float* g = G.data() + i[0] * strides[0] + i[1] * strides[1] + i[2] * strides[2];
+                float s0 = 0, s1 = 0;
+                for (int c = 0; c < 8; c++) {
+                    const float w = ((c & 1) ? f[0] : 1 - f[0]) * ((c & 2) ? f[1] : 1 - f[1]) * ((c & 4) ? f[2] : 1 - f[2]);
+                    const float* gc = g + ((c & 1) ? strides[0] : 0) + ((c & 2) ? strides[1] : 0) + ((c & 4) ? strides[2] : 0);
+                    s0 += gc[0] * w;
+                    s1 += gc[1] * w;
+                }
+                Out(x, y)[0] = s1 > 0 ? s0 / s1 : v;
+            }
+        }
+    });
 }
 
-// Convolve the parts of the image where the kernel is fully inside. This should be fast.
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T>
-void ConvolveMiddleVCD(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq)
-{
-    const int N = Kernel.w();
-    const int N2 = N / 2;
-    const int wid = In.w(), hgt = In.h();
-    for (int y = N2; y < hgt - N2; y++) {
-        for (int x = N2; x < wid - N2; x++) { Out(x, y) = sample_kernel_vcd_full(In, Kernel, GSq, x, y); }
+// Gaussian filter of VD values per point over D-dimensional positions on the permutohedral lattice
+// (Adams, Baek, and Davis 2010). Each point splats its values onto the D + 1 vertices of the lattice simplex that
+// contains it, the lattice is blurred with [1 2 1] along each of its D + 1 axes, and each point reads its simplex
+// back. Only occupied lattice vertices are stored, in a hash table, so the cost is linear in D and the point count.
+// Positions should be divided by the Gaussian's stdev along each axis.
+template <int D, int VD> class PermutohedralLattice {
+public:
+    // Splat n points. Pos is D floats per point and Val is VD floats per point.
+    PermutohedralLattice(const float* Pos, const float* Val, const int n) : Offsets(size_t(n) * (D + 1)), Weights(size_t(n) * (D + 1))
+    {
+        int canonical[(D + 1) * (D + 1)];
+        for (int i = 0; i <= D; i++) {
+            for (int j = 0; j <= D - i; j++) canonical[i * (D + 1) + j] = i;
+            for (int j = D - i + 1; j <= D; j++) canonical[i * (D + 1) + j] = i - (D + 1);
+        }
+
+        // Scale so that the [1 2 1] blurs approximate a unit Gaussian
+        float scaleFactor[D];
+        for (int i = 0; i < D; i++) scaleFactor[i] = float((D + 1) * sqrt(2.0 / 3.0) / sqrt((i + 1.0) * (i + 2.0)));
+
+        Table.assign(64, -1);
+        for (int p = 0; p < n; p++) {
+            const float* pos = Pos + size_t(p) * D;
+
+            // Elevate the position onto the hyperplane of the lattice
+            float elevated[D + 1];
+            float sm = 0;
+            for (int i = D; i > 0; i--) {
+                const float cf = pos[i - 1] * scaleFactor[i - 1];
+                elevated[i] = sm - i * cf;
+                sm += cf;
+            }
+            elevated[0] = sm;
+
+            // The closest remainder-zero lattice point
+            int greedy[D + 1], rank[D + 1] = {};
+            int sum = 0;
+            for (int i = 0; i <= D; i++) {
+                const float v = elevated[i] / (D + 1);
+                const int up = int(ceil(v)) * (D + 1), down = int(floor(v)) * (D + 1);
+                greedy[i] = (up - elevated[i] < elevated[i] - down) ? up : down;
+                sum += greedy[i];
+            }
+            sum /= D + 1;
+
+            // Sort the differences from it to find the simplex that contains the point
+            for (int i = 0; i < D; i++)
+                for (int j = i + 1; j <= D; j++) {
+                    if (elevated[i] - greedy[i] < elevated[j] - greedy[j])
+                        rank[i]++;
+                    else
+                        rank[j]++;
+                }
+            if (sum > 0) {
+                for (int i = 0; i <= D; i++) {
+                    if (rank[i] >= D + 1 - sum) {
+                        greedy[i] -= D + 1;
+                        rank[i] += sum - (D + 1);
+                    } else
+                        rank[i] += sum;
+                }
+            } else if (sum < 0) {
+                for (int i = 0; i <= D; i++) {
+                    if (rank[i] < -sum) {
+                        greedy[i] += D + 1;
+                        rank[i] += (D + 1) + sum;
+                    } else
+                        rank[i] += sum;
+                }
+            }
+
+            // Barycentric coordinates of the point in the simplex
+            float barycentric[D + 2] = {};
+            for (int i = 0; i <= D; i++) {
+                const float delta = (elevated[i] - greedy[i]) / (D + 1);
+                barycentric[D - rank[i]] += delta;
+                barycentric[D + 1 - rank[i]] -= delta;
+            }
+            barycentric[0] += 1.f + barycentric[D + 1];
+
+            // Splat onto the simplex's vertices
+            for (int r = 0; r <= D; r++) {
+                short key[D];
+                for (int i = 0; i < D; i++) key[i] = short(greedy[i] + canonical[r * (D + 1) + rank[i]]);
+                const int v = findOrInsert(key);
+                Offsets[size_t(p) * (D + 1) + r] = v;
+                Weights[size_t(p) * (D + 1) + r] = barycentric[r];
+                for (int k = 0; k < VD; k++) Vals[size_t(v) * VD + k] += barycentric[r] * Val[size_t(p) * VD + k];
+            }
+        }
     }
-}
 
-// Kernel width, N, is known at compile time.
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T, int N>
-void ConvolveMiddleVCDN(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq)
-{
-    const int N2 = N / 2;
-    ASSERT_R((Kernel.w() == N));
-    const int wid = In.w(), hgt = In.h();
+    // Blur along each lattice axis with [1 2 1] / 4.
+    void Blur()
+    {
+        const int numVerts = int(Keys.size() / D);
+        std::vector<float> NewVals(Vals.size());
+        for (int j = 0; j <= D; j++) {
+            ParallelForRanges(numVerts, std::max(1, ConvertParallelPixels / 4), [&](const int i0, const int i1) {
+                for (int i = i0; i < i1; i++) {
+                    const short* key = Keys.data() + size_t(i) * D;
+                    short n1[D + 1], n2[D + 1];
+                    for (int k = 0; k < D; k++) n1[k] = key[k] + 1, n2[k] = key[k] - 1;
+                    n1[j] = key[j] - D;
+                    n2[j] = key[j] + D;
+                    const int v1 = find(n1), v2 = find(n2);
+                    for (int k = 0; k < VD; k++)
+                        NewVals[size_t(i) * VD + k] = 0.5f * Vals[size_t(i) * VD + k] + (v1 >= 0 ? 0.25f * Vals[size_t(v1) * VD + k] : 0.f) +
+                                                      (v2 >= 0 ? 0.25f * Vals[size_t(v2) * VD + k] : 0.f);
+                }
+            });
+            Vals.swap(NewVals);
+        }
+    }
+
+    // The blurred values at point p
+    void Slice(float* val, const int p) const
+    {
+        for (int k = 0; k < VD; k++) val[k] = 0;
+        for (int r = 0; r <= D; r++) {
+            const float w = Weights[size_t(p) * (D + 1) + r];
+            const float* v = Vals.data() + size_t(Offsets[size_t(p) * (D + 1) + r]) * VD;
+            for (int k = 0; k < VD; k++) val[k] += w * v[k];
+        }
+    }
+
+private:
+    std::vector<short> Keys;   // D coordinates per lattice vertex; the last is minus their sum
+    std::vector<float> Vals;   // VD values per lattice vertex
+    std::vector<int> Table;    // Open-addressed hash of vertex indices, a power of two in size, -1 if empty
+    std::vector<int> Offsets;  // The D + 1 vertices of each point's simplex
+    std::vector<float> Weights; // The point's barycentric weight for each of them
 
-    // Do center.
-    for (int y = N2; y < hgt - N2; y++) {
-        for (int x = N2; x < wid - N2; x++) { Out(x, y) = sample_kernel_vcd_fullN<Image_T, KernelImage_T, GaussSqFunctor_T, N>(In, Kernel, GSq, x, y); }
+    static size_t hash(const short* key)
+    {
+        size_t h = 0;
+        for (int i = 0; i < D; i++) h = (h + size_t(uint16_t(key[i]))) * 2531011;
+        return h;
     }
-}
-}; // namespace
 
-template <class Image_T, class KernelImage_T, class GaussSqFunctor_T>
-void ConvolveImageVCD(Image_T& Out, const Image_T& In, const KernelImage_T& Kernel, const GaussSqFunctor_T& GSq)
-{
-    const int N = Kernel.w();
-    const int N2 = N / 2;
-    ASSERT_R((N & 1) && N >= 3); // Filter must be an odd width so it can center on a pixel.
-    const int wid = In.w(), hgt = In.h();
-    Out.SetSize(wid, hgt);
+    // Index of the vertex with this key, or -1
+    int find(const short* key) const
+    {
+        for (size_t h = hash(key) & (Table.size() - 1);; h = (h + 1) & (Table.size() - 1)) {
+            const int v = Table[h];
+            if (v < 0) return -1;
+            if (std::equal(key, key + D, Keys.data() + size_t(v) * D)) return v;
+        }
+    }
 
-    // Do top and bottom edges.
-    for (int y = 0; y < N2; y++)
-        for (int x = N2; x < wid - N2; x++) Out(x, y) = sample_kernel_vcd_weighted(In, Kernel, GSq, x, y);
-    for (int y = hgt - N2; y < hgt; y++)
-        for (int x = N2; x < wid - N2; x++) Out(x, y) = sample_kernel_vcd_weighted(In, Kernel, GSq, x, y);
+    int findOrInsert(const short* key)
+    {
+        size_t h = hash(key) & (Table.size() - 1);
+        for (; Table[h] >= 0; h = (h + 1) & (Table.size() - 1))
+            if (std::equal(key, key + D, Keys.data() + size_t(Table[h]) * D)) return Table[h];
 
-    // Do left and right edges.
+        const int v = int(Keys.size() / D);
+        Keys.insert(Keys.end(), key, key + D);
+        Vals.resize(Vals.size() + VD, 0.f);
+        Table[h] = v;
+
+        // Keep the table at most half full
+        if (size_t(v + 1) * 2 > Table.size()) {
+            Table.assign(Table.size() * 2, -1);
+            for (int u = 0; u <= v; u++) {
+                size_t g = hash(Keys.data() + size_t(u) * D) & (Table.size() - 1);
+                while (Table[g] >= 0) g = (g + 1) & (Table.size() - 1);
+                Table[g] = u;
+            }
+        }
+        return v;
+    }
+};
+
+// Bilateral filter of a three-channel image on the 5D permutohedral lattice over x, y, and the three channels
+template <class Image_T> void BilateralPermutohedral(Image_T& Out, const Image_T& In, const float sigmaS, const float sigmaR)
+{
+    const int wid = In.w(), hgt = In.h();
+    const int n = wid * hgt;
+    std::vector<float> Pos(size_t(n) * 5), Val(size_t(n) * 4);
     for (int y = 0; y < hgt; y++) {
-        for (int x = 0; x < N2; x++) Out(x, y) = sample_kernel_vcd_weighted(In, Kernel, GSq, x, y);
-        for (int x = wid - N2; x < wid; x++) Out(x, y) = sample_kernel_vcd_weighted(In, Kernel, GSq, x, y);
+        for (int x = 0; x < wid; x++) {
+            const size_t p = size_t(y) * wid + x;
+            const typename Image_T::PixType P = In(x, y);
+            Pos[p * 5 + 0] = x / sigmaS;
+            Pos[p * 5 + 1] = y / sigmaS;
+            for (int c = 0; c < 3; c++) Pos[p * 5 + 2 + c] = P[c] / sigmaR, Val[p * 4 + c] = P[c];
+            Val[p * 4 + 3] = 1.f;
+        }
     }
 
-    if (N == 5)
-        ConvolveMiddleVCDN<Image_T, KernelImage_T, GaussSqFunctor_T, 5>(Out, In, Kernel, GSq); // If kernel size is known at compile time.
-    else if (N == 9)
-        ConvolveMiddleVCDN<Image_T, KernelImage_T, GaussSqFunctor_T, 9>(Out, In, Kernel, GSq); // If kernel size is known at compile time.
-    else
-        ConvolveMiddleVCD(Out, In, Kernel, GSq); // If kernel size is not known at compile time.
+    PermutohedralLattice<5, 4> Lattice(Pos.data(), Val.data(), n);
+    Lattice.Blur();
+
+    Out.SetSize(wid, hgt);
+    ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+        for (int y = y0; y < y1; y++) {
+            for (int x = 0; x < wid; x++) {
+                float v[4];
+                Lattice.Slice(v, y * wid + x);
+                for (int c = 0; c < 3; c++) Out(x, y)[c] = v[3] > 0 ? v[c] / v[3] : In(x, y)[c];
+            }
+        }
+    });
 }
+}; // namespace
 
-// FiltWid x FiltWid variable conductance diffusion blur for any image type. Each pixel's contribution is
-// modulated by the gaussian and the color space distance from the target pixel.
-// FiltWid must be odd. Repeat iterations times.
+// VCD's range weight, GaussSqFunc_t, passes ColorStDev squared to GaussianSq() as its stdev, so the approximation
+// filters with that range stdev to match.
 template <class Image_T>
-void VCD(Image_T& Out, const Image_T& In, const int FiltWid, const typename Image_T::PixType::MathType ImageStDev,
-         const typename Image_T::PixType::MathType ColorStDev, const int iterations)
+void VCDApprox(Image_T& Out, const Image_T& In, const typename Image_T::PixType::FloatMathType ImageStDev,
+               const typename Image_T::PixType::FloatMathType ColorStDev, const int iterations)
 {
-    ASSERT_R((FiltWid & 1) && FiltWid >= 3); // Filter must be an odd width so it can center on a pixel.
     ASSERT_R(ImageStDev > 0 && ColorStDev > 0);
+    const float sigmaS = float(ImageStDev), sigmaR = float(ColorStDev * ColorStDev);
 
-    typedef tPixel<typename Image_T::PixType::ElType, 1> KernelPixelType;
-    typedef tImage<KernelPixelType> KernelImageType;
-
-    KernelImageType Kernel = MakeGaussianKernel<KernelImageType>(FiltWid, ImageStDev);
-    GaussSqFunc_t<typename Image_T::PixType::ElType> GSF(ColorStDev);
-
-    ConvolveImageVCD(Out, In, Kernel, GSF);
-
-    for (int i = 1; i < iterations; i++) {
-        Image_T Tmp(Out);
-        ConvolveImageVCD(Out, Tmp, Kernel, GSF);
+    const int passes = std::max(iterations, 1);
+    Image_T Tmp;
+    const Image_T* Src = &In;
+    for (int i = 0; i < passes; i++) {
+        if (i > 0) {
+            Tmp = Out;
+            Src = &Tmp;
+        }
+        if constexpr (Image_T::PixType::Chan == 1)
+            BilateralGrid(Out, *Src, sigmaS, sigmaR);
+        else
+            BilateralPermutohedral(Out, *Src, sigmaS, sigmaR);
     }
 }
 
-template void VCD<f1Image>(f1Image& Out, const f1Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
-template void VCD<f3Image>(f3Image& Out, const f3Image& In, const int FiltWid, float ImageStDev, float ColorStDev, int);
+template void VCDApprox<f1Image>(f1Image& Out, const f1Image& In, float ImageStDev, float ColorStDev, int);
+template void VCDApprox<f3Image>(f3Image& Out, const f3Image& In, float ImageStDev, float ColorStDev, int);
+template void VCDApprox<f1TiledImage>(f1TiledImage& Out, const f1TiledImage& In, float ImageStDev, float ColorStDev, int);
+template void VCDApprox<f3TiledImage>(f3TiledImage& Out, const f3TiledImage& In, float ImageStDev, float ColorStDev, int);
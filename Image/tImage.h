@@ -19,6 +19,20 @@
 // Copy constructor and assignment operator are templated on the argument type, creating a full cross-product of image
 // conversion functions. MSVC is pretty savvy about not doing slow conversions if the pixel types actually match.
 
+// The arithmetic operators on images build expression templates that are evaluated in one pass when assigned to a tImage.
+// Bulk operations on whole images (fill, compound assignment, extrema, sums, comparison) use the SIMD kernels in ImageKernels.h
+// when there are some for the pixel type, and otherwise loop over the pixels.
+
+// Rasters that a tImage allocates start on a baseImage::RasterAlign byte boundary. SetSize() can also pad each row so that
+// every row starts on that boundary. Then the rows are pitch_pix() pixels apart instead of w(). Use row(y), operator()(x, y),
+// or pp(x, y) to walk a padded image. operator[](i) still means the i-th pixel in raster order, but is slower when padded.
+
+// Moving a tImage hands over its raster without copying it. Share() returns an image that shares this one's raster until
+// either image is written through row(), pp(), or a whole-image operation, when the writer gets its own copy. Reading
+// through a const tImage never copies. operator()(x, y) and operator[](i) are plain indexing and don't check, so call
+// MakeUnique() before writing through them to an image that may be shared. Writing through a pointer or reference that
+// was taken before the raster was shared will change both images.
+
 // ImageAlgorithms.cpp has a lot of algorithms that operate on templated tImage types.
 // ImageLoadSave.cpp has most of the image loading/saving stuff. tLoadSave.cpp has the rest.
 
@@ -30,12 +44,19 @@
 
 #pragma once
 
+#include "Image/ImageConvert.h"
+#include "Image/ImageKernels.h"
 #include "Image/LoadSaveParams.h"
 #include "Image/RGBE.h"
 #include "Image/tPixel.h"
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 
 // BaseImage is used to give commonality to all images. This lets them be passed around as a baseImage*.
 // The functions in the base class should be sufficient to allow all operations that don't depend on the image's datatype.
@@ -70,20 +91,26 @@ public:
     // Height of the image.
     virtual int h_virtual() const = 0;
 
-    // Number of pixels in the image.
-    virtual int size_virtual() const = 0;
+    // Number of pixels in the image. Sizes and indices are 64-bit so that rasters over 2 GB work; extents are int.
+    virtual int64_t size_virtual() const = 0;
 
     // Size of image data in elements.
-    virtual int size_els_virtual() const = 0;
+    virtual int64_t size_els_virtual() const = 0;
 
     // Size of image data in bytes.
-    virtual int size_bytes_virtual() const = 0;
+    virtual int64_t size_bytes_virtual() const = 0;
+
+    // Bytes from the start of one row to the start of the next. Equals w * size_pixel unless the rows are padded.
+    virtual int64_t pitch_bytes_virtual() const = 0;
+
+    // Rasters allocated by an image start at a multiple of this many bytes. Padded rows also start at a multiple of it.
+    static const int RasterAlign = 64;
 
     virtual ~baseImage() {};
 
     // A pointer to the pixel data, without knowing its kind
-    virtual void* pv_virtual(const int i = 0) = 0;
-    virtual const void* pv_virtual(const int i = 0) const = 0;
+    virtual void* pv_virtual(const int64_t i = 0) = 0;
+    virtual const void* pv_virtual(const int64_t i = 0) const = 0;
 
     // A pointer to the pixel data, without knowing its kind
     virtual const void* pv_virtual(const int x, const int y) const = 0;
@@ -106,10 +133,116 @@ public:
 // Throws a DMcError on failure.
 baseImage* LoadtImage(const std::string& fname, LoadSaveParams SP = LoadSaveParams());
 
-template <class Pixel_T> class tImage : public baseImage {
+template <class Pixel_T> class tImage;
+
+// Base of all image expressions, including tImage itself. See "Image expressions" below.
+// Every expression type provides PixType, w(), h(), size(), operator[](i), and operator()(x, y).
+template <class Expr_T> struct tImageExpr {
+    const Expr_T& expr() const { return static_cast<const Expr_T&>(*this); }
+};
+
+// Expression nodes hold their operand nodes by value, since they are tiny and usually temporaries, but hold tImages by reference.
+template <class Expr_T> struct tImageExprOperand {
+    typedef const Expr_T type;
+};
+template <class Pixel_T> struct tImageExprOperand<tImage<Pixel_T>> {
+    typedef const tImage<Pixel_T>& type;
+};
+
+template <class Pixel_T> class tImage : public baseImage, public tImageExpr<tImage<Pixel_T>> {
     Pixel_T* Pix; // The actual pixels.
     int wid, hgt;
-    bool ownPix; // True if this owns Pix and must delete it, otherwise just abandons it.
+    int pitch;       // Pixels from the start of one row to the start of the next
+    bool ownPix;     // True if this owns Pix and must delete it, otherwise just abandons it.
+    bool alignedPix; // True if Pix came from allocRaster() rather than new [].
+    // Number of images sharing Pix, or NULL if it isn't shared. Share() is const and may run on several threads at once,
+    // so the first one to share the raster publishes the count with a compare and swap.
+    mutable std::atomic<std::atomic<int>*> Refs;
+
+    // Make this an empty image without freeing anything.
+    void init()
+    {
+        Pix = NULL;
+        wid = hgt = pitch = 0;
+        ownPix = alignedPix = false;
+        Refs = NULL;
+    }
+
+    typedef typename Pixel_T::ElType ElT;
+
+    // The SIMD kernels see the raster as a flat array of elements, which is only true for tightly packed pixels.
+    static const bool FlatEls = sizeof(Pixel_T) == sizeof(ElT) * Pixel_T::Chan;
+    ElT* els()
+    {
+        unshare();
+        return reinterpret_cast<ElT*>(Pix);
+    }
+    const ElT* els() const { return reinterpret_cast<const ElT*>(Pix); }
+
+    ElT* els(const int y) { return reinterpret_cast<ElT*>(row(y)); }
+    const ElT* els(const int y) const { return reinterpret_cast<const ElT*>(row(y)); }
+
+    // The kernels run on the whole raster at once when there's no padding, and otherwise on one row at a time.
+    // A kernel's support only depends on the type and channel count, so if it declines the first row nothing has been written yet.
+    bool simdOp(const ElemOp_e op, const tImage<Pixel_T>& p)
+    {
+        if (!FlatEls || size() < 1) return false;
+        if (contiguous() && p.contiguous()) return SIMDElemOp(op, els(), p.els(), size_t(size_els()));
+        for (int y = 0; y < h(); y++)
+            if (!SIMDElemOp(op, els(y), p.els(y), size_t(w()) * chan())) return false;
+        return true;
+    }
+
+    bool simdOp(const ElemOp_e op, const Pixel_T& s)
+    {
+        if (!FlatEls || size() < 1) return false;
+        if (contiguous()) return SIMDElemOpPixel(op, els(), size_t(size_els()), reinterpret_cast<const ElT*>(&s), chan());
+        for (int y = 0; y < h(); y++)
+            if (!SIMDElemOpPixel(op, els(y), size_t(w()) * chan(), reinterpret_cast<const ElT*>(&s), chan())) return false;
+        return true;
+    }
+
+    // Allocate or free a raster of n pixels on a RasterAlign boundary
+    static Pixel_T* allocRaster(const size_t n)
+    {
+        Pixel_T* P = static_cast<Pixel_T*>(::operator new[](n * sizeof(Pixel_T), std::align_val_t(RasterAlign)));
+        std::uninitialized_default_construct_n(P, n);
+        return P;
+    }
+
+    // A shared raster is only freed by the last image to let go of it.
+    void freeRaster()
+    {
+        static_assert(std::is_trivially_destructible<Pixel_T>::value, "Rasters are freed without destroying the pixels");
+        if (Pix && ownPix && !(Refs && --*Refs > 0)) {
+            delete Refs;
+            if (alignedPix)
+                ::operator delete[](Pix, std::align_val_t(RasterAlign));
+            else
+                delete[] Pix;
+        }
+        Pix = NULL;
+        ownPix = alignedPix = false;
+        Refs = NULL;
+    }
+
+    // Called before writing to the raster. If other images share it, give this image its own copy, keeping the pitch.
+    // keepPixels is false when the caller will overwrite every pixel anyway.
+    void unshare(const bool keepPixels = true)
+    {
+        if (!Refs) return;
+        if (*Refs == 1) { // The others have all let go of it.
+            delete Refs;
+            Refs = NULL;
+            return;
+        }
+        Pixel_T* P = allocRaster(size_t(pitch) * hgt);
+        if (keepPixels)
+            for (int y = 0; y < hgt; y++) std::copy(Pix + size_t(y) * pitch, Pix + size_t(y) * pitch + wid, P + size_t(y) * pitch);
+        freeRaster();
+        Pix = P;
+        ownPix = alignedPix = true;
+    }
 
 public:
     //////////////////////////////////////////////////////////////////////
@@ -119,8 +252,7 @@ public:
     // Doesn't initialize the pixels.
     tImage(const int wid_ = 0, const int hgt_ = 0)
     {
-        Pix = NULL;
-        wid = hgt = 0;
+        init();
         SetSize(wid_, hgt_, false);
     }
 
@@ -128,8 +260,7 @@ public:
     // Initializes the pixels to fillVal.
     tImage(const int wid_, const int hgt_, const Pixel_T& fillVal)
     {
-        Pix = NULL;
-        wid = hgt = 0;
+        init();
         SetSize(wid_, hgt_, false);
         fill(fillVal);
     }
@@ -137,8 +268,7 @@ public:
     // Construct an image from a file.
     tImage(const std::string& fname)
     {
-        Pix = NULL;
-        wid = hgt = 0;
+        init();
         Load(fname);
     }
 
@@ -146,25 +276,19 @@ public:
     // This image becomes responsible for the delete [].
     tImage(Pixel_T* p, const int wid_, const int hgt_, const bool ownPix_)
     {
-        Pix = NULL;
+        init();
         SetImage(p, wid_, hgt_, ownPix_);
     }
 
 private:
-    // The internals of copying, which are shared between copy constructor, operator=, and Copy.
+    // The internals of copying, which are shared between copy constructor and operator=.
+    // ConvertImage() gives the same pixels as the tPixel converting constructor, using SIMD, tables, and threads.
     template <class SrcPixel_T> void do_copy(const tImage<SrcPixel_T>& SrcIm)
     {
+        init();
         if (SrcIm.size() > 0) {
-            Pix = NULL;
-            wid = hgt = 0;
             SetSize(SrcIm.w(), SrcIm.h(), false);
-            int sz = SrcIm.size();
-            for (int i = 0; i < sz; i++)
-                (*this)[i] = static_cast<Pixel_T>(SrcIm[i]); // Doesn't call the tPixel copy constructor if Pixel_T == SrcPixel_T. Cool!
-        } else {
-            Pix = NULL;
-            wid = hgt = 0;
-            ownPix = false;
+            ConvertImage(*this, SrcIm);
         }
     }
 
@@ -183,6 +307,7 @@ public:
     {
         if ((void*)this != (void*)&SrcIm) {
             // std::cerr << "Conversion Assignment\n";
+            freeRaster();
             do_copy(SrcIm);
         } else {
             // std::cerr << "Identical assignment\n";
@@ -195,6 +320,7 @@ public:
     {
         if ((void*)this != (void*)&SrcIm) {
             // std::cerr << "Conversion Assignment\n";
+            freeRaster();
             do_copy(SrcIm);
         } else {
             // std::cerr << "Identical assignment\n";
@@ -202,6 +328,51 @@ public:
         return *this;
     }
 
+    // Move constructor. Takes SrcIm's raster without copying it and leaves SrcIm empty.
+    tImage(tImage<Pixel_T>&& SrcIm) noexcept
+    {
+        init();
+        swap(SrcIm);
+    }
+
+    // Move assignment. Frees this image's raster, takes SrcIm's, and leaves SrcIm empty.
+    tImage<Pixel_T>& operator=(tImage<Pixel_T>&& SrcIm) noexcept
+    {
+        if (this != &SrcIm) {
+            freeRaster();
+            init();
+            swap(SrcIm);
+        }
+        return *this;
+    }
+
+    // Construct an image by evaluating an image expression such as a * b + c.
+    // Converts from the expression's pixel type to this pixel type.
+    template <class Expr_T> tImage(const tImageExpr<Expr_T>& E)
+    {
+        init();
+        assign_expr(E.expr());
+    }
+
+    // Assign an image expression to this image. The expression is evaluated in a single pass with no temporary images.
+    // This image may also be an operand of the expression since each output pixel only depends on the same pixel of the operands.
+    template <class Expr_T> tImage<Pixel_T>& operator=(const tImageExpr<Expr_T>& E)
+    {
+        assign_expr(E.expr());
+        return *this;
+    }
+
+private:
+    template <class Expr_T> void assign_expr(const Expr_T& E)
+    {
+        if (w() != E.w() || h() != E.h()) SetSize(E.w(), E.h(), false);
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* d = row(y);
+            for (int x = 0; x < w(); x++) d[x] = static_cast<Pixel_T>(E(x, y));
+        }
+    }
+
+public:
     // Create a copy of this image and return it. This is a virtual function so that copies can be made when only the base class is known.
     tImage<Pixel_T>* Copy() const
     {
@@ -210,12 +381,45 @@ public:
         return Created;
     }
 
+    // Return an image that shares this image's raster. The raster is copied when either image is next written through
+    // row(), pp(), or a whole-image operation, or by MakeUnique().
+    // This only costs a reference count, so it's the cheap way to hand an image to something that might modify it.
+    // An image whose raster it doesn't own, from SetImage(), can't be shared and is copied immediately.
+    tImage<Pixel_T> Share() const
+    {
+        if (!ownPix || empty()) return tImage<Pixel_T>(*this);
+        std::atomic<int>* R = Refs.load();
+        if (!R) {
+            std::atomic<int>* NewR = new std::atomic<int>(1);
+            if (Refs.compare_exchange_strong(R, NewR))
+                R = NewR;
+            else
+                delete NewR; // Another thread shared it first, and R is now its count.
+        }
+        ++*R;
+        tImage<Pixel_T> Img;
+        Img.Pix = Pix;
+        Img.wid = wid;
+        Img.hgt = hgt;
+        Img.pitch = pitch;
+        Img.ownPix = true;
+        Img.alignedPix = alignedPix;
+        Img.Refs = R;
+        return Img;
+    }
+
+    // True if another image currently shares this image's raster.
+    bool shared() const { return Refs && *Refs > 1; }
+
+    // Give this image its own copy of the raster if it is shared. Call this before writing pixels through operator()
+    // or operator[], which don't check.
+    void MakeUnique() { unshare(); }
+
     // Destroy an image.
     ~tImage()
     {
         // std::cerr << "deleting tImage: " << this << ": " << Pix << std::endl;
-        if (Pix && ownPix) delete[] Pix;
-        Pix = NULL;
+        freeRaster();
         // std::cerr << "done deleting tImage\n";
     }
 
@@ -265,51 +469,74 @@ public:
     int h_virtual() const { return hgt; }
 
     // Number of pixels in the image.
-    int size() const { return wid * hgt; }
-    int size_virtual() const { return wid * hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    int64_t size_virtual() const { return int64_t(wid) * hgt; }
 
     // Size of image data in elements.
-    int size_els() const { return size() * chan(); }
-    int size_els_virtual() const { return size() * chan(); }
+    int64_t size_els() const { return size() * chan(); }
+    int64_t size_els_virtual() const { return size() * chan(); }
 
-    // Size of image data in bytes.
-    int size_bytes() const { return size() * size_pixel(); }
-    int size_bytes_virtual() const { return size() * size_pixel(); }
+    // Size of image data in bytes, not counting any row padding.
+    int64_t size_bytes() const { return size() * size_pixel(); }
+    int64_t size_bytes_virtual() const { return size() * size_pixel(); }
+
+    // Pixels from the start of one row to the start of the next.
+    int pitch_pix() const { return pitch; }
+
+    // Bytes from the start of one row to the start of the next.
+    int64_t pitch_bytes() const { return int64_t(pitch) * size_pixel(); }
+    int64_t pitch_bytes_virtual() const { return int64_t(pitch) * size_pixel(); }
+
+    // True if the rows have no padding, so the pixels are one array of size() pixels.
+    bool contiguous() const { return pitch == wid; }
 
     //////////////////////////////////////////////////////////////////////
     // Access functions
 
-    // Return the index of this pixel in raster fashion.
-    int ind(const int x, const int y) const { return y * w() + x; }
+    // Return the index of this pixel in the raster, counting any row padding.
+    int64_t ind(const int x, const int y) const { return int64_t(y) * pitch + x; }
+
+    // Returns a pointer to the start of row y.
+    const Pixel_T* row(const int y) const
+    {
+        ASSERT_D(y >= 0 && y < h());
+        return Pix + size_t(y) * pitch;
+    }
+    Pixel_T* row(const int y)
+    {
+        ASSERT_D(y >= 0 && y < h());
+        unshare();
+        return Pix + size_t(y) * pitch;
+    }
 
     // Returns const pixel x,y.
     const Pixel_T& operator()(const int x, const int y) const
     {
         ASSERT_D(x >= 0 && x < w());
         ASSERT_D(y >= 0 && y < h());
-        return *pp(ind(x, y));
+        return Pix[ind(x, y)];
     }
 
-    // Returns pixel x,y.
+    // Returns pixel x,y. Doesn't unshare the raster; see MakeUnique().
     Pixel_T& operator()(const int x, const int y)
     {
         ASSERT_D(x >= 0 && x < w());
         ASSERT_D(y >= 0 && y < h());
-        return *pp(ind(x, y));
+        return Pix[ind(x, y)];
     }
 
-    // Returns const pixel i.
-    const Pixel_T& operator[](const int i) const
+    // Returns const pixel i, counting in raster order.
+    const Pixel_T& operator[](const int64_t i) const
     {
         ASSERT_D(i >= 0 && i < size());
         return *pp(i);
     }
 
-    // Returns pixel i.
-    Pixel_T& operator[](const int i)
+    // Returns pixel i, counting in raster order. Doesn't unshare the raster; see MakeUnique().
+    Pixel_T& operator[](const int64_t i)
     {
         ASSERT_D(i >= 0 && i < size());
-        return *pp(i);
+        return Pix[rind(i)];
     }
 
     // Returns a const pointer to this pixel.
@@ -318,7 +545,7 @@ public:
         ASSERT_D(x >= 0 && x < w());
         ASSERT_D(y >= 0 && y < h());
         ASSERT_D(Pix != NULL);
-        return pp(ind(x, y));
+        return &(Pix[ind(x, y)]);
     }
 
     // Returns a pointer to this pixel.
@@ -327,65 +554,64 @@ public:
         ASSERT_D(x >= 0 && x < w());
         ASSERT_D(y >= 0 && y < h());
         ASSERT_D(Pix != NULL);
-        return pp(ind(x, y));
+        unshare();
+        return &(Pix[ind(x, y)]);
     }
 
-    // Returns a const pointer to this pixel.
-    const Pixel_T* pp(const int i = 0) const
+    // Returns a const pointer to pixel i, counting in raster order.
+    const Pixel_T* pp(const int64_t i = 0) const
     {
         ASSERT_D(i >= 0 && i < size());
         ASSERT_D(Pix != NULL);
-        return &(Pix[i]);
+        return &(Pix[rind(i)]);
     }
 
-    // Returns a pointer to this pixel.
-    Pixel_T* pp(const int i = 0)
+    // Returns a pointer to pixel i, counting in raster order.
+    Pixel_T* pp(const int64_t i = 0)
     {
         ASSERT_D(i >= 0 && i < size());
         ASSERT_D(Pix != NULL);
-        return &(Pix[i]);
+        unshare();
+        return &(Pix[rind(i)]);
     }
 
+private:
+    // Index in the raster of the i-th pixel in raster order
+    int64_t rind(const int64_t i) const { return contiguous() ? i : ind(int(i % wid), int(i / wid)); }
+
+public:
     // A const pointer to the pixel data, without knowing its kind
-    const void* pv(const int i = 0) const
+    const void* pv(const int64_t i = 0) const
     {
         ASSERT_D(i >= 0 && i < size());
-        return &(Pix[i]);
+        return &(Pix[rind(i)]);
     }
-    const void* pv_virtual(const int i = 0) const
+    const void* pv_virtual(const int64_t i = 0) const
     {
         ASSERT_D(i >= 0 && i < size());
-        return &(Pix[i]);
+        return &(Pix[rind(i)]);
     }
 
     // A pointer to the pixel data, without knowing its kind
-    void* pv(const int i = 0)
-    {
-        ASSERT_D(i >= 0 && i < size());
-        return &(Pix[i]);
-    }
-    void* pv_virtual(const int i = 0)
-    {
-        ASSERT_D(i >= 0 && i < size());
-        return &(Pix[i]);
-    }
+    void* pv(const int64_t i = 0) { return pp(i); }
+    void* pv_virtual(const int64_t i = 0) { return pp(i); }
 
     // A pointer to the pixel data, without knowing its kind
     const void* pv(const int x, const int y) const
     {
         ASSERT_D(x >= 0 && x < w() && y >= 0 && y < h());
-        return pp(ind(x, y));
+        return pp(x, y);
     }
     const void* pv_virtual(const int x, const int y) const
     {
         ASSERT_D(x >= 0 && x < w() && y >= 0 && y < h());
-        return pp(ind(x, y));
+        return pp(x, y);
     }
 
     // Paint pixel x,y if it has valid coords.
     void Set(const Pixel_T& p, const int x, const int y)
     {
-        if (x >= 0 && x < w() && y >= 0 && y < h()) *pp(ind(x, y)) = p;
+        if (x >= 0 && x < w() && y >= 0 && y < h()) *pp(x, y) = p;
     }
 
     //////////////////////////////////////////////////////////////////////
@@ -395,53 +621,86 @@ public:
     void GetMinMax(Pixel_T& cmin, Pixel_T& cmax) const
     {
         ASSERT_R(size() > 0);
+        if (FlatEls && contiguous() && SIMDMinMax(els(), size_t(size_els()), chan(), reinterpret_cast<ElT*>(&cmin), reinterpret_cast<ElT*>(&cmax)))
+            return;
         cmax = (*this)[0];
         cmin = (*this)[0];
-        int sz = size();
-        for (int i = 1; i < sz; i++) {
-            cmax = Max(cmax, (*this)[i]);
-            cmin = Min(cmin, (*this)[i]);
+        for (int y = 0; y < h(); y++) {
+            const Pixel_T* r = row(y);
+            Pixel_T rmin, rmax;
+            if (FlatEls && SIMDMinMax(els(y), size_t(w()) * chan(), chan(), reinterpret_cast<ElT*>(&rmin), reinterpret_cast<ElT*>(&rmax))) {
+                cmax = Max(cmax, rmax);
+                cmin = Min(cmin, rmin);
+                continue;
+            }
+            for (int x = 0; x < w(); x++) {
+                cmax = Max(cmax, r[x]);
+                cmin = Min(cmin, r[x]);
+            }
         }
     }
 
     // Max over all pixels for each channel.
     Pixel_T max_chan() const
     {
-        ASSERT_R(size() > 0);
-        Pixel_T cmax = (*this)[0];
-        int sz = size();
-        for (int i = 1; i < sz; i++) cmax = Max(cmax, (*this)[i]);
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
         return cmax;
     }
 
     // Min over all pixels for each channel.
     Pixel_T min_chan() const
     {
-        ASSERT_R(size() > 0);
-        Pixel_T cmin = (*this)[0];
-        int sz = size();
-        for (int i = 1; i < sz; i++) cmin = Min(cmin, (*this)[i]);
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
         return cmin;
     }
 
     // Returns the channel-wise sum of all the pixels.
     typename Pixel_T::MathPixType sum_chan() const
     {
-        ASSERT_R(size() > 0);
-        typename Pixel_T::MathPixType csum(0);
-        int sz = size();
-        for (int i = 0; i < sz; i++) csum += (*this)[i];
+        double sums[Pixel_T::Chan];
+        sum_chan(sums);
+        typename Pixel_T::MathPixType csum;
+        for (int c = 0; c < chan(); c++) csum[c] = static_cast<typename Pixel_T::MathType>(sums[c]);
         return csum;
     }
 
+    // Stores the channel-wise sum of all the pixels in sums. They are accumulated in double, so the sums don't overflow
+    // MathType on images with billions of integer pixels.
+    void sum_chan(double sums[Pixel_T::Chan]) const
+    {
+        ASSERT_R(size() > 0);
+        if (FlatEls && contiguous() && chan() <= 4 && SIMDSumChan(els(), size_t(size_els()), chan(), sums)) return;
+        for (int c = 0; c < chan(); c++) sums[c] = 0;
+        for (int y = 0; y < h(); y++) {
+            const Pixel_T* r = row(y);
+            typename Pixel_T::MathPixType rsum(0);
+            for (int x = 0; x < w(); x++) rsum += static_cast<typename Pixel_T::MathPixType>(r[x]);
+            for (int c = 0; c < chan(); c++) sums[c] += rsum[c];
+        }
+    }
+
     // Returns the channel-wise average of all the pixels.
-    Pixel_T mean_chan() const { return sum_chan() / Pixel_T::MathPixType(size()); }
+    Pixel_T mean_chan() const
+    {
+        double sums[Pixel_T::Chan];
+        sum_chan(sums);
+        Pixel_T cmean;
+        for (int c = 0; c < chan(); c++) cmean[c] = static_cast<typename Pixel_T::ElType>(static_cast<typename Pixel_T::MathType>(sums[c] / double(size())));
+        return cmean;
+    }
 
     // Clear the image to the given color.
     void fill(const Pixel_T p = Pixel_T(0))
     {
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] = p;
+        unshare(false);
+        if (size() > 0 && FlatEls && contiguous() && SIMDFill(Pix, size_t(size_bytes()), &p, size_pixel())) return;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            if (FlatEls && SIMDFill(r, size_t(w()) * size_pixel(), &p, size_pixel())) continue;
+            for (int x = 0; x < w(); x++) r[x] = p;
+        }
     }
 
     // Test whether the image is currently empty.
@@ -461,21 +720,22 @@ public:
 
     // Change the size of this image.
     // Call with w=h=0 to clear the image.
-    void SetSize(const int wid_, const int hgt_, const bool doFill = false)
+    // If padRows is true, each row is padded so that every row starts on a baseImage::RasterAlign byte boundary.
+    // The padding pixels are never read or written by tImage.
+    void SetSize(const int wid_, const int hgt_, const bool doFill = false, const bool padRows = false)
     {
+        freeRaster();
+
         wid = wid_;
         hgt = hgt_;
         if (w() <= 0 || h() <= 0) wid = hgt = 0;
-
-        if (Pix && ownPix) delete[] Pix;
-        Pix = NULL;
-        ownPix = false;
+        pitch = padRows ? PaddedPitch(wid) : wid;
 
         if (size() > 0) {
             // std::cerr << "Allocating\n";
             try {
-                Pix = new Pixel_T[size()];
-                ownPix = true;
+                Pix = allocRaster(size_t(pitch) * hgt);
+                ownPix = alignedPix = true;
             }
             catch (...) {
                 ASSERT_RM(0, "memory alloc failed");
@@ -486,20 +746,43 @@ public:
         ASSERT_D(size() == 0 || Pix != NULL);
     }
 
+    // The smallest pitch of at least wid_ pixels whose rows all start on a RasterAlign byte boundary.
+    static int PaddedPitch(const int wid_)
+    {
+        int step = 1;
+        while ((step * sizeof(Pixel_T)) % RasterAlign) step++;
+        return ((wid_ + step - 1) / step) * step;
+    }
+
+    // Exchange the rasters of two images without copying any pixels.
+    void swap(tImage<Pixel_T>& Img)
+    {
+        std::swap(Pix, Img.Pix);
+        std::swap(wid, Img.wid);
+        std::swap(hgt, Img.hgt);
+        std::swap(pitch, Img.pitch);
+        std::swap(ownPix, Img.ownPix);
+        std::swap(alignedPix, Img.alignedPix);
+        Refs = Img.Refs.exchange(Refs);
+    }
+
     // Hooks the given raster of pixels into this image object.
     // This tImage owns the data if ownPix is true.
-    // WARNING: Doesn't delete [] its previous data.
+    // WARNING: Doesn't delete [] its previous data, unless it was shared.
     // WARNING: Image data must really be this pixel type to be deleted.
     void SetImage(Pixel_T* p, const int wid_, const int hgt_, const bool ownPix_)
     {
         ASSERT_D(wid_ >= 0 && hgt_ >= 0);
+        if (Refs) freeRaster();
         Pix = p;
         wid = wid_;
         hgt = hgt_;
         ownPix = ownPix_;
+        alignedPix = false;
 
         // Sanity check.
         if (Pix == NULL) wid = hgt = 0;
+        pitch = wid;
         if (size() <= 0) Pix = NULL;
         ASSERT_D(size() == 0 || Pix != NULL);
     }
@@ -510,34 +793,55 @@ public:
     //////////////////////////////////////////////////////////////////////
     // Image Operators
 
-    // With an image, with assign
+    // With an image or image expression, with assign
+    // The expression is evaluated one pixel at a time straight into this image.
 
-    tImage<Pixel_T>& operator+=(const tImage<Pixel_T>& p)
+    template <class Expr_T> tImage<Pixel_T>& operator+=(const tImageExpr<Expr_T>& E)
     {
-        ASSERT_R(size() == p.size());
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] += p[i];
+        const Expr_T& p = E.expr();
+        ASSERT_R(w() == p.w() && h() == p.h());
+        if constexpr (std::is_same<Expr_T, tImage<Pixel_T>>::value)
+            if (simdOp(ELEM_ADD, p)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] += p(x, y);
+        }
         return *this;
     }
-    tImage<Pixel_T>& operator-=(const tImage<Pixel_T>& p)
+    template <class Expr_T> tImage<Pixel_T>& operator-=(const tImageExpr<Expr_T>& E)
     {
-        ASSERT_R(size() == p.size());
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] -= p[i];
+        const Expr_T& p = E.expr();
+        ASSERT_R(w() == p.w() && h() == p.h());
+        if constexpr (std::is_same<Expr_T, tImage<Pixel_T>>::value)
+            if (simdOp(ELEM_SUB, p)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] -= p(x, y);
+        }
         return *this;
     }
-    tImage<Pixel_T>& operator*=(const tImage<Pixel_T>& p)
+    template <class Expr_T> tImage<Pixel_T>& operator*=(const tImageExpr<Expr_T>& E)
     {
-        ASSERT_R(size() == p.size());
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] *= p[i];
+        const Expr_T& p = E.expr();
+        ASSERT_R(w() == p.w() && h() == p.h());
+        if constexpr (std::is_same<Expr_T, tImage<Pixel_T>>::value)
+            if (simdOp(ELEM_MUL, p)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] *= p(x, y);
+        }
         return *this;
     }
-    tImage<Pixel_T>& operator/=(const tImage<Pixel_T>& p)
+    template <class Expr_T> tImage<Pixel_T>& operator/=(const tImageExpr<Expr_T>& E)
     {
-        ASSERT_R(size() == p.size());
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] /= p[i];
+        const Expr_T& p = E.expr();
+        ASSERT_R(w() == p.w() && h() == p.h());
+        if constexpr (std::is_same<Expr_T, tImage<Pixel_T>>::value)
+            if (simdOp(ELEM_DIV, p)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] /= p(x, y);
+        }
         return *this;
     }
 
@@ -545,228 +849,252 @@ public:
 
     tImage<Pixel_T>& operator+=(const Pixel_T& s)
     {
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] += s;
+        if (simdOp(ELEM_ADD, s)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] += s;
+        }
         return *this;
     }
     tImage<Pixel_T>& operator-=(const Pixel_T& s)
     {
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] -= s;
+        if (simdOp(ELEM_SUB, s)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] -= s;
+        }
         return *this;
     }
     tImage<Pixel_T>& operator*=(const Pixel_T& s)
     {
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] *= s;
+        if (simdOp(ELEM_MUL, s)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] *= s;
+        }
         return *this;
     }
     tImage<Pixel_T>& operator/=(const Pixel_T& s)
     {
-        int sz = size();
-        for (int i = 0; i < sz; i++) (*this)[i] /= s;
+        if (simdOp(ELEM_DIV, s)) return *this;
+        for (int y = 0; y < h(); y++) {
+            Pixel_T* r = row(y);
+            for (int x = 0; x < w(); x++) r[x] /= s;
+        }
         return *this;
     }
+};
+
+//////////////////////////////////////////////////////////////////////
+// Image expressions
+//
+// The arithmetic operators below don't compute anything. Each returns a small node that remembers its operands.
+// Assigning the finished expression to a tImage evaluates the whole tree in one pass with no temporary images,
+// so r = a * b + c * d touches each pixel once and allocates at most r itself.
+// WARNING: Don't store an expression in an auto variable. It refers to its operand images and is only meant to live until the assignment.
+
+// Pixel i (or x,y) of an image expression is a pixel of a binary operation on pixel i (or x,y) of its operands.
+template <class LExpr_T, class RExpr_T, class Op_T> class tImageBinaryExpr : public tImageExpr<tImageBinaryExpr<LExpr_T, RExpr_T, Op_T>> {
+    typename tImageExprOperand<LExpr_T>::type L;
+    typename tImageExprOperand<RExpr_T>::type R;
+    Op_T Op;
+
+public:
+    typedef typename LExpr_T::PixType PixType;
+    static_assert(std::is_same<PixType, typename RExpr_T::PixType>::value, "Image expression operands must have the same pixel type");
+
+    tImageBinaryExpr(const LExpr_T& L_, const RExpr_T& R_, const Op_T& Op_ = Op_T()) : L(L_), R(R_), Op(Op_)
+    {
+        ASSERT_R(L.w() == R.w() && L.h() == R.h());
+    }
+
+    int w() const { return L.w(); }
+    int h() const { return L.h(); }
+    int64_t size() const { return L.size(); }
+    PixType operator[](const int64_t i) const { return Op(L[i], R[i]); }
+    PixType operator()(const int x, const int y) const { return Op(L(x, y), R(x, y)); }
+};
+
+// Pixel i (or x,y) of an image expression is a unary operation on pixel i (or x,y) of its operand.
+template <class Expr_T, class Op_T> class tImageUnaryExpr : public tImageExpr<tImageUnaryExpr<Expr_T, Op_T>> {
+    typename tImageExprOperand<Expr_T>::type E;
+    Op_T Op;
+
+public:
+    typedef typename Expr_T::PixType PixType;
+
+    tImageUnaryExpr(const Expr_T& E_, const Op_T& Op_ = Op_T()) : E(E_), Op(Op_) {}
+
+    int w() const { return E.w(); }
+    int h() const { return E.h(); }
+    int64_t size() const { return E.size(); }
+    PixType operator[](const int64_t i) const { return Op(E[i]); }
+    PixType operator()(const int x, const int y) const { return Op(E(x, y)); }
+};
+
+// A constant pixel that acts like an image of the given size, for mixing scalars into expressions.
+template <class Pixel_T> class tImageScalarExpr : public tImageExpr<tImageScalarExpr<Pixel_T>> {
+    Pixel_T V;
+    int wid, hgt;
+
+public:
+    typedef Pixel_T PixType;
+
+    tImageScalarExpr(const Pixel_T& V_, const int wid_, const int hgt_) : V(V_), wid(wid_), hgt(hgt_) {}
+
+    int w() const { return wid; }
+    int h() const { return hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    const Pixel_T& operator[](const int64_t) const { return V; }
+    const Pixel_T& operator()(const int, const int) const { return V; }
+};
 
-#if 1
-    // With a constant pixel
-    tImage<Pixel_T> operator/(const Pixel_T& v)
+// The pixel operations that the expression nodes apply.
+struct tImageOpAdd {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return a + b; }
+};
+struct tImageOpSub {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return a - b; }
+};
+struct tImageOpMul {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return a * b; }
+};
+struct tImageOpDiv {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return a / b; }
+};
+struct tImageOpMax {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return Max(a, b); }
+};
+struct tImageOpMin {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return Min(a, b); }
+};
+template <class Weight_T> struct tImageOpLerp {
+    Weight_T weight;
+    tImageOpLerp(const Weight_T weight_) : weight(weight_) {}
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a, const Pixel_T& b) const { return linInterp(a, b, weight); }
+};
+struct tImageOpNeg {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a) const { return -a; }
+};
+struct tImageOpAbs {
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a) const { return Abs(a); }
+};
+// Applies an arbitrary function to each channel of a pixel.
+template <class Func_T> struct tImageOpFunc {
+    Func_T fnc;
+    tImageOpFunc(const Func_T& fnc_) : fnc(fnc_) {}
+    template <class Pixel_T> DMC_DECL Pixel_T operator()(const Pixel_T& a) const
     {
-        tImage<Pixel_T> r(w(), h());
-        int sz = size();
-        for (int i = 0; i < sz; i++) r[i] = (*this)[i] / v;
+        Pixel_T r;
+        for (int j = 0; j < Pixel_T::Chan; j++) r[j] = fnc(a[j]);
         return r;
     }
-#endif
 };
 
-// Apply an arbitrary function to each channel of each pixel and put the result in image r.
-template <class Pixel_T, class Func_T> DMC_HDECL void ifunc(tImage<Pixel_T>& r, const tImage<Pixel_T>& p, Func_T fnc)
+// Apply an arbitrary function to each channel of each pixel of an image expression.
+template <class Expr_T, class Func_T> DMC_HDECL tImageUnaryExpr<Expr_T, tImageOpFunc<Func_T>> ifunc(const tImageExpr<Expr_T>& p, Func_T fnc)
 {
-    r.SetSize(p.w(), p.h());
-
-    int sz = p.size();
-    for (int i = 0; i < sz; i++)
-        for (int j = 0; j < Pixel_T::chan(); j++) r[i][j] = fnc(p[i][j]);
+    return tImageUnaryExpr<Expr_T, tImageOpFunc<Func_T>>(p.expr(), tImageOpFunc<Func_T>(fnc));
 }
 
+// Apply an arbitrary function to each channel of each pixel and put the result in image r.
+template <class Pixel_T, class Expr_T, class Func_T> DMC_HDECL void ifunc(tImage<Pixel_T>& r, const tImageExpr<Expr_T>& p, Func_T fnc) { r = ifunc(p, fnc); }
+
 // Apply an arbitrary function to each channel of each pixel.
 // Modifies the image in place.
-template <class Pixel_T, class Func_T> DMC_HDECL void func(tImage<Pixel_T>& p, Func_T fnc)
-{
-    int sz = p.size();
-    for (int i = 0; i < sz; i++)
-        for (int j = 0; j < Pixel_T::chan(); j++) p[i][j] = fnc(p[i][j]);
-}
+template <class Pixel_T, class Func_T> DMC_HDECL void func(tImage<Pixel_T>& p, Func_T fnc) { p = ifunc(p, fnc); }
 
 // Unary minus.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator-(const tImage<Pixel_T>& p)
+template <class Expr_T> DMC_HDECL tImageUnaryExpr<Expr_T, tImageOpNeg> operator-(const tImageExpr<Expr_T>& p)
 {
-    ASSERT_R(Pixel_T::is_signed); // WARNING: Doesn't work for unsigned pixel types.
-
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = -p[i];
-    return r;
+    ASSERT_R(Expr_T::PixType::is_signed); // WARNING: Doesn't work for unsigned pixel types.
+    return tImageUnaryExpr<Expr_T, tImageOpNeg>(p.expr());
 }
 
 // Equal.
 template <class Pixel_T> DMC_HDECL bool operator==(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
 {
     if (p1.w() != p2.w() || p1.h() != p2.h()) return false;
-    int sz = p1.size();
-    for (int i = 0; i < sz; i++)
-        if (p1[i] != p2[i]) return false;
+    typedef typename Pixel_T::ElType ElT;
+    bool equal = false;
+    const bool flatEls = sizeof(Pixel_T) == sizeof(ElT) * Pixel_T::Chan;
+    if (p1.size() > 0 && flatEls && p1.contiguous() && p2.contiguous() &&
+        SIMDEqual(static_cast<const ElT*>(p1.pv()), static_cast<const ElT*>(p2.pv()), size_t(p1.size_els()), equal))
+        return equal;
+    for (int y = 0; y < p1.h(); y++) {
+        const Pixel_T* r1 = p1.row(y);
+        const Pixel_T* r2 = p2.row(y);
+        if (flatEls && SIMDEqual(reinterpret_cast<const ElT*>(r1), reinterpret_cast<const ElT*>(r2), size_t(p1.w()) * Pixel_T::Chan, equal)) {
+            if (!equal) return false;
+            continue;
+        }
+        for (int x = 0; x < p1.w(); x++)
+            if (r1[x] != r2[x]) return false;
+    }
     return true;
 }
 
 // Not equal.
 template <class Pixel_T> DMC_HDECL bool operator!=(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2) { return !(p1 == p2); }
 
-// With two images
-
-// Didn't do the suggested local copy and += for optimization.
-// WARNING: After you use one of these you will probably assign it using operator=,
-// which does a member-wise (unsafe) copy if src and dest pixel types match.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator+(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
-{
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < sz; i++) r[i] = p1[i] + p2[i];
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator-(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
-{
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < sz; i++) r[i] = p1[i] - p2[i];
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator*(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
-{
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < sz; i++) r[i] = p1[i] * p2[i];
-    return r;
-}
-// WARNING: Be careful for divide by zero.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator/(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
-{
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < sz; i++) r[i] = p1[i] / p2[i];
-    return r;
-}
-
-// With a left scalar and a right image
-
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator+(const Pixel_T& v, const tImage<Pixel_T>& p)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = v + p[i];
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator-(const Pixel_T& v, const tImage<Pixel_T>& p)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = v - p[i];
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator*(const Pixel_T& v, const tImage<Pixel_T>& p)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = v * p[i];
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator/(const Pixel_T& v, const tImage<Pixel_T>& p)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = v / p[i];
-    return r;
-}
-
-// With a right scalar and a left image
+// Binary operators on every combination of image expression and constant pixel.
+// The constant pixel becomes a tImageScalarExpr the size of the image operand.
+#define DMC_IMAGE_EXPR_BINARY_OP(OPERATOR, OP_T)                                                                                                            \
+    template <class LExpr_T, class RExpr_T>                                                                                                                 \
+    DMC_HDECL tImageBinaryExpr<LExpr_T, RExpr_T, OP_T> OPERATOR(const tImageExpr<LExpr_T>& p1, const tImageExpr<RExpr_T>& p2)                              \
+    {                                                                                                                                                       \
+        return tImageBinaryExpr<LExpr_T, RExpr_T, OP_T>(p1.expr(), p2.expr());                                                                              \
+    }                                                                                                                                                       \
+    template <class RExpr_T>                                                                                                                                \
+    DMC_HDECL tImageBinaryExpr<tImageScalarExpr<typename RExpr_T::PixType>, RExpr_T, OP_T> OPERATOR(const typename RExpr_T::PixType& v,                    \
+                                                                                                   const tImageExpr<RExpr_T>& p)                           \
+    {                                                                                                                                                       \
+        return tImageBinaryExpr<tImageScalarExpr<typename RExpr_T::PixType>, RExpr_T, OP_T>(                                                               \
+            tImageScalarExpr<typename RExpr_T::PixType>(v, p.expr().w(), p.expr().h()), p.expr());                                                          \
+    }                                                                                                                                                       \
+    template <class LExpr_T>                                                                                                                                \
+    DMC_HDECL tImageBinaryExpr<LExpr_T, tImageScalarExpr<typename LExpr_T::PixType>, OP_T> OPERATOR(const tImageExpr<LExpr_T>& p,                          \
+                                                                                                   const typename LExpr_T::PixType& v)                     \
+    {                                                                                                                                                       \
+        return tImageBinaryExpr<LExpr_T, tImageScalarExpr<typename LExpr_T::PixType>, OP_T>(                                                               \
+            p.expr(), tImageScalarExpr<typename LExpr_T::PixType>(v, p.expr().w(), p.expr().h()));                                                          \
+    }
 
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator+(const tImage<Pixel_T>& p, const Pixel_T& v)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = p[i] + v;
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator-(const tImage<Pixel_T>& p, const Pixel_T& v)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = p[i] - v;
-    return r;
-}
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> operator*(const tImage<Pixel_T>& p, const Pixel_T& v)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = p[i] * v;
-    return r;
-}
+DMC_IMAGE_EXPR_BINARY_OP(operator+, tImageOpAdd)
+DMC_IMAGE_EXPR_BINARY_OP(operator-, tImageOpSub)
+DMC_IMAGE_EXPR_BINARY_OP(operator*, tImageOpMul)
+DMC_IMAGE_EXPR_BINARY_OP(operator/, tImageOpDiv) // WARNING: Be careful for divide by zero.
 
-#if 0
-// I can't remember why I commented this out. Maybe because I'm using a member version for some reason.
-template<class Pixel_T>
-DMC_HDECL tImage<Pixel_T> operator/(const tImage<Pixel_T> &p, const Pixel_T &v)
-{
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for(int i=0; i<sz; i++) r[i] = p[i] / v;
-    return r;
-}
-#endif
+#undef DMC_IMAGE_EXPR_BINARY_OP
 
 // Linearly interpolate between images p1 and p2.
 // I.e., if weight==0, returns p1. If weight==1, returns p2.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> linInterp(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2, typename Pixel_T::FloatMathType weight)
+template <class LExpr_T, class RExpr_T>
+DMC_HDECL tImageBinaryExpr<LExpr_T, RExpr_T, tImageOpLerp<typename LExpr_T::PixType::FloatMathType>>
+linInterp(const tImageExpr<LExpr_T>& p1, const tImageExpr<RExpr_T>& p2, typename LExpr_T::PixType::FloatMathType weight)
 {
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < p1.size(); i++) r[i] = linInterp(p1[i], p2[i], weight);
-    return r;
+    typedef tImageOpLerp<typename LExpr_T::PixType::FloatMathType> Op_T;
+    return tImageBinaryExpr<LExpr_T, RExpr_T, Op_T>(p1.expr(), p2.expr(), Op_T(weight));
 }
 
 // Pixel-wise max.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> Max(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
+template <class LExpr_T, class RExpr_T>
+DMC_HDECL tImageBinaryExpr<LExpr_T, RExpr_T, tImageOpMax> Max(const tImageExpr<LExpr_T>& p1, const tImageExpr<RExpr_T>& p2)
 {
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < p1.size(); i++) r[i] = Max(p1[i], p2[i]);
-    return r;
+    return tImageBinaryExpr<LExpr_T, RExpr_T, tImageOpMax>(p1.expr(), p2.expr());
 }
 
 // Pixel-wise min.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> Min(const tImage<Pixel_T>& p1, const tImage<Pixel_T>& p2)
+template <class LExpr_T, class RExpr_T>
+DMC_HDECL tImageBinaryExpr<LExpr_T, RExpr_T, tImageOpMin> Min(const tImageExpr<LExpr_T>& p1, const tImageExpr<RExpr_T>& p2)
 {
-    ASSERT_R(p1.size() == p2.size());
-    tImage<Pixel_T> r(p1.w(), p1.h());
-    int sz = p1.size();
-    for (int i = 0; i < p1.size(); i++) r[i] = Min(p1[i], p2[i]);
-    return r;
+    return tImageBinaryExpr<LExpr_T, RExpr_T, tImageOpMin>(p1.expr(), p2.expr());
 }
 
 // Pixel-wise absolute value.
-template <class Pixel_T> DMC_HDECL tImage<Pixel_T> Abs(const tImage<Pixel_T>& p)
+template <class Expr_T> DMC_HDECL tImageUnaryExpr<Expr_T, tImageOpAbs> Abs(const tImageExpr<Expr_T>& p)
 {
-    tImage<Pixel_T> r(p.w(), p.h());
-    int sz = p.size();
-    for (int i = 0; i < sz; i++) r[i] = Abs(p[i]);
-    return r;
+    return tImageUnaryExpr<Expr_T, tImageOpAbs>(p.expr());
 }
 
 // Flip this image vertically in place.
@@ -0,0 +1,210 @@
+//////////////////////////////////////////////////////////////////////
+// tImageView.h - A window onto pixels that some other object owns
+//
+// Copyright David K. McAllister, 2026.
+
+// A tImageView is a base pointer, width, height, and row pitch. It never allocates or frees pixels.
+// Make one from a whole tImage, a rectangle of a tImage, another view, or any raster in memory,
+// such as a decode buffer or a memory-mapped file. Copying a view copies the window, not the pixels.
+//
+// Views have the same w(), h(), operator()(x, y), and SetSize() interface that the image algorithms use,
+// so ConvolveImage, GaussianBlur, Resize, Downsample2x2, the ToneMap functions, and CopyRect work on them
+// in place. A view can't change size; SetSize() only checks that the algorithm wants the size it already is.
+//
+// The pixels must stay alive and unmoved for as long as the view is used.
+// Views don't carry constness. A view of a const tImage can write to it, so only pass such views as const tImageView&.
+
+#pragma once
+
+#include "Image/tImage.h"
+
+template <class Pixel_T> class tImageView {
+    Pixel_T* Base; // Pixel 0,0
+    int wid, hgt;
+    size_t pitch; // Bytes from the start of one row to the start of the next
+
+public:
+    typedef Pixel_T PixType;
+
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // An empty view.
+    tImageView() : Base(NULL), wid(0), hgt(0), pitch(0) {}
+
+    // View a raster in memory. pitchBytes of 0 means the rows are tightly packed.
+    // The pitch is in bytes so that rows padded to a multiple of some alignment can be viewed, even when it isn't a multiple of the pixel size.
+    tImageView(Pixel_T* base, const int wid_, const int hgt_, const size_t pitchBytes = 0) :
+        Base(base), wid(wid_), hgt(hgt_), pitch(pitchBytes ? pitchBytes : wid_ * sizeof(Pixel_T))
+    {
+        ASSERT_R(wid >= 0 && hgt >= 0);
+        ASSERT_R(pitch >= wid * sizeof(Pixel_T));
+        ASSERT_R(Base != NULL || size() == 0);
+    }
+
+    // View all of Img.
+    tImageView(tImage<Pixel_T>& Img) : Base(Img.size() ? Img.pp() : NULL), wid(Img.w()), hgt(Img.h()), pitch(Img.pitch_bytes()) {}
+    tImageView(const tImage<Pixel_T>& Img) :
+        Base(Img.size() ? const_cast<Pixel_T*>(Img.pp()) : NULL), wid(Img.w()), hgt(Img.h()), pitch(Img.pitch_bytes())
+    {
+    }
+
+    // View the wid_ x hgt_ rectangle of Img whose upper-left corner is x,y. The rectangle must be inside Img.
+    tImageView(tImage<Pixel_T>& Img, const int x, const int y, const int wid_, const int hgt_) { *this = tImageView(Img).Sub(x, y, wid_, hgt_); }
+    tImageView(const tImage<Pixel_T>& Img, const int x, const int y, const int wid_, const int hgt_) { *this = tImageView(Img).Sub(x, y, wid_, hgt_); }
+
+    // Return a view of the wid_ x hgt_ rectangle of this view whose upper-left corner is x,y.
+    tImageView<Pixel_T> Sub(const int x, const int y, const int wid_, const int hgt_) const
+    {
+        ASSERT_R(x >= 0 && y >= 0 && wid_ >= 0 && hgt_ >= 0 && x + wid_ <= wid && y + hgt_ <= hgt);
+        tImageView<Pixel_T> V;
+        V.Base = (wid_ && hgt_) ? const_cast<Pixel_T*>(pp(x, y)) : NULL;
+        V.wid = wid_;
+        V.hgt = hgt_;
+        V.pitch = pitch;
+        return V;
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about a pixel
+
+    static int chan() { return Pixel_T::Chan; }
+    static int size_element() { return sizeof(typename Pixel_T::ElType); }
+    static int size_pixel() { return sizeof(Pixel_T); }
+    static bool is_integer() { return Pixel_T::is_integer; }
+    static bool is_signed() { return Pixel_T::is_signed; }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about the view
+
+    int w() const { return wid; }
+    int h() const { return hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    int64_t size_els() const { return size() * chan(); }
+
+    // Bytes from the start of one row to the start of the next.
+    size_t pitch_bytes() const { return pitch; }
+
+    // True if the rows follow each other with no gaps, so the pixels are one array.
+    bool contiguous() const { return pitch == wid * sizeof(Pixel_T); }
+
+    bool empty() const { return size() < 1; }
+
+    // Views can't be resized. This lets algorithms that size their output take a view of the right size.
+    void SetSize(const int wid_, const int hgt_) const { ASSERT_RM(wid_ == wid && hgt_ == hgt, "Can't resize a tImageView"); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Access functions
+
+    // Returns a pointer to the start of row y.
+    Pixel_T* row(const int y) const
+    {
+        ASSERT_D(y >= 0 && y < h());
+        return reinterpret_cast<Pixel_T*>(reinterpret_cast<char*>(Base) + y * pitch);
+    }
+
+    const Pixel_T& operator()(const int x, const int y) const { return *pp(x, y); }
+    Pixel_T& operator()(const int x, const int y) { return *pp(x, y); }
+
+    const Pixel_T* pp(const int x, const int y) const
+    {
+        ASSERT_D(x >= 0 && x < w());
+        return row(y) + x;
+    }
+    Pixel_T* pp(const int x, const int y)
+    {
+        ASSERT_D(x >= 0 && x < w());
+        return row(y) + x;
+    }
+
+    const void* pv(const int x = 0, const int y = 0) const { return pp(x, y); }
+    void* pv(const int x = 0, const int y = 0) { return pp(x, y); }
+
+    // Paint pixel x,y if it has valid coords.
+    void Set(const Pixel_T& p, const int x, const int y)
+    {
+        if (x >= 0 && x < w() && y >= 0 && y < h()) *pp(x, y) = p;
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Utility functions
+
+    // Set every pixel in the view to p.
+    void fill(const Pixel_T p = Pixel_T(0))
+    {
+        for (int y = 0; y < hgt; y++) {
+            if (SIMDFill(row(y), wid * sizeof(Pixel_T), &p, size_pixel())) continue;
+            Pixel_T* r = row(y);
+            for (int x = 0; x < wid; x++) r[x] = p;
+        }
+    }
+
+    // Both channel-wise extrema at once.
+    void GetMinMax(Pixel_T& cmin, Pixel_T& cmax) const
+    {
+        ASSERT_R(size() > 0);
+        typedef typename Pixel_T::ElType ElT;
+        cmin = cmax = (*this)(0, 0);
+        for (int y = 0; y < hgt; y++) {
+            const Pixel_T* r = row(y);
+            Pixel_T rmin, rmax;
+            if (sizeof(Pixel_T) == sizeof(ElT) * Pixel_T::Chan &&
+                SIMDMinMax(reinterpret_cast<const ElT*>(r), size_t(wid) * chan(), chan(), reinterpret_cast<ElT*>(&rmin), reinterpret_cast<ElT*>(&rmax))) {
+                cmin = Min(cmin, rmin);
+                cmax = Max(cmax, rmax);
+                continue;
+            }
+            for (int x = 0; x < wid; x++) {
+                cmin = Min(cmin, r[x]);
+                cmax = Max(cmax, r[x]);
+            }
+        }
+    }
+
+    // Min over all pixels for each channel.
+    Pixel_T min_chan() const
+    {
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
+        return cmin;
+    }
+
+    // Max over all pixels for each channel.
+    Pixel_T max_chan() const
+    {
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
+        return cmax;
+    }
+
+    // Copy the pixels of this view into a new image.
+    tImage<Pixel_T> Copy() const
+    {
+        tImage<Pixel_T> Img(wid, hgt);
+        for (int y = 0; y < hgt; y++)
+            for (int x = 0; x < wid; x++) Img(x, y) = (*this)(x, y);
+        return Img;
+    }
+};
+
+#ifdef DMC_USE_HALF_FLOAT
+typedef tImageView<h1Pixel> h1ImageView;
+typedef tImageView<h2Pixel> h2ImageView;
+typedef tImageView<h3Pixel> h3ImageView;
+typedef tImageView<h4Pixel> h4ImageView;
+#endif
+
+typedef tImageView<f1Pixel> f1ImageView;
+typedef tImageView<f2Pixel> f2ImageView;
+typedef tImageView<f3Pixel> f3ImageView;
+typedef tImageView<f4Pixel> f4ImageView;
+
+typedef tImageView<uc1Pixel> uc1ImageView;
+typedef tImageView<uc2Pixel> uc2ImageView;
+typedef tImageView<uc3Pixel> uc3ImageView;
+typedef tImageView<uc4Pixel> uc4ImageView;
+
+typedef tImageView<us1Pixel> us1ImageView;
+typedef tImageView<us2Pixel> us2ImageView;
+typedef tImageView<us3Pixel> us3ImageView;
+typedef tImageView<us4Pixel> us4ImageView;
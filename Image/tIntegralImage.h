@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////
+// tIntegralImage.h - A summed-area table for constant-time rectangle sums
+//
+// Copyright David K. McAllister, 2026.
+
+// Entry x,y of a tIntegralImage is the channel-wise sum of all pixels of the source image above and to the left of x,y,
+// so the sum over any rectangle is four lookups no matter its size. Box filters, local means and variances, and
+// adaptive thresholds can then be computed without rescanning the pixels under each window.
+//
+// Sums are accumulated in int64_t for integer pixels, which is exact, and in double for float and half pixels.
+// The table has a row and column of zeros before the image, so it is (w+1) x (h+1) entries of Chan accumulators.
+// If built with squares, a second table holds the sums of the squared elements, for variances.
+//
+// The build is a parallel prefix sum: each row is summed on its own, then bands of columns are summed down the rows.
+
+#pragma once
+
+#include "Image/ImageConvert.h"
+#include "Image/tImage.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+template <class Pixel_T> class tIntegralImage {
+public:
+    typedef Pixel_T PixType;
+    typedef typename std::conditional<Pixel_T::is_integer, int64_t, double>::type AccType;
+    typedef std::array<AccType, Pixel_T::Chan> SumType;
+
+    // A rectangle of w x h pixels with upper-left corner x,y
+    struct Rect {
+        int x, y, w, h;
+    };
+
+private:
+    static const int Chan = Pixel_T::Chan;
+
+    std::vector<AccType> Sums, SqSums; // (wid + 1) x (hgt + 1) entries of Chan accumulators each
+    int wid, hgt;
+
+    size_t ind(const int x, const int y) const { return (size_t(y) * (wid + 1) + x) * Chan; }
+
+    // Replace each row of the table, which holds its own row's prefix sums, by the sum of it and all rows above it.
+    static void sumColumns(std::vector<AccType>& T, const int wid, const int hgt)
+    {
+        const size_t rowEls = size_t(wid + 1) * Chan;
+        const int BandEls = 1024;
+        const int numBands = int((rowEls + BandEls - 1) / BandEls);
+        ParallelForRanges(numBands, std::max(1, ConvertParallelPixels / (hgt * BandEls)), [&](const int b0, const int b1) {
+            const size_t e0 = b0 * size_t(BandEls), e1 = std::min(rowEls, b1 * size_t(BandEls));
+            for (int y = 2; y <= hgt; y++) {
+                AccType* r = T.data() + y * rowEls;
+                const AccType* p = r - rowEls;
+                for (size_t e = e0; e < e1; e++) r[e] += p[e];
+            }
+        });
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    tIntegralImage() : wid(0), hgt(0) {}
+
+    // Build from Img, which may be any image type with this pixel type. If withSquares, also sum the squared elements.
+    template <class Image_T> explicit tIntegralImage(const Image_T& Img, const bool withSquares = false) : wid(0), hgt(0) { Build(Img, withSquares); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about the image
+
+    static int chan() { return Chan; }
+    int w() const { return wid; }
+    int h() const { return hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    bool empty() const { return size() < 1; }
+    bool hasSquares() const { return !SqSums.empty(); }
+
+    void clear()
+    {
+        Sums.clear();
+        SqSums.clear();
+        wid = hgt = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Building
+
+    // Sum Img, which may be any image type with this pixel type. If withSquares, also sum the squared elements.
+    template <class Image_T> void Build(const Image_T& Img, const bool withSquares = false)
+    {
+        wid = Img.w();
+        hgt = Img.h();
+        const size_t rowEls = size_t(wid + 1) * Chan;
+        Sums.assign(rowEls * (hgt + 1), AccType(0));
+        if (withSquares)
+            SqSums.assign(rowEls * (hgt + 1), AccType(0));
+        else
+            SqSums.clear();
+        if (empty()) return;
+
+        // Row prefix sums
+        ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / wid), [&](const int y0, const int y1) {
+            for (int y = y0; y < y1; y++) {
+                AccType* r = Sums.data() + ind(0, y + 1);
+                AccType* q = withSquares ? SqSums.data() + ind(0, y + 1) : nullptr;
+                AccType run[Chan] = {}, runSq[Chan] = {};
+                for (int x = 0; x < wid; x++) {
+                    const Pixel_T& p = Img(x, y);
+                    for (int c = 0; c < Chan; c++) {
+                        const AccType v = static_cast<AccType>(p[c]);
+                        run[c] += v;
+                        r[(x + 1) * Chan + c] = run[c];
+                        if (q) {
+                            runSq[c] += v * v;
+                            q[(x + 1) * Chan + c] = runSq[c];
+                        }
+                    }
+                }
+            }
+        });
+
+        sumColumns(Sums, wid, hgt);
+        if (withSquares) sumColumns(SqSums, wid, hgt);
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Queries
+
+    // Channel-wise sum of the pixels in the rectangle, clipped to the image. With squares, the sum of their squared elements.
+    SumType RectSum(const int x, const int y, const int w, const int h, const bool squares = false) const
+    {
+        ASSERT_D(!squares || hasSquares());
+        const std::vector<AccType>& T = squares ? SqSums : Sums;
+        const int x0 = std::clamp(x, 0, wid), x1 = std::clamp(x + w, 0, wid);
+        const int y0 = std::clamp(y, 0, hgt), y1 = std::clamp(y + h, 0, hgt);
+        SumType S;
+        if (x1 <= x0 || y1 <= y0) {
+            S.fill(AccType(0));
+            return S;
+        }
+        const AccType *a = &T[ind(x0, y0)], *b = &T[ind(x1, y0)], *c = &T[ind(x0, y1)], *d = &T[ind(x1, y1)];
+        for (int k = 0; k < Chan; k++) S[k] = d[k] - b[k] - c[k] + a[k];
+        return S;
+    }
+    SumType RectSum(const Rect& R, const bool squares = false) const { return RectSum(R.x, R.y, R.w, R.h, squares); }
+
+    // Number of image pixels in the rectangle, after clipping
+    int64_t RectArea(const int x, const int y, const int w, const int h) const
+    {
+        const int64_t cw = std::max(0, std::clamp(x + w, 0, wid) - std::clamp(x, 0, wid));
+        const int64_t ch = std::max(0, std::clamp(y + h, 0, hgt) - std::clamp(y, 0, hgt));
+        return cw * ch;
+    }
+
+    // Channel-wise mean of the pixels in the rectangle, clipped to the image. Zero if the clipped rectangle is empty.
+    std::array<double, Pixel_T::Chan> RectMean(const int x, const int y, const int w, const int h) const
+    {
+        const SumType S = RectSum(x, y, w, h);
+        const int64_t n = RectArea(x, y, w, h);
+        std::array<double, Chan> M;
+        for (int c = 0; c < Chan; c++) M[c] = n ? double(S[c]) / double(n) : 0.0;
+        return M;
+    }
+
+    // Channel-wise population variance of the pixels in the rectangle, clipped to the image. Requires squares.
+    std::array<double, Pixel_T::Chan> RectVariance(const int x, const int y, const int w, const int h) const
+    {
+        ASSERT_R(hasSquares());
+        const SumType S = RectSum(x, y, w, h), Q = RectSum(x, y, w, h, true);
+        const int64_t n = RectArea(x, y, w, h);
+        std::array<double, Chan> V;
+        for (int c = 0; c < Chan; c++) {
+            const double m = n ? double(S[c]) / double(n) : 0.0;
+            V[c] = n ? std::max(0.0, double(Q[c]) / double(n) - m * m) : 0.0;
+        }
+        return V;
+    }
+
+    // Out[i] = RectSum(Rects[i], squares) for n rectangles, split across threads when there are many.
+    void RectSums(SumType* Out, const Rect* Rects, const int n, const bool squares = false) const
+    {
+        ParallelForRanges(n, ConvertParallelPixels, [&](const int i0, const int i1) {
+            for (int i = i0; i < i1; i++) Out[i] = RectSum(Rects[i], squares);
+        });
+    }
+    std::vector<SumType> RectSums(const std::vector<Rect>& Rects, const bool squares = false) const
+    {
+        std::vector<SumType> Out(Rects.size());
+        RectSums(Out.data(), Rects.data(), int(Rects.size()), squares);
+        return Out;
+    }
+};
+
+typedef tIntegralImage<f1Pixel> f1IntegralImage;
+typedef tIntegralImage<f3Pixel> f3IntegralImage;
+typedef tIntegralImage<f4Pixel> f4IntegralImage;
+
+typedef tIntegralImage<uc1Pixel> uc1IntegralImage;
+typedef tIntegralImage<uc3Pixel> uc3IntegralImage;
+typedef tIntegralImage<uc4Pixel> uc4IntegralImage;
+
+typedef tIntegralImage<us1Pixel> us1IntegralImage;
+typedef tIntegralImage<us3Pixel> us3IntegralImage;
+typedef tIntegralImage<us4Pixel> us4IntegralImage;
@@ -53,9 +53,9 @@ template <class Pixel_T> void tImage<Pixel_T>::Load(const std::string& fname, Lo
     baseImage* base = loader.baseImg;
 
     if (typeid(*base) == typeid(tImage<Pixel_T>)) {
-        // Don't call the operator= if the types match. Instead shallow copy the tImage class, including the Pix pointer.
-        SetImage(static_cast<PixType*>(base->pv_virtual()), base->w_virtual(), base->h_virtual(), true);
-        base->ownPix_virtual(false); // Prepare to detach Pix from base, rather than delete [] it.
+        // Don't call the operator= if the types match. Instead take the loaded raster and leave our empty one in base.
+        // Swapping rather than SetImage() keeps track of how the raster was allocated so it gets freed the same way.
+        swap(*static_cast<tImage<Pixel_T>*>(base));
     } else {
         // Convert from the type of the loaded image to type of this.
         if (f1Image* loadedImg = dynamic_cast<f1Image*>(base)) { *this = *loadedImg; }
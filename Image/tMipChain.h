@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////
+// tMipChain.h - All the MIP levels of an image in one allocation
+//
+// Copyright David K. McAllister, 2026.
+
+// A tMipChain holds level 0, a copy of the source image, and every level below it down to 1 x 1, each made by box
+// filtering the one above it two to one exactly like Downsample2x2. Sizes need not be powers of two: a level of odd
+// size is (1 + w) / 2 wide, and its last column and row average two pixels or one instead of four.
+//
+// The levels are packed one after another in a single array, so building a chain is one allocation, and level(k)
+// returns a tImageView of level k to hand to any algorithm that takes a view.
+//
+// Build() is one pass over the source. Each pair of source rows is copied into level 0 and box filtered into a row of
+// level 1 while still in cache, and each completed pair of rows of a level is filtered into the level below right away,
+// so the source is read once and the smaller levels are made from rows that were just written. Bands of rows run on
+// multiple threads, each band making its rows of the first several levels, and the few remaining small levels are made
+// serially after that.
+//
+// If isSRGB, the color channels are averaged in linear light, not the encoded values, and rounded back to sRGB; alpha
+// is averaged as is and rounded. Otherwise the arithmetic is Downsample2x2's, so level k is bit for bit the same as
+// calling Downsample2x2 k times.
+
+#pragma once
+
+#include "Image/ImageConvert.h"
+#include "Image/tImage.h"
+#include "Image/tImageView.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+#include <vector>
+
+template <class Pixel_T> class tMipChain {
+public:
+    typedef Pixel_T PixType;
+    typedef tImageView<Pixel_T> ViewType;
+
+private:
+    typedef typename Pixel_T::MathPixType MPT;
+    typedef typename Pixel_T::MathType MT;
+    typedef tPixel<float, Pixel_T::Chan> FPixel_T;
+
+    std::vector<Pixel_T> Pix;    // All the levels, level 0 first
+    std::vector<size_t> Offsets; // Index in Pix of pixel 0,0 of each level
+    std::vector<int> Wids, Hgts; // Size of each level
+    bool SRGB;
+
+    // Float rows for filtering in linear light, one set per thread
+    struct LinearRows {
+        std::vector<FPixel_T> R0, R1, D;
+    };
+
+    Pixel_T* levelRow(const int k, const int y) { return &Pix[Offsets[k] + size_t(y) * Wids[k]]; }
+
+    // Box filter rows r0 and r1, or just r0 if r1 is NULL, of a level w0 wide into row d of the level below.
+    static void filterRows(Pixel_T* d, const Pixel_T* r0, const Pixel_T* r1, const int w0)
+    {
+        const int ws = w0 / 2, w1 = (w0 + 1) / 2;
+        if (r1) {
+            for (int x = 0; x < ws; x++)
+                d[x] = (static_cast<MPT>(r0[2 * x]) + static_cast<MPT>(r0[2 * x + 1]) + static_cast<MPT>(r1[2 * x]) + static_cast<MPT>(r1[2 * x + 1])) /
+                    static_cast<MT>(4);
+            if (w1 != ws) d[ws] = (static_cast<MPT>(r0[2 * ws]) + static_cast<MPT>(r1[2 * ws])) / static_cast<MT>(2);
+        } else {
+            for (int x = 0; x < ws; x++) d[x] = (static_cast<MPT>(r0[2 * x]) + static_cast<MPT>(r0[2 * x + 1])) / static_cast<MT>(2);
+            if (w1 != ws) d[ws] = r0[2 * ws];
+        }
+    }
+
+    // The same in linear light. The pixels are decoded to float, averaged, and encoded with rounding.
+    static void filterRowsLinear(Pixel_T* d, const Pixel_T* r0, const Pixel_T* r1, const int w0, LinearRows& L)
+    {
+        const int ws = w0 / 2, w1 = (w0 + 1) / 2;
+        L.R0.resize(w0);
+        L.R1.resize(w0);
+        L.D.resize(w1);
+        ConvertPixels(L.R0.data(), r0, w0, XFER_SRGB_TO_LINEAR);
+        if (r1) ConvertPixels(L.R1.data(), r1, w0, XFER_SRGB_TO_LINEAR);
+        const FPixel_T *a = L.R0.data(), *b = r1 ? L.R1.data() : L.R0.data();
+        for (int x = 0; x < ws; x++) L.D[x] = (a[2 * x] + a[2 * x + 1] + b[2 * x] + b[2 * x + 1]) * 0.25f;
+        if (w1 != ws) L.D[ws] = (a[2 * ws] + b[2 * ws]) * 0.5f;
+
+        // The sRGB encoding rounds the color channels, but the alpha conversion truncates, so round it here.
+        const int AlphaC = AlphaChan<Pixel_T>();
+        if (AlphaC >= 0 && element_traits<typename Pixel_T::ElType>::normalized) {
+            const float rnd = 0.5f / float(element_traits<typename Pixel_T::ElType>::one());
+            for (int x = 0; x < w1; x++) L.D[x][AlphaC] += rnd;
+        }
+        ConvertPixels(d, L.D.data(), w1, XFER_LINEAR_TO_SRGB);
+    }
+
+    // Make row y of level k from level k - 1. If that finishes a pair of rows, or the last row, make the row below it
+    // in level k + 1, and so on down to level kMax.
+    void makeRow(const int k, const int y, const int kMax, LinearRows& L)
+    {
+        const int y0 = 2 * y, y1 = 2 * y + 1;
+        const Pixel_T* r0 = levelRow(k - 1, y0);
+        const Pixel_T* r1 = y1 < Hgts[k - 1] ? levelRow(k - 1, y1) : nullptr;
+        if (SRGB)
+            filterRowsLinear(levelRow(k, y), r0, r1, Wids[k - 1], L);
+        else
+            filterRows(levelRow(k, y), r0, r1, Wids[k - 1]);
+
+        if (k < kMax && ((y & 1) || y == Hgts[k] - 1)) makeRow(k + 1, y >> 1, kMax, L);
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    tMipChain() : SRGB(false) {}
+
+    // Build the chain of Img, which may be any image type with this pixel type.
+    template <class Image_T> explicit tMipChain(const Image_T& Img, const bool isSRGB = false) : SRGB(false) { Build(Img, isSRGB); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about the chain
+
+    // Number of levels, including level 0. Zero if empty.
+    int levels() const { return int(Wids.size()); }
+    int w(const int k = 0) const { return Wids[k]; }
+    int h(const int k = 0) const { return Hgts[k]; }
+    bool empty() const { return Wids.empty(); }
+    bool isSRGB() const { return SRGB; }
+
+    // Pixels in all the levels
+    size_t size() const { return Pix.size(); }
+
+    void clear()
+    {
+        Pix.clear();
+        Offsets.clear();
+        Wids.clear();
+        Hgts.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Access functions
+
+    // Level k as a view into the chain. Views don't carry constness, so don't write through the view of a const chain.
+    ViewType level(const int k) const
+    {
+        ASSERT_D(k >= 0 && k < levels());
+        return ViewType(const_cast<Pixel_T*>(&Pix[Offsets[k]]), Wids[k], Hgts[k]);
+    }
+
+    const Pixel_T& operator()(const int x, const int y, const int k) const { return Pix[Offsets[k] + size_t(y) * Wids[k] + x]; }
+    Pixel_T& operator()(const int x, const int y, const int k) { return Pix[Offsets[k] + size_t(y) * Wids[k] + x]; }
+
+    //////////////////////////////////////////////////////////////////////
+    // Building
+
+    // Make all the levels of Img, which may be any image type with this pixel type.
+    template <class Image_T> void Build(const Image_T& Img, const bool isSRGB = false)
+    {
+        clear();
+        SRGB = isSRGB;
+        if (Img.w() < 1 || Img.h() < 1) return;
+
+        size_t total = 0;
+        for (int wk = Img.w(), hk = Img.h();; wk = (wk + 1) / 2, hk = (hk + 1) / 2) {
+            Offsets.push_back(total);
+            Wids.push_back(wk);
+            Hgts.push_back(hk);
+            total += size_t(wk) * hk;
+            if (wk == 1 && hk == 1) break;
+        }
+        Pix.resize(total);
+
+        const int L = levels() - 1, w0 = Img.w(), h0 = Img.h();
+        if (L == 0) {
+            Pix[0] = Img(0, 0);
+            return;
+        }
+
+        // Each band is 2^kPar source rows, which makes one row of level kPar, so the bands are independent down to there.
+        int kPar = 1;
+        while (kPar < L && (int64_t(w0) << kPar) < ConvertParallelPixels) kPar++;
+        const int bandRows1 = 1 << (kPar - 1); // Rows of level 1 per band
+
+        ParallelForRanges((Hgts[1] + bandRows1 - 1) / bandRows1, 1, [&](const int b0, const int b1) {
+            LinearRows Lin;
+            for (int y = b0 * bandRows1; y < std::min(Hgts[1], b1 * bandRows1); y++) {
+                for (int sy = 2 * y; sy < std::min(2 * y + 2, h0); sy++) {
+                    Pixel_T* d = levelRow(0, sy);
+                    for (int x = 0; x < w0; x++) d[x] = Img(x, sy);
+                }
+                makeRow(1, y, kPar, Lin);
+            }
+        });
+
+        LinearRows Lin;
+        if (kPar < L)
+            for (int y = 0; y < Hgts[kPar + 1]; y++) makeRow(kPar + 1, y, L, Lin);
+    }
+};
+
+typedef tMipChain<f1Pixel> f1MipChain;
+typedef tMipChain<f3Pixel> f3MipChain;
+typedef tMipChain<f4Pixel> f4MipChain;
+
+typedef tMipChain<h3Pixel> h3MipChain;
+typedef tMipChain<h4Pixel> h4MipChain;
+
+typedef tMipChain<uc1Pixel> uc1MipChain;
+typedef tMipChain<uc3Pixel> uc3MipChain;
+typedef tMipChain<uc4Pixel> uc4MipChain;
+
+typedef tMipChain<us1Pixel> us1MipChain;
+typedef tMipChain<us3Pixel> us3MipChain;
+typedef tMipChain<us4Pixel> us4MipChain;
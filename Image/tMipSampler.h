@@ -0,0 +1,197 @@
+//////////////////////////////////////////////////////////////////////
+// tMipSampler.h - Filtered texture lookups into a tMipChain
+//
+// Copyright David K. McAllister, 2026.
+
+// sample1, sample2, and sample4 read one level of one image, so a lookup whose footprint covers many texels aliases.
+// A tMipSampler samples a tMipChain with a footprint given by the screen-space derivatives of the texture coordinates,
+// the way a GPU does:
+// - TEX_BILINEAR reads level 0 only.
+// - TEX_TRILINEAR picks the level where the longer side of the footprint is about a texel and blends the two nearest levels.
+// - TEX_ANISOTROPIC picks the level from the shorter side instead and takes up to MaxAniso trilinear probes along the
+//   longer side, weighted by a Gaussian, which approximates an elliptical weighted average (EWA) over the footprint.
+//
+// Texture coordinates are normalized: u and v run from 0 to 1 across the texture, and texel i of a level n texels wide is
+// centered at (i + 0.5) / n. Derivatives are in the same units. Each axis clamps, repeats, or mirrors outside 0..1.
+// Results are float pixels. If the chain is sRGB, texels are decoded to linear before filtering, so results are linear.
+//
+// The batched Sample() takes structure-of-arrays coordinates, as a ray tracer would gather them. It works through them in
+// blocks, first computing the level and probe axis of every sample in the block in one flat loop over the derivative
+// arrays, then filtering, and splits large batches across threads.
+
+#pragma once
+
+#include "Image/ImageConvert.h"
+#include "Image/tMipChain.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+enum TexFilter_e { TEX_BILINEAR, TEX_TRILINEAR, TEX_ANISOTROPIC };
+enum TexWrap_e { TEX_CLAMP, TEX_REPEAT, TEX_MIRROR };
+
+template <class Pixel_T> class tMipSampler {
+public:
+    typedef Pixel_T PixType;
+    typedef tPixel<float, Pixel_T::Chan> FPixel_T;
+
+private:
+    typedef typename Pixel_T::ElType Elem_T;
+    static constexpr int Block = 64; // Samples per block of the batched Sample()
+
+    const tMipChain<Pixel_T>& Chain;
+    TexFilter_e Filter;
+    TexWrap_e WrapU, WrapV;
+    int MaxAniso;
+    float MaxLod;
+    const float *ColorLut, *AlphaLut; // Decoding tables for unsigned char texels
+
+    // The level of detail and probe layout of one sample
+    struct Footprint {
+        float lod;    // Level to sample, with the fraction blending to the next one
+        float au, av; // Step in u,v between probes
+        int n;        // Number of probes
+    };
+
+    static DMC_DECL int wrap(const int i, const int n, const TexWrap_e mode)
+    {
+        if (mode == TEX_CLAMP) return std::clamp(i, 0, n - 1);
+        if (mode == TEX_REPEAT) {
+            const int m = i % n;
+            return m < 0 ? m + n : m;
+        }
+        int m = i % (2 * n);
+        if (m < 0) m += 2 * n;
+        return m < n ? m : 2 * n - 1 - m;
+    }
+
+    DMC_DECL FPixel_T texel(const int x, const int y, const int k) const
+    {
+        const Pixel_T& p = Chain(x, y, k);
+        FPixel_T f;
+        const int AlphaC = AlphaChan<Pixel_T>();
+        if constexpr (std::is_same<Elem_T, unsigned char>::value) {
+            for (int c = 0; c < Pixel_T::Chan; c++) f[c] = (c == AlphaC ? AlphaLut : ColorLut)[p[c]];
+        } else {
+            for (int c = 0; c < Pixel_T::Chan; c++) {
+                basePixel::channel_cast(f[c], p[c]);
+                if (Chain.isSRGB() && c != AlphaC) f[c] = SRGBToLinear(f[c]);
+            }
+        }
+        return f;
+    }
+
+    DMC_DECL FPixel_T bilinear(const float u, const float v, const int k) const
+    {
+        const int w = Chain.w(k), h = Chain.h(k);
+        const float x = u * w - 0.5f, y = v * h - 0.5f;
+        const float fx = floorf(x), fy = floorf(y);
+        const float tx = x - fx, ty = y - fy;
+        const int x0 = wrap(int(fx), w, WrapU), x1 = wrap(int(fx) + 1, w, WrapU);
+        const int y0 = wrap(int(fy), h, WrapV), y1 = wrap(int(fy) + 1, h, WrapV);
+        const FPixel_T a = texel(x0, y0, k), b = texel(x1, y0, k), c = texel(x0, y1, k), d = texel(x1, y1, k);
+        const FPixel_T top = a + (b - a) * tx, bot = c + (d - c) * tx;
+        return top + (bot - top) * ty;
+    }
+
+    DMC_DECL FPixel_T trilinear(const float u, const float v, const float lod) const
+    {
+        const int k = int(lod);
+        const float t = lod - float(k);
+        const FPixel_T p = bilinear(u, v, k);
+        if (t <= 0.f || k + 1 >= Chain.levels()) return p;
+        return p + (bilinear(u, v, k + 1) - p) * t;
+    }
+
+    // The footprint of a sample with derivatives dudx ... dvdy, measured in level 0 texels
+    DMC_DECL Footprint footprint(const float dudx, const float dvdx, const float dudy, const float dvdy) const
+    {
+        const float W = float(Chain.w(0)), H = float(Chain.h(0));
+        const float lx = (dudx * W) * (dudx * W) + (dvdx * H) * (dvdx * H);
+        const float ly = (dudy * W) * (dudy * W) + (dvdy * H) * (dvdy * H);
+        Footprint F;
+        F.au = F.av = 0.f;
+        F.n = 1;
+        if (Filter == TEX_BILINEAR) {
+            F.lod = 0.f;
+        } else if (Filter == TEX_TRILINEAR) {
+            F.lod = 0.5f * log2f(std::max(std::max(lx, ly), 1.f));
+        } else {
+            const bool xMajor = lx >= ly;
+            const float major = sqrtf(xMajor ? lx : ly), minor = sqrtf(xMajor ? ly : lx);
+            F.n = std::clamp(int(ceilf(major / std::max(minor, 1e-8f))), 1, MaxAniso);
+            F.lod = log2f(std::max(major / float(F.n), 1.f));
+            if (F.n > 1) {
+                const float s = 1.f / float(F.n);
+                F.au = (xMajor ? dudx : dudy) * s;
+                F.av = (xMajor ? dvdx : dvdy) * s;
+            }
+        }
+        F.lod = std::min(F.lod, MaxLod);
+        return F;
+    }
+
+    // Filter one sample at u,v with footprint F. The probes are spaced evenly across the major axis of the footprint
+    // and weighted by exp(-2 r^2), where r runs from -1 to 1 along it.
+    DMC_DECL FPixel_T filter(const float u, const float v, const Footprint& F) const
+    {
+        if (F.n == 1) return trilinear(u, v, F.lod);
+
+        FPixel_T sum(0.f);
+        float wsum = 0.f;
+        for (int i = 0; i < F.n; i++) {
+            const float t = float(i) - 0.5f * float(F.n - 1); // Probe offset in steps from the center
+            const float r = 2.f * t / float(F.n);
+            const float w = expf(-2.f * r * r);
+            sum += trilinear(u + t * F.au, v + t * F.av, F.lod) * w;
+            wsum += w;
+        }
+        return sum / wsum;
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // Sample Chain, which must outlive the sampler and not be rebuilt while it is used.
+    tMipSampler(const tMipChain<Pixel_T>& Chain_, const TexFilter_e Filter_ = TEX_TRILINEAR, const TexWrap_e WrapU_ = TEX_REPEAT,
+                const TexWrap_e WrapV_ = TEX_REPEAT, const int MaxAniso_ = 16) :
+        Chain(Chain_), Filter(Filter_), WrapU(WrapU_), WrapV(WrapV_), MaxAniso(std::max(MaxAniso_, 1))
+    {
+        ASSERT_R(!Chain.empty());
+        MaxLod = float(Chain.levels() - 1);
+        if constexpr (std::is_same<Elem_T, unsigned char>::value) {
+            ColorLut = ByteConvertLUT<float>(Chain.isSRGB() ? XFER_SRGB_TO_LINEAR : XFER_NONE);
+            AlphaLut = ByteConvertLUT<float>(XFER_NONE);
+        } else {
+            ColorLut = AlphaLut = nullptr;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Sampling
+
+    // Sample at u,v with the screen-space derivatives of u and v in x and y.
+    FPixel_T Sample(const float u, const float v, const float dudx, const float dvdx, const float dudy, const float dvdy) const
+    {
+        return filter(u, v, footprint(dudx, dvdx, dudy, dvdy));
+    }
+
+    // Sample at u,v at level of detail lod, blending levels floor(lod) and floor(lod) + 1 trilinearly.
+    FPixel_T SampleLevel(const float u, const float v, const float lod) const { return trilinear(u, v, std::clamp(lod, 0.f, MaxLod)); }
+
+    // Out[i] = Sample(u[i], v[i], dudx[i], dvdx[i], dudy[i], dvdy[i]) for n samples.
+    void Sample(FPixel_T* Out, const float* u, const float* v, const float* dudx, const float* dvdx, const float* dudy, const float* dvdy, const int n) const
+    {
+        ParallelForRanges(n, ConvertParallelPixels / 16, [&](const int i0, const int i1) {
+            Footprint F[Block];
+            for (int b = i0; b < i1; b += Block) {
+                const int m = std::min(Block, i1 - b);
+                for (int j = 0; j < m; j++) F[j] = footprint(dudx[b + j], dvdx[b + j], dudy[b + j], dvdy[b + j]);
+                for (int j = 0; j < m; j++) Out[b + j] = filter(u[b + j], v[b + j], F[j]);
+            }
+        });
+    }
+};
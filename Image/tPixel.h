@@ -83,10 +83,31 @@ template <> DMC_DECL void mult_asgn<unsigned char>(unsigned char& a, const unsig
 
 template <> DMC_DECL void mult_asgn<unsigned short>(unsigned short& a, const unsigned short& b)
 {
-    int t = int(a) * int(b) + 0x8000;
+    unsigned int t = (unsigned int)(a) * (unsigned int)(b) + 0x8000; // Doesn't fit in an int
     a = (unsigned short)(((t >> 16) + t) >> 16);
 }
 
+// Addition and subtraction saturate for the normalized unsigned types, so that white + anything stays white.
+// The SIMD image kernels in ImageKernels.cpp match these exactly.
+template <class Elem_T> DMC_DECL void add_asgn(Elem_T& a, const Elem_T& b) { a += b; }
+template <class Elem_T> DMC_DECL void sub_asgn(Elem_T& a, const Elem_T& b) { a -= b; }
+
+template <> DMC_DECL void add_asgn<unsigned char>(unsigned char& a, const unsigned char& b)
+{
+    int t = int(a) + int(b);
+    a = (unsigned char)(t > 0xff ? 0xff : t);
+}
+
+template <> DMC_DECL void sub_asgn<unsigned char>(unsigned char& a, const unsigned char& b) { a = (unsigned char)(a > b ? a - b : 0); }
+
+template <> DMC_DECL void add_asgn<unsigned short>(unsigned short& a, const unsigned short& b)
+{
+    int t = int(a) + int(b);
+    a = (unsigned short)(t > 0xffff ? 0xffff : t);
+}
+
+template <> DMC_DECL void sub_asgn<unsigned short>(unsigned short& a, const unsigned short& b) { a = (unsigned short)(a > b ? a - b : 0); }
+
 // Using basePixel has the problem that it can only be used with these six data types unless you change this class.
 class basePixel {
 public:
@@ -107,8 +128,10 @@ public:
             d = static_cast<Out_T>(s);
         else if constexpr (element_traits<In_T>::normalized && element_traits<Out_T>::floating_point) // Normalized int to float (non-normalized): Scale
             d = static_cast<Out_T>(s / static_cast<typename element_traits<Out_T>::FloatMathType>(element_traits<In_T>::one()));
-        else if constexpr (element_traits<In_T>::floating_point && element_traits<Out_T>::normalized) // float (non-normalized) to normalized int: Scale and Clamp
-            d = static_cast<Out_T>(clamp<In_T>(s * static_cast<In_T>(element_traits<Out_T>::one()), 0, static_cast<In_T>(element_traits<Out_T>::one())));
+        else if constexpr (element_traits<In_T>::floating_point && element_traits<Out_T>::normalized) { // float (non-normalized) to normalized int: Scale and Clamp
+            typedef typename element_traits<In_T>::FloatMathType F; // Not half, which can't hold 65535
+            d = static_cast<Out_T>(clamp<F>(static_cast<F>(s) * static_cast<F>(element_traits<Out_T>::one()), 0, static_cast<F>(element_traits<Out_T>::one())));
+        }
         else {           // both are normalized and integer: Complicated shift. Use specializations.
             ASSERT_R(0); // Should only arrive here with signed ints. Not yet implemented.
         }
@@ -157,7 +180,11 @@ public:
     }
 };
 
-template <> DMC_DECL void basePixel::channel_cast(unsigned char& d, const unsigned short& s) { d = ((s >> 7) + 1) >> 1; }
+template <> DMC_DECL void basePixel::channel_cast(unsigned char& d, const unsigned short& s)
+{
+    const int t = ((s >> 7) + 1) >> 1; // Rounds 0xff80 and up to 256
+    d = (unsigned char)(t > 0xff ? 0xff : t);
+}
 template <> DMC_DECL void basePixel::channel_cast(unsigned short& d, const unsigned char& s)
 {
     unsigned short t = s;
@@ -325,12 +352,12 @@ public:
 
     tPixel<Elem_T, Chan_>& operator+=(const tPixel<Elem_T, Chan_>& p)
     {
-        for (int i = 0; i < Chan_; i++) els[i] += p[i];
+        for (int i = 0; i < Chan_; i++) add_asgn(els[i], p[i]);
         return *this;
     }
     tPixel<Elem_T, Chan_>& operator-=(const tPixel<Elem_T, Chan_>& p)
     {
-        for (int i = 0; i < Chan_; i++) els[i] -= p[i];
+        for (int i = 0; i < Chan_; i++) sub_asgn(els[i], p[i]);
         return *this;
     }
     tPixel<Elem_T, Chan_>& operator*=(const tPixel<Elem_T, Chan_>& p)
@@ -349,12 +376,12 @@ public:
 
     tPixel<Elem_T, Chan_>& operator+=(const Elem_T s)
     {
-        for (int i = 0; i < Chan_; i++) els[i] += s;
+        for (int i = 0; i < Chan_; i++) add_asgn(els[i], s);
         return *this;
     }
     tPixel<Elem_T, Chan_>& operator-=(const Elem_T s)
     {
-        for (int i = 0; i < Chan_; i++) els[i] -= s;
+        for (int i = 0; i < Chan_; i++) sub_asgn(els[i], s);
         return *this;
     }
     tPixel<Elem_T, Chan_>& operator*=(const Elem_T s)
@@ -0,0 +1,234 @@
+//////////////////////////////////////////////////////////////////////
+// tPlanarImage.h - An image stored as one plane per channel
+//
+// Copyright David K. McAllister, 2026.
+
+// A tImage stores its channels interleaved, so an operation on one channel, or with a different constant for each channel,
+// strides through memory and drags the other channels through the cache. A tPlanarImage stores each channel contiguously
+// as its own one-channel tImage, so per-channel loops read a flat array of elements and the SIMD kernels in ImageKernels.h
+// run on it at full width with no channel pattern.
+//
+// Each plane is a tImage, so planes are allocated on a RasterAlign boundary, may have padded rows, and are moved and
+// shared copy-on-write just like any tImage. plane(c) returns channel c as a tImage to hand to any one-channel algorithm.
+//
+// FromImage() and ToImage() deinterleave from and interleave to a tImage or tImageView, splitting the rows across threads
+// when the image is large. operator()(x, y) gathers a pixel from the planes and returns it by value, so pixels are written
+// with Set() or through the planes. The algorithms in ImageAlgorithms.h that have tPlanarImage overloads run plane by plane.
+
+#pragma once
+
+#include "Image/ImageConvert.h"
+#include "Image/tImage.h"
+#include "Util/ParallelFor.h"
+
+#include <algorithm>
+
+template <class Pixel_T> class tPlanarImage {
+public:
+    typedef Pixel_T PixType;
+    typedef tPixel<typename Pixel_T::ElType, 1> PlanePixType;
+    typedef tImage<PlanePixType> PlaneType;
+
+private:
+    PlaneType Planes[Pixel_T::Chan];
+    int wid, hgt;
+
+    // Run f(y0, y1) over bands of rows, on multiple threads when the image is large.
+    template <class Func_T> void forRowBands(const Func_T& f) const
+    {
+        ParallelForRanges(hgt, std::max(1, ConvertParallelPixels / std::max(wid, 1)), f);
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // Doesn't initialize the pixels.
+    tPlanarImage(const int wid_ = 0, const int hgt_ = 0) : wid(0), hgt(0) { SetSize(wid_, hgt_); }
+
+    tPlanarImage(const int wid_, const int hgt_, const Pixel_T& fillVal) : wid(0), hgt(0)
+    {
+        SetSize(wid_, hgt_);
+        fill(fillVal);
+    }
+
+    // Deinterleave a copy of Img.
+    explicit tPlanarImage(const tImage<Pixel_T>& Img) : wid(0), hgt(0) { FromImage(Img); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about a pixel
+
+    static int chan() { return Pixel_T::Chan; }
+    static int size_element() { return sizeof(typename Pixel_T::ElType); }
+    static int size_pixel() { return sizeof(Pixel_T); }
+    static bool is_integer() { return Pixel_T::is_integer; }
+    static bool is_signed() { return Pixel_T::is_signed; }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about the image
+
+    int w() const { return wid; }
+    int h() const { return hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    int64_t size_els() const { return size() * chan(); }
+    bool empty() const { return size() < 1; }
+
+    // Change the size of this image. Each plane is a tImage of the given size; see tImage::SetSize().
+    void SetSize(const int wid_, const int hgt_, const bool doFill = false, const bool padRows = false)
+    {
+        for (int c = 0; c < chan(); c++) Planes[c].SetSize(wid_, hgt_, doFill, padRows);
+        wid = Planes[0].w();
+        hgt = Planes[0].h();
+    }
+
+    void clear() { SetSize(0, 0); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Access functions
+
+    // Channel c of the image as a one-channel image.
+    const PlaneType& plane(const int c) const
+    {
+        ASSERT_D(c >= 0 && c < chan());
+        return Planes[c];
+    }
+    PlaneType& plane(const int c)
+    {
+        ASSERT_D(c >= 0 && c < chan());
+        return Planes[c];
+    }
+
+    // Gather pixel x,y from the planes. It's returned const so that assigning to it doesn't compile; use Set() instead.
+    const Pixel_T operator()(const int x, const int y) const
+    {
+        ASSERT_D(x >= 0 && x < w() && y >= 0 && y < h());
+        Pixel_T p;
+        for (int c = 0; c < chan(); c++) p[c] = Planes[c](x, y)[0];
+        return p;
+    }
+
+    // Paint pixel x,y if it has valid coords.
+    void Set(const Pixel_T& p, const int x, const int y)
+    {
+        if (x >= 0 && x < w() && y >= 0 && y < h())
+            for (int c = 0; c < chan(); c++) Planes[c](x, y) = PlanePixType(p[c]);
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Utility functions
+
+    // Clear the image to the given color.
+    void fill(const Pixel_T p = Pixel_T(0))
+    {
+        for (int c = 0; c < chan(); c++) Planes[c].fill(PlanePixType(p[c]));
+    }
+
+    // Both channel-wise extrema at once. Each plane is one flat channel, so the SIMD kernels use every lane.
+    void GetMinMax(Pixel_T& cmin, Pixel_T& cmax) const
+    {
+        ASSERT_R(size() > 0);
+        for (int c = 0; c < chan(); c++) {
+            PlanePixType pmin, pmax;
+            Planes[c].GetMinMax(pmin, pmax);
+            cmin[c] = pmin[0];
+            cmax[c] = pmax[0];
+        }
+    }
+
+    // Min over all pixels for each channel.
+    Pixel_T min_chan() const
+    {
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
+        return cmin;
+    }
+
+    // Max over all pixels for each channel.
+    Pixel_T max_chan() const
+    {
+        Pixel_T cmin, cmax;
+        GetMinMax(cmin, cmax);
+        return cmax;
+    }
+
+    // Returns the channel-wise sum of all the pixels.
+    typename Pixel_T::MathPixType sum_chan() const
+    {
+        double sums[Pixel_T::Chan];
+        sum_chan(sums);
+        typename Pixel_T::MathPixType csum;
+        for (int c = 0; c < chan(); c++) csum[c] = static_cast<typename Pixel_T::MathType>(sums[c]);
+        return csum;
+    }
+
+    // Stores the channel-wise sum of all the pixels in sums, accumulated in double like tImage::sum_chan().
+    void sum_chan(double sums[Pixel_T::Chan]) const
+    {
+        for (int c = 0; c < chan(); c++) Planes[c].sum_chan(&sums[c]);
+    }
+
+    // Deinterleave Img, which is a tImage or tImageView with this pixel type, into the planes, resizing this to match.
+    template <class Image_T> void FromImage(const Image_T& Img)
+    {
+        const int NC = Pixel_T::Chan;
+        if (w() != Img.w() || h() != Img.h()) SetSize(Img.w(), Img.h());
+        if (empty()) return;
+
+        for (int c = 0; c < NC; c++) Planes[c].row(0); // Unshare the planes before the threads write rows of them
+        forRowBands([&](const int y0, const int y1) {
+            for (int y = y0; y < y1; y++) {
+                const Pixel_T* R = Img.row(y);
+                PlanePixType* D[NC];
+                for (int c = 0; c < NC; c++) D[c] = Planes[c].row(y);
+                for (int x = 0; x < wid; x++)
+                    for (int c = 0; c < NC; c++) D[c][x][0] = R[x][c];
+            }
+        });
+    }
+
+    // Interleave the planes into Img, which is a tImage or tImageView with this pixel type. A tImage is resized to match.
+    template <class Image_T> void ToImage(Image_T& Img) const
+    {
+        const int NC = Pixel_T::Chan;
+        if (Img.w() != wid || Img.h() != hgt) Img.SetSize(wid, hgt);
+        if (empty()) return;
+
+        Img.row(0); // Unshare the raster before the threads write rows of it
+        forRowBands([&](const int y0, const int y1) {
+            for (int y = y0; y < y1; y++) {
+                Pixel_T* R = Img.row(y);
+                const PlanePixType* S[NC];
+                for (int c = 0; c < NC; c++) S[c] = Planes[c].row(y);
+                for (int x = 0; x < wid; x++)
+                    for (int c = 0; c < NC; c++) R[x][c] = S[c][x][0];
+            }
+        });
+    }
+
+    // Return an interleaved copy of this image.
+    tImage<Pixel_T> Copy() const
+    {
+        tImage<Pixel_T> Img;
+        ToImage(Img);
+        return Img;
+    }
+};
+
+template <class Pixel_T> DMC_HDECL bool operator==(const tPlanarImage<Pixel_T>& p1, const tPlanarImage<Pixel_T>& p2)
+{
+    if (p1.w() != p2.w() || p1.h() != p2.h()) return false;
+    for (int c = 0; c < p1.chan(); c++)
+        if (p1.plane(c) != p2.plane(c)) return false;
+    return true;
+}
+
+template <class Pixel_T> DMC_HDECL bool operator!=(const tPlanarImage<Pixel_T>& p1, const tPlanarImage<Pixel_T>& p2) { return !(p1 == p2); }
+
+typedef tPlanarImage<f3Pixel> f3PlanarImage;
+typedef tPlanarImage<f4Pixel> f4PlanarImage;
+
+typedef tPlanarImage<uc3Pixel> uc3PlanarImage;
+typedef tPlanarImage<uc4Pixel> uc4PlanarImage;
+
+typedef tPlanarImage<us3Pixel> us3PlanarImage;
+typedef tPlanarImage<us4Pixel> us4PlanarImage;
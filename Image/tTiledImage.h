@@ -0,0 +1,215 @@
+//////////////////////////////////////////////////////////////////////
+// tTiledImage.h - An image stored in square tiles for 2D cache locality
+//
+// Copyright David K. McAllister, 2026.
+
+// A tImage is stored row by row, so filters that read a column of neighbors touch a different cache line,
+// and on wide images a different page, for every one. A tTiledImage stores the image as square tiles of
+// 2^TileLog2 x 2^TileLog2 pixels, with the tiles in raster order. The layout policy orders the pixels within a tile:
+// tBlockLayout stores each tile row by row, and tMortonLayout stores it in Z order so that any aligned 2^k x 2^k block
+// of a tile is contiguous. Either way a pixel's vertical neighbors are usually in the same tile.
+// Addressing a pixel takes a few more instructions than in a tImage, so tiling pays off when the rows a filter or sampler
+// reaches across don't all fit in cache, such as large kernels on very wide images.
+//
+// tTiledImage has the w(), h(), operator()(x, y), and SetSize() interface that the image algorithms use, so the
+// algorithms in ImageAlgorithms.h that are instantiated for it run directly on the tiles.
+// FromImage() and ToImage() convert between a tImage or tImageView and tiles a whole tile at a time.
+//
+// The image is padded up to a whole number of tiles. The padding pixels are not part of the image.
+// The tiles are the rows of a tImage, so a tTiledImage copies, moves, and shares its raster just like a tImage does.
+
+#pragma once
+
+#include "Image/tImage.h"
+
+#include <algorithm>
+
+// Store each tile row by row.
+template <int TileLog2> struct tBlockLayout {
+    static const int TileShift = TileLog2;
+    static const int TileDim = 1 << TileLog2;
+
+    // Offset of pixel tx,ty within its tile. Each of tx and ty contributes separate bits, so offsets can be built by OR.
+    static DMC_DECL int inTile(const int tx, const int ty) { return (ty << TileLog2) | tx; }
+};
+
+// Store each tile in Morton (Z) order, interleaving the bits of tx and ty.
+// Math/SpaceFillCurve.h interleaves three coordinates, which would leave two thirds of the codes unused for an image.
+template <int TileLog2> struct tMortonLayout {
+    static const int TileShift = TileLog2;
+    static const int TileDim = 1 << TileLog2;
+    static_assert(TileLog2 <= 8, "Morton tiles can be at most 256 pixels on a side");
+
+    // Spread the low 8 bits of v out to the even bits.
+    static DMC_DECL int spread(int v)
+    {
+        v = (v | (v << 4)) & 0x0F0F;
+        v = (v | (v << 2)) & 0x3333;
+        v = (v | (v << 1)) & 0x5555;
+        return v;
+    }
+
+    // Offset of pixel tx,ty within its tile. Each of tx and ty contributes separate bits, so offsets can be built by OR.
+    static DMC_DECL int inTile(const int tx, const int ty) { return spread(tx) | (spread(ty) << 1); }
+};
+
+template <class Pixel_T, class Layout_T = tMortonLayout<3>> class tTiledImage {
+    static const int TileShift = Layout_T::TileShift;
+    static const int TileDim = Layout_T::TileDim;
+    static const int TileMask = TileDim - 1;
+
+    tImage<Pixel_T> Tiles; // One row per tile
+    int wid, hgt;
+    int tilesX, tilesY; // Size of the image in tiles
+
+    int tileIndex(const int x, const int y) const { return (y >> TileShift) * tilesX + (x >> TileShift); }
+
+public:
+    typedef Pixel_T PixType;
+    typedef Layout_T LayoutType;
+
+    //////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // Doesn't initialize the pixels.
+    tTiledImage(const int wid_ = 0, const int hgt_ = 0) : wid(0), hgt(0), tilesX(0), tilesY(0) { SetSize(wid_, hgt_); }
+
+    tTiledImage(const int wid_, const int hgt_, const Pixel_T& fillVal) : wid(0), hgt(0), tilesX(0), tilesY(0)
+    {
+        SetSize(wid_, hgt_);
+        fill(fillVal);
+    }
+
+    // Tile a copy of Img.
+    explicit tTiledImage(const tImage<Pixel_T>& Img) : wid(0), hgt(0), tilesX(0), tilesY(0) { FromImage(Img); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about a pixel
+
+    static int chan() { return Pixel_T::Chan; }
+    static int size_element() { return sizeof(typename Pixel_T::ElType); }
+    static int size_pixel() { return sizeof(Pixel_T); }
+    static bool is_integer() { return Pixel_T::is_integer; }
+    static bool is_signed() { return Pixel_T::is_signed; }
+
+    //////////////////////////////////////////////////////////////////////
+    // Info about the image
+
+    int w() const { return wid; }
+    int h() const { return hgt; }
+    int64_t size() const { return int64_t(wid) * hgt; }
+    int64_t size_els() const { return size() * chan(); }
+    bool empty() const { return size() < 1; }
+
+    // Pixels on a side of a tile.
+    static int tile_dim() { return TileDim; }
+    int tiles_x() const { return tilesX; }
+    int tiles_y() const { return tilesY; }
+
+    // Change the size of this image. Doesn't initialize the pixels.
+    void SetSize(const int wid_, const int hgt_)
+    {
+        wid = wid_;
+        hgt = hgt_;
+        if (wid <= 0 || hgt <= 0) wid = hgt = 0;
+        tilesX = (wid + TileMask) / TileDim;
+        tilesY = (hgt + TileMask) / TileDim;
+        Tiles.SetSize(TileDim * TileDim, tilesX * tilesY);
+    }
+
+    void clear() { SetSize(0, 0); }
+
+    //////////////////////////////////////////////////////////////////////
+    // Access functions
+
+    // Returns a pointer to the first pixel of tile tx,ty.
+    const Pixel_T* tile(const int tx, const int ty) const { return Tiles.row(ty * tilesX + tx); }
+    Pixel_T* tile(const int tx, const int ty) { return Tiles.row(ty * tilesX + tx); }
+
+    const Pixel_T& operator()(const int x, const int y) const
+    {
+        ASSERT_D(x >= 0 && x < w() && y >= 0 && y < h());
+        return Tiles.row(tileIndex(x, y))[Layout_T::inTile(x & TileMask, y & TileMask)];
+    }
+    Pixel_T& operator()(const int x, const int y)
+    {
+        ASSERT_D(x >= 0 && x < w() && y >= 0 && y < h());
+        return Tiles.row(tileIndex(x, y))[Layout_T::inTile(x & TileMask, y & TileMask)];
+    }
+
+    const Pixel_T* pp(const int x, const int y) const { return &(*this)(x, y); }
+    Pixel_T* pp(const int x, const int y) { return &(*this)(x, y); }
+
+    // Paint pixel x,y if it has valid coords.
+    void Set(const Pixel_T& p, const int x, const int y)
+    {
+        if (x >= 0 && x < w() && y >= 0 && y < h()) (*this)(x, y) = p;
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Utility functions
+
+    // Set every pixel to p, including the padding.
+    void fill(const Pixel_T p = Pixel_T(0)) { Tiles.fill(p); }
+
+    // Copy Img, which is a tImage or tImageView with this pixel type, into this image, resizing this to match.
+    template <class Image_T> void FromImage(const Image_T& Img)
+    {
+        SetSize(Img.w(), Img.h());
+
+        // Since x and y map to separate bits of the offset, one table for each covers the whole tile.
+        int offX[TileDim], offY[TileDim];
+        for (int i = 0; i < TileDim; i++) offX[i] = Layout_T::inTile(i, 0), offY[i] = Layout_T::inTile(0, i);
+
+        for (int ty = 0; ty < tiles_y(); ty++) {
+            const int y0 = ty * TileDim, y1 = std::min(y0 + TileDim, hgt);
+            for (int tx = 0; tx < tilesX; tx++) {
+                const int x0 = tx * TileDim, x1 = std::min(x0 + TileDim, wid);
+                Pixel_T* T = tile(tx, ty);
+                for (int y = y0; y < y1; y++) {
+                    const Pixel_T* R = Img.row(y);
+                    Pixel_T* TR = T + offY[y - y0];
+                    for (int x = x0; x < x1; x++) TR[offX[x - x0]] = R[x];
+                }
+            }
+        }
+    }
+
+    // Copy this image into Img, which is a tImage or tImageView with this pixel type. A tImage is resized to match.
+    template <class Image_T> void ToImage(Image_T& Img) const
+    {
+        if (Img.w() != wid || Img.h() != hgt) Img.SetSize(wid, hgt);
+
+        int offX[TileDim], offY[TileDim];
+        for (int i = 0; i < TileDim; i++) offX[i] = Layout_T::inTile(i, 0), offY[i] = Layout_T::inTile(0, i);
+
+        for (int ty = 0; ty < tiles_y(); ty++) {
+            const int y0 = ty * TileDim, y1 = std::min(y0 + TileDim, hgt);
+            for (int tx = 0; tx < tilesX; tx++) {
+                const int x0 = tx * TileDim, x1 = std::min(x0 + TileDim, wid);
+                const Pixel_T* T = tile(tx, ty);
+                for (int y = y0; y < y1; y++) {
+                    Pixel_T* R = Img.row(y);
+                    const Pixel_T* TR = T + offY[y - y0];
+                    for (int x = x0; x < x1; x++) R[x] = TR[offX[x - x0]];
+                }
+            }
+        }
+    }
+
+    // Return a raster-order copy of this image.
+    tImage<Pixel_T> Copy() const
+    {
+        tImage<Pixel_T> Img;
+        ToImage(Img);
+        return Img;
+    }
+};
+
+typedef tTiledImage<f1Pixel> f1TiledImage;
+typedef tTiledImage<f3Pixel> f3TiledImage;
+typedef tTiledImage<f4Pixel> f4TiledImage;
+
+typedef tTiledImage<uc1Pixel> uc1TiledImage;
+typedef tTiledImage<uc3Pixel> uc3TiledImage;
+typedef tTiledImage<uc4Pixel> uc4TiledImage;
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////
+// FFT.cpp - Radix-2 complex fast Fourier transforms in one and two dimensions
+//
+// Copyright David K. McAllister, 2026.
+
+#include "Math/FFT.h"
+
+#include "Math/MiscMath.h"
+#include "Util/Assert.h"
+
+#include <algorithm>
+
+namespace {
+// The complex product without std::complex's NaN and infinity handling, which isn't inlined.
+DMC_DECL std::complex<float> cmul(const std::complex<float>& a, const std::complex<float>& b)
+{
+    return std::complex<float>(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+}; // namespace
+
+FFT1D::FFT1D(const int n) : N(n)
+{
+    ASSERT_R(n > 0 && (n & (n - 1)) == 0);
+
+    Twiddles.resize(N / 2);
+    for (int k = 0; k < N / 2; k++) {
+        const double theta = -2.0 * M_PI * k / N;
+        Twiddles[k] = std::complex<float>(float(cos(theta)), float(sin(theta)));
+    }
+
+    for (int i = 0, j = 0; i < N; i++) {
+        if (i < j) {
+            BitRev.push_back(i);
+            BitRev.push_back(j);
+        }
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+    }
+}
+
+void FFT1D::transform(std::complex<float>* a, const bool inverse) const
+{
+    for (size_t p = 0; p < BitRev.size(); p += 2) std::swap(a[BitRev[p]], a[BitRev[p + 1]]);
+
+    for (int len = 2; len <= N; len <<= 1) {
+        const int half = len / 2, step = N / len;
+        for (int i = 0; i < N; i += len) {
+            for (int k = 0; k < half; k++) {
+                const std::complex<float> t = inverse ? std::conj(Twiddles[k * step]) : Twiddles[k * step];
+                const std::complex<float> u = a[i + k];
+                const std::complex<float> v = cmul(a[i + k + half], t);
+                a[i + k] = u + v;
+                a[i + k + half] = u - v;
+            }
+        }
+    }
+}
+
+FFT2D::FFT2D(const int w, const int h) : Rows(w), Cols(h) {}
+
+void FFT2D::transform(std::complex<float>* a, const bool inverse) const
+{
+    const int W = Rows.size(), H = Cols.size();
+
+    for (int y = 0; y < H; y++) Rows.transform(a + size_t(y) * W, inverse);
+
+    // The same butterflies as FFT1D, but each element is a whole row.
+    for (size_t p = 0; p < Cols.BitRev.size(); p += 2)
+        std::swap_ranges(a + size_t(Cols.BitRev[p]) * W, a + size_t(Cols.BitRev[p] + 1) * W, a + size_t(Cols.BitRev[p + 1]) * W);
+
+    for (int len = 2; len <= H; len <<= 1) {
+        const int half = len / 2, step = H / len;
+        for (int i = 0; i < H; i += len) {
+            for (int k = 0; k < half; k++) {
+                const std::complex<float> t = inverse ? std::conj(Cols.Twiddles[k * step]) : Cols.Twiddles[k * step];
+                std::complex<float>* r0 = a + size_t(i + k) * W;
+                std::complex<float>* r1 = a + size_t(i + k + half) * W;
+                for (int x = 0; x < W; x++) {
+                    const std::complex<float> u = r0[x];
+                    const std::complex<float> v = cmul(r1[x], t);
+                    r0[x] = u + v;
+                    r1[x] = u - v;
+                }
+            }
+        }
+    }
+}
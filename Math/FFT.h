@@ -0,0 +1,52 @@
+//////////////////////////////////////////////////////////////////////
+// FFT.h - Radix-2 complex fast Fourier transforms in one and two dimensions
+//
+// Copyright David K. McAllister, 2026.
+
+// Each transform object is made for one power-of-two size and precomputes its twiddle factors and bit-reversal
+// permutation, so it is built once and then applied to many arrays of that size, possibly on many threads at once.
+// Transforms are in place on arrays of std::complex<float>. Forward() uses exp(-2 pi i j k / n). Inverse() uses
+// exp(+2 pi i j k / n) and is not scaled, so Inverse(Forward(a)) is a times the number of elements.
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+class FFT1D {
+public:
+    // n must be a power of two.
+    explicit FFT1D(const int n = 1);
+
+    int size() const { return N; }
+
+    void Forward(std::complex<float>* a) const { transform(a, false); }
+    void Inverse(std::complex<float>* a) const { transform(a, true); }
+
+private:
+    int N;
+    std::vector<std::complex<float>> Twiddles; // exp(-2 pi i k / N) for k < N / 2
+    std::vector<int> BitRev;                   // Pairs i < j to swap
+
+    void transform(std::complex<float>* a, const bool inverse) const;
+
+    friend class FFT2D;
+};
+
+// A 2D transform of an array of h rows of w elements, each row contiguous. w and h must be powers of two.
+// The columns are transformed a whole row at a time, so the array is accessed in row order throughout.
+class FFT2D {
+public:
+    FFT2D(const int w = 1, const int h = 1);
+
+    int w() const { return Rows.size(); }
+    int h() const { return Cols.size(); }
+
+    void Forward(std::complex<float>* a) const { transform(a, false); }
+    void Inverse(std::complex<float>* a) const { transform(a, true); }
+
+private:
+    FFT1D Rows, Cols;
+
+    void transform(std::complex<float>* a, const bool inverse) const;
+};
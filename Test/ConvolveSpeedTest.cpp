@@ -0,0 +1,43 @@
+// Time ConvolveImageDirect against ConvolveImageFFT over a range of kernel widths to find where the FFT wins.
+// This is how ConvolveFFTMinWidth was chosen. argv[1] and argv[2] override the 1024 x 1024 image size.
+
+#include "Image/ImageAlgorithms.h"
+#include "Image/tImage.h"
+#include "Math/Random.h"
+#include "Util/Timer.h"
+
+#include <iostream>
+
+bool ConvolveSpeedTest(int argc, char** argv)
+{
+    std::cerr << "Starting ConvolveSpeedTest\n";
+
+    const bool hasSize = argc > 2 && argv[1][0] != '-' && argv[2][0] != '-';
+    const int wid = hasSize ? atoi(argv[1]) : 1024, hgt = hasSize ? atoi(argv[2]) : 1024;
+    ASSERT_R(wid > 0 && hgt > 0);
+    f3Image In(wid, hgt);
+    for (int i = 0; i < In.size(); i++) In[i] = f3Pixel(frand(), frand(), frand());
+
+    f3Image D, F;
+    int crossover = 0, fftWins = 0;
+    for (int N = 3; N <= 65 && fftWins < 3; N += 2) {
+        const f1Image K = MakeGaussianKernel<f1Image>(N, N / 4.f);
+
+        Timer T;
+        ConvolveImageDirect(D, In, K);
+        const double direct = T.Reset();
+        ConvolveImageFFT(F, In, K);
+        const double fft = T.Reset();
+
+        std::cerr << N << "x" << N << " kernel: direct " << direct << " sec, FFT " << fft << " sec\n";
+        if (fft < direct) {
+            if (!fftWins++) crossover = N;
+        } else
+            fftWins = 0;
+    }
+
+    std::cerr << "FFT is faster for kernels " << crossover << " wide and up. ConvolveFFTMinWidth is " << ConvolveFFTMinWidth << ".\n";
+    std::cerr << "Ending ConvolveSpeedTest\n";
+
+    return true;
+}
@@ -9,10 +9,12 @@
 #include <string>
 
 extern bool BVHTest(int argc, char** argv);
+extern bool ConvolveSpeedTest(int argc, char** argv);
 extern bool DiskReadTest(int argc, char** argv);
 extern bool DiskWriteTest(int argc, char** argv);
 extern bool GaussianTest(int argc, char** argv);
 extern bool HashStringTest(int argc, char** argv);
+extern bool ImageHugeStressTest(int argc, char** argv);
 extern bool ImageRWSpeedTest(int argc, char** argv);
 extern bool KDTreeTest(int argc, char** argv);
 extern bool MappingsTest(int argc, char** argv);
@@ -34,10 +36,12 @@ void Usage(const char* message = NULL, const bool Exit = true)
     std::cerr << "Program options:\n";
     std::cerr << "-testall\n";
     std::cerr << "-BVHTest\n";
+    std::cerr << "-ConvolveSpeedTest [wid hgt]\n";
     std::cerr << "-DiskReadTest\n";
     std::cerr << "-DiskWriteTest\n";
     std::cerr << "-GaussianTest\n";
     std::cerr << "-HashStringTest\n";
+    std::cerr << "-ImageHugeStressTest [wid hgt]   (needs about 10 GB; not part of -testall)\n";
     std::cerr << "-ImageRWSpeedTest\n";
     std::cerr << "-KDTreeTest\n";
     std::cerr << "-MappingsTest\n";
@@ -62,6 +66,8 @@ bool AllTests(int argc, char** argv)
     // TODO: Change this to send in args that do tests of various speeds, level 1, 2, 3, etc.
     ok = BVHTest(0, NULL);
     allok = allok && ok;
+    ok = ConvolveSpeedTest(0, NULL);
+    allok = allok && ok;
     ok = DiskWriteTest(0, NULL);
     allok = allok && ok;
     ok = DiskReadTest(0, NULL);
@@ -113,6 +119,9 @@ void Args(int argc, char** argv)
             Usage();
         } else if (starg == "-BVHTest") {
             BVHTest(argc - i, &(argv[i]));
+        } else if (starg == "-ConvolveSpeedTest") {
+            ConvolveSpeedTest(argc - i, &(argv[i]));
+            if (i + 2 < argc && argv[i + 1][0] != '-' && argv[i + 2][0] != '-') i += 2; // Skip the optional size
         } else if (starg == "-DiskReadTest") {
             DiskReadTest(argc - i, &(argv[i]));
         } else if (starg == "-DiskWriteTest") {
@@ -121,6 +130,9 @@ void Args(int argc, char** argv)
             GaussianTest(argc - i, &(argv[i]));
         } else if (starg == "-HashStringTest") {
             HashStringTest(argc - i, &(argv[i]));
+        } else if (starg == "-ImageHugeStressTest") {
+            ImageHugeStressTest(argc - i, &(argv[i]));
+            if (i + 2 < argc && argv[i + 1][0] != '-' && argv[i + 2][0] != '-') i += 2; // Skip the optional size
         } else if (starg == "-ImageRWSpeedTest") {
             ImageRWSpeedTest(argc - i, &(argv[i]));
         } else if (starg == "-KDTreeTest") {
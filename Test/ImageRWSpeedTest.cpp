@@ -2,8 +2,11 @@
 #include "Math/MiscMath.h"
 #include "Util/Timer.h"
 
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <string>
 
 bool ImageReadSpeedTest(int argc, char** argv) { return true; }
 
@@ -23,6 +26,64 @@ bool ImageWriteSpeedTest(int argc, char** argv)
     return true;
 }
 
+// Pixel x,y of the stress test pattern. No channel exceeds 254 so adding one doesn't saturate.
+static uc4Pixel HugePattern(const int x, const int y) { return uc4Pixel(x % 255, y % 255, (x + y) % 255, 0x40); }
+
+// Process an image with more than 2^32 bytes and more than 2^31 elements end to end: allocate, write, arithmetic,
+// reductions, and a save and load round trip. Every size and linear index past 4 GB must be 64-bit to pass.
+// The default is 34000 x 34000 uc4, which is 4.6 GB, so with the loaded copy it needs about 10 GB of memory.
+// argv[1] and argv[2] override the width and height. Only run by -ImageHugeStressTest, not by -testall.
+bool ImageHugeStressTest(int argc, char** argv)
+{
+    const bool hasSize = argc > 2 && argv[1][0] != '-' && argv[2][0] != '-';
+    const int wid = hasSize ? atoi(argv[1]) : 34000, hgt = hasSize ? atoi(argv[2]) : 34000;
+    ASSERT_R(wid > 0 && hgt > 0);
+
+    Timer T;
+    uc4Image Img(wid, hgt);
+    std::cerr << "Allocated " << wid << "x" << hgt << " = " << Img.size_bytes() << " bytes: " << T.Reset() << " sec\n";
+
+    for (int y = 0; y < hgt; y++) {
+        uc4Pixel* r = Img.row(y);
+        for (int x = 0; x < wid; x++) r[x] = HugePattern(x, y);
+    }
+    std::cerr << "Filled: " << T.Reset() << " sec\n";
+
+    Img += uc4Pixel(1);
+    std::cerr << "Added: " << T.Reset() << " sec\n";
+
+    uc4Pixel cmin, cmax;
+    Img.GetMinMax(cmin, cmax);
+    std::cerr << "GetMinMax " << cmin << " " << cmax << ": " << T.Reset() << " sec\n";
+    ASSERT_R(cmin == uc4Pixel(1, 1, 1, 0x41));
+    ASSERT_R(cmax[3] == 0x41);
+
+    // The sums exceed the int MathType of a uc4Pixel, so they are accumulated in double.
+    double csum[4];
+    Img.sum_chan(csum);
+    std::cerr << "sum_chan " << csum[0] << " " << csum[1] << " " << csum[2] << " " << csum[3] << ": " << T.Reset() << " sec\n";
+    ASSERT_R(csum[3] == 0x41 * double(Img.size()));
+    ASSERT_R(Img.mean_chan()[3] == 0x41);
+
+    // The last pixels are past every 32-bit boundary.
+    const int64_t last = Img.size() - 1;
+    ASSERT_R(Img[last] == HugePattern(wid - 1, hgt - 1) + uc4Pixel(1));
+    ASSERT_R(Img(wid - 1, hgt - 1) == Img[last]);
+
+    const std::string fname = (std::filesystem::temp_directory_path() / "DMcToolsHugeStress.pam").string();
+    Img.Save(fname);
+    std::cerr << "Saved " << fname << ": " << T.Reset() << " sec\n";
+
+    uc4Image Back(fname);
+    std::cerr << "Loaded: " << T.Reset() << " sec\n";
+    ASSERT_R(Back == Img);
+    std::cerr << "Compared: " << T.Reset() << " sec\n";
+
+    std::remove(fname.c_str());
+
+    return true;
+}
+
 bool ImageRWSpeedTest(int argc, char** argv)
 {
     std::cerr << "Starting ImageRWSpeedTest\n";
@@ -2,6 +2,10 @@
 
 #include "Image/ImageAlgorithms.h"
 #include "Image/tImage.h"
+#include "Util/Timer.h"
+
+#include <cmath>
+#include <cstdio>
 
 void VCDLoop()
 {
@@ -23,10 +27,62 @@ void VCDLoop()
     }
 }
 
+// A test pattern of flat regions with sharp edges between them, a gentle ramp, and a little noise
+template <class Image_T> Image_T VCDPattern(const int wid, const int hgt)
+{
+    Image_T Img(wid, hgt);
+    for (int y = 0; y < hgt; y++) {
+        for (int x = 0; x < wid; x++) {
+            for (int c = 0; c < Img.chan(); c++) {
+                const float noise = float(((x * 7919 + y * 104729 + c * 31) * 2654435761u) >> 24) / 255.f - 0.5f;
+                Img(x, y)[c] = ((x / 40 + y / 50 + c) % 3) * 0.3f + 0.1f * sinf(x * 0.05f + c) + 0.03f * noise;
+            }
+        }
+    }
+    return Img;
+}
+
+// Time VCDApprox against VCD and report its RMS and max error relative to VCD's, for several spatial and color stdevs.
+// For scale, also report how far VCD moved the pixels.
+template <class Image_T> void VCDApproxReport(const int wid, const int hgt)
+{
+    const Image_T In = VCDPattern<Image_T>(wid, hgt);
+
+    for (float ImageStDev : {1.5f, 3.f, 6.f}) {
+        for (float ColorStDev : {0.2f, 0.5f, 0.8f}) {
+            const int FiltWid = 2 * int(ceilf(3 * ImageStDev)) + 1;
+            Image_T Exact, Approx;
+            Timer T;
+            VCD(Exact, In, FiltWid, ImageStDev, ColorStDev, 1);
+            const double exactTime = T.Reset();
+            VCDApprox(Approx, In, ImageStDev, ColorStDev, 1);
+            const double approxTime = T.Reset();
+
+            double errSq = 0, errMax = 0, movedSq = 0;
+            for (int y = 0; y < hgt; y++) {
+                for (int x = 0; x < wid; x++) {
+                    for (int c = 0; c < In.chan(); c++) {
+                        const double e = Approx(x, y)[c] - Exact(x, y)[c], m = Exact(x, y)[c] - In(x, y)[c];
+                        errSq += e * e;
+                        errMax = std::max(errMax, fabs(e));
+                        movedSq += m * m;
+                    }
+                }
+            }
+            const double n = double(wid) * hgt * In.chan();
+            fprintf(stderr, "%d chan stdevs %4.1f %3.1f: VCD %6.3f sec, VCDApprox %6.3f sec, %5.1fx; RMS error %.4f, max %.4f; VCD moved pixels RMS %.4f\n", In.chan(),
+                   ImageStDev, ColorStDev, exactTime, approxTime, exactTime / approxTime, sqrt(errSq / n), errMax, sqrt(movedSq / n));
+        }
+    }
+}
+
 bool VCDTest(int argc, char** argv)
 {
     std::cerr << "Starting VCDTest\n";
 
+    VCDApproxReport<f1Image>(512, 512);
+    VCDApproxReport<f3Image>(512, 512);
+
     VCDLoop();
 
     std::cerr << "Ending VCDTest\n";
@@ -4,8 +4,13 @@
 
 #include "Half/half.h"
 #include "Image/ImageAlgorithms.h"
+#include "Image/tIntegralImage.h"
+#include "Image/tMipChain.h"
+#include "Image/tMipSampler.h"
 
+#include <cstring>
 #include <limits>
+#include <thread>
 
 template <class TYPE> void TestPixels1Chan()
 {
@@ -405,9 +410,1129 @@ void TestImageConversion()
     std::cerr << "Done\n";
 }
 
+void TestImageExpressions()
+{
+    std::cerr << "************************* TestImageExpressions\n";
+    f3Image A(64, 48, f3Pixel(1, 2, 3)), B(64, 48, f3Pixel(2)), C(64, 48, f3Pixel(3)), D(64, 48, f3Pixel(0.5f));
+
+    f3Image R = A * B + C * D; // Evaluated in one pass with no temporary images
+    ASSERT_R(R[0] == f3Pixel(3.5f, 5.5f, 7.5f));
+
+    R = R / f3Pixel(0.5f) - A; // An operand may also be the destination
+    ASSERT_R(R[17] == f3Pixel(6, 9, 12));
+
+    R = ifunc(Max(A, B) * 2.0f, [](float x) { return x + 1; });
+    ASSERT_R(R[3] == f3Pixel(5, 5, 7));
+
+    func(R, [](float x) { return -x; });
+    R += Abs(R) + linInterp(A, C, 0.5f);
+    ASSERT_R(R[0] == f3Pixel(2, 2.5f, 3));
+
+    uc3Image U = uc3Image(2, 2, uc3Pixel(128)) * uc3Image(2, 2, uc3Pixel(255)); // Pixel ops keep their rounding rules
+    ASSERT_R(U[0] == uc3Pixel(128));
+    std::cerr << R[0] << U[0] << std::endl;
+}
+
+// The SIMD kernels must give the same answer as the scalar loops
+template <class Image_T> void TestImageKernels1()
+{
+    typedef typename Image_T::PixType Pixel_T;
+    Image_T A(67, 41), B(67, 41); // Odd sizes so the kernels have leftovers
+    for (int i = 0; i < A.size(); i++)
+        for (int c = 0; c < Pixel_T::Chan; c++) {
+            A[i][c] = static_cast<typename Pixel_T::ElType>((i * 37 + c * 11) % 251);
+            B[i][c] = static_cast<typename Pixel_T::ElType>((i * 53 + c * 7) % 241 + 1);
+        }
+    Pixel_T s(5, 200, 17, 99);
+
+    const SIMDLevel_e Level = GetSIMDLevel();
+    Image_T R[2][6];
+    Pixel_T mn[2], mx[2];
+    for (int k = 0; k < 2; k++) {
+        SetSIMDLevel(k ? Level : SIMD_NONE);
+        R[k][0] = A, R[k][0] += B;
+        R[k][1] = A, R[k][1] -= B;
+        R[k][2] = A, R[k][2] *= B;
+        R[k][3] = A, R[k][3] *= s;
+        R[k][4] = A, R[k][4] -= s;
+        R[k][5] = A, R[k][5].fill(s);
+        A.GetMinMax(mn[k], mx[k]);
+    }
+    SetSIMDLevel(Level);
+    for (int j = 0; j < 6; j++) ASSERT_R(R[0][j] == R[1][j]);
+    ASSERT_R(mn[0] == mn[1] && mx[0] == mx[1]);
+    ASSERT_R(!(R[0][0] == R[0][1]));
+}
+
+void TestImageKernels()
+{
+    std::cerr << "************************* TestImageKernels " << GetSIMDLevel() << '\n';
+    TestImageKernels1<uc1Image>();
+    TestImageKernels1<uc3Image>();
+    TestImageKernels1<uc4Image>();
+    TestImageKernels1<us3Image>();
+    TestImageKernels1<f1Image>();
+    TestImageKernels1<f3Image>();
+    TestImageKernels1<f4Image>();
+    TestImageKernels1<h4Image>();
+}
+
+// Algorithms on a view of a crop must match the same algorithms on a copy of the crop
+void TestImageViews()
+{
+    std::cerr << "************************* TestImageViews\n";
+    f3Image Big(100, 80);
+    for (int y = 0; y < Big.h(); y++)
+        for (int x = 0; x < Big.w(); x++) Big(x, y) = f3Pixel(x * 0.01f, y * 0.02f, (x * y % 17) * 0.1f);
+
+    f3ImageView In(Big, 10, 20, 40, 30);
+    f3Image Crop = In.Copy();
+
+    f3Image Blurred, Out(40, 30);
+    f3ImageView OutV(Out);
+    GaussianBlur(Blurred, Crop, 5, 1.0f);
+    GaussianBlur(OutV, In, 5, 1.0f);
+    ASSERT_R(Out == Blurred);
+
+    f3Image Resized, Small(13, 9);
+    f3ImageView SmallV(Small);
+    Resize(Resized, Crop, 13, 9);
+    Resize(SmallV, In, 13, 9);
+    ASSERT_R(Small == Resized);
+
+    uc3Image Toned, Toned2(40, 30);
+    uc3ImageView TonedV(Toned2);
+    ToneMapFindExtrema(Toned, Crop);
+    ToneMapFindExtrema(TonedV, In);
+    ASSERT_R(Toned == Toned2);
+
+    // Paste the crop into a window of another image
+    f3Image Dst(100, 80, f3Pixel(0));
+    f3ImageView DstV(Dst, 5, 5, 50, 50);
+    CopyRect(DstV, In, 0, 0, 3, 4, 40, 30);
+    ASSERT_R(Dst(8, 9) == Big(10, 20) && Dst(47, 38) == Big(49, 49) && Dst(48, 39) == f3Pixel(0));
+
+    // A raster with padded rows
+    unsigned char Buf[7 * 16] = {0};
+    uc3ImageView Raw(reinterpret_cast<uc3Pixel*>(Buf), 5, 7, 16);
+    Raw.fill(uc3Pixel(1, 2, 3));
+    ASSERT_R(Buf[15] == 0 && Buf[16] == 1 && Raw(4, 6) == uc3Pixel(1, 2, 3));
+}
+
+// An image with padded rows must behave exactly like a tight one
+template <class Image_T> void TestImagePitch1()
+{
+    typedef typename Image_T::PixType Pixel_T;
+    Image_T A(37, 11), B(37, 11);
+    for (int i = 0; i < A.size(); i++)
+        for (int c = 0; c < Pixel_T::Chan; c++) {
+            A[i][c] = static_cast<typename Pixel_T::ElType>((i * 37 + c * 11) % 251);
+            B[i][c] = static_cast<typename Pixel_T::ElType>((i * 53 + c * 7) % 241 + 1);
+        }
+
+    Image_T P, Q;
+    P.SetSize(A.w(), A.h(), false, true);
+    Q.SetSize(A.w(), A.h(), false, true);
+    ASSERT_R(!P.contiguous() && P.pitch_bytes() % baseImage::RasterAlign == 0);
+    ASSERT_R(reinterpret_cast<size_t>(A.pv()) % baseImage::RasterAlign == 0 && reinterpret_cast<size_t>(P.pv(0, 5)) % baseImage::RasterAlign == 0);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++) P(x, y) = A(x, y), Q(x, y) = B(x, y);
+    ASSERT_R(P == A && P[100] == A[100] && P.max_chan() == A.max_chan() && P.sum_chan() == A.sum_chan());
+
+    Pixel_T s(5, 200, 17, 99);
+    P += Q;
+    P *= s;
+    A += B;
+    A *= s;
+    ASSERT_R(P == A);
+    P = P - Q; // Evaluates in place, so keeps the padding
+    A = A - B;
+    ASSERT_R(P == A && !P.contiguous());
+
+    Image_T C(P); // Copies are tight
+    ASSERT_R(C.contiguous() && C == A);
+    P.fill(s);
+    ASSERT_R(P.min_chan() == s && P(36, 10) == s);
+}
+
+void TestImagePitch()
+{
+    std::cerr << "************************* TestImagePitch\n";
+    TestImagePitch1<uc3Image>();
+    TestImagePitch1<f1Image>();
+    TestImagePitch1<f3Image>();
+    TestImagePitch1<h4Image>();
+}
+
+// Moves hand over the raster, and shared rasters are copied on the first write
+void TestImageSharing()
+{
+    std::cerr << "************************* TestImageSharing\n";
+    f3Image A(64, 32, f3Pixel(1, 2, 3));
+    const void* APix = static_cast<const f3Image&>(A).pv();
+
+    f3Image B(std::move(A));
+    ASSERT_R(A.empty() && static_cast<const f3Image&>(B).pv() == APix);
+    A = std::move(B);
+    ASSERT_R(B.empty() && static_cast<const f3Image&>(A).pv() == APix);
+
+    f3Image C = A.Share();
+    f3Image D = A.Share();
+    f3Image* Cp = A.Copy(); // A deep copy
+    ASSERT_R(A.shared() && static_cast<const f3Image&>(C).pv() == APix && static_cast<const f3Image&>(D).pv() == APix);
+    ASSERT_R(static_cast<const f3Image*>(Cp)->pv() != APix && *Cp == A);
+    delete Cp;
+
+    C.MakeUnique(); // C gets its own raster
+    C(5, 6) = f3Pixel(9);
+    ASSERT_R(static_cast<const f3Image&>(C).pv() != APix && A(5, 6) == f3Pixel(1, 2, 3) && C(5, 6) == f3Pixel(9) && C(7, 6) == A(7, 6));
+    D += f3Pixel(1);
+    ASSERT_R(!A.shared() && A(0, 0) == f3Pixel(1, 2, 3) && D(0, 0) == f3Pixel(2, 3, 4));
+    D.clear();
+
+    f3Image E = A.Share();
+    A.clear();
+    ASSERT_R(!E.shared() && E(63, 31) == f3Pixel(1, 2, 3));
+    E.MakeUnique(); // E is the only holder, so this just drops the count
+
+    // Threads sharing the same const image at once, before it has a count, must all end up with the same count
+    const f3Image& CE = E;
+    std::vector<f3Image> Shares(64);
+    std::vector<std::thread> Threads;
+    for (int k = 0; k < 4; k++)
+        Threads.emplace_back([&, k] {
+            for (int i = k; i < int(Shares.size()); i += 4) Shares[i] = CE.Share();
+        });
+    for (auto& T : Threads) T.join();
+    ASSERT_R(E.shared() && static_cast<const f3Image&>(Shares[17]).pv() == CE.pv());
+    Shares.clear();
+    ASSERT_R(!E.shared());
+}
+
+// A smooth but asymmetric test image with negative values in the blue channel
+static f3Image makeTestImage(int w, int h)
+{
+    f3Image A(w, h);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++) A(x, y) = f3Pixel((x * 7 % 13) * 0.1f, (y * 5 % 11) * 0.1f, ((x * y) % 7) * 0.1f - 0.2f);
+    return A;
+}
+
+// Tiled images must hold the same pixels and give the same filter results as raster images
+void TestTiledImage()
+{
+    std::cerr << "************************* TestTiledImage\n";
+    const f3Image A = makeTestImage(37, 29);
+
+    f3TiledImage T(A);
+    ASSERT_R(T.tiles_x() == 5 && T.tiles_y() == 4 && T(36, 28) == A(36, 28) && T.Copy() == A);
+    tTiledImage<f3Pixel, tBlockLayout<4>> TB(A);
+    ASSERT_R(TB(17, 16) == A(17, 16) && TB.Copy() == A);
+
+    f3Image G;
+    f3TiledImage TG;
+    GaussianBlur(G, A, 7, 2.0f);
+    GaussianBlur(TG, T, 7, 2.0f);
+    ASSERT_R(TG.Copy() == G);
+
+    f3Pixel p, q;
+    ASSERT_R(sample4(p, A, 3.3f, 4.7f) && sample4(q, T, 3.3f, 4.7f) && p == q);
+}
+
+// Planar images must hold the same pixels and give the same algorithm results as interleaved images
+void TestPlanarImage()
+{
+    std::cerr << "************************* TestPlanarImage\n";
+    const f3Image A = makeTestImage(67, 41);
+
+    f3PlanarImage P(A);
+    ASSERT_R(P(66, 40) == A(66, 40) && P.Copy() == A && P.plane(1)(3, 4)[0] == A(3, 4)[1]);
+    ASSERT_R(P.min_chan() == A.min_chan() && P.max_chan() == A.max_chan());
+
+    f3Image G;
+    f3PlanarImage PG;
+    GaussianBlur(G, A, 5, 1.5f);
+    GaussianBlur(PG, P, 5, 1.5f);
+    f3Image D = G - PG.Copy();
+    D = Abs(D);
+    ASSERT_R(D.max_chan().max_chan() < 1e-6f);
+
+    uc3Image T;
+    uc3PlanarImage PT;
+    ToneMapFindExtrema(T, A);
+    ToneMapFindExtrema(PT, P);
+    ASSERT_R(PT.Copy() == T);
+    ToneMapFindExtrema(PT, f3PlanarImage());
+    ASSERT_R(PT.empty());
+
+    // A different scale and bias for each channel
+    ToneMapLinear(PT, P, f3Pixel(1.f, 2.f, 0.5f), f3Pixel(0.f, -0.5f, 0.2f));
+    ASSERT_R(PT(5, 7) == static_cast<uc3Pixel>(f3Pixel(A(5, 7)[0], A(5, 7)[1] * 2.f - 0.5f, A(5, 7)[2] * 0.5f + 0.2f)));
+
+    uc3PlanarImage PT2(T);
+    ASSERT_R(getHistogram<ui3Pixel>(PT2, 16, 0.f, 256.f) == getHistogram<ui3Pixel>(T, 16, 0.f, 256.f));
+
+    CopyChan(P, 0, P, 2);
+    P.Set(f3Pixel(9), 1, 2);
+    ASSERT_R(P(3, 4)[0] == A(3, 4)[2] && P.plane(2)(1, 2) == f1Pixel(9));
+
+    // The sums exceed the int MathType of an unsigned short pixel
+    us3PlanarImage U(200, 200);
+    U.fill(us3Pixel(65535, 1, 0));
+    double sums[3];
+    U.sum_chan(sums);
+    ASSERT_R(sums[0] == 65535. * U.size() && sums[1] == double(U.size()) && sums[2] == 0.);
+}
+
+// The FFT convolution must match the direct one, including at the edges, for a kernel with no symmetry
+void TestConvolveFFT()
+{
+    std::cerr << "************************* TestConvolveFFT\n";
+    const f3Image A = makeTestImage(150, 83);
+
+    f1Image K(21, 21);
+    for (int y = 0; y < K.h(); y++)
+        for (int x = 0; x < K.w(); x++) K(x, y) = f1Pixel(float(1 + (x * 3 + y * 5) % 17) / 2000.f);
+
+    for (int k = 0; k < 3; k++) {
+        f3Image S = k == 0 ? A : f3Image(k == 1 ? 40 : 12, k == 1 ? 7 : 5); // Shorter than the kernel, then smaller
+        CopyRect(S, A, 0, 0, 0, 0, S.w(), S.h());
+
+        f3Image D, F;
+        ConvolveImageDirect(D, S, K);
+        ConvolveImageFFT(F, S, K);
+        f3Image E = D - F;
+        E = Abs(E);
+        ASSERT_R(E.max_chan().max_chan() < 1e-5f);
+    }
+
+    // The tiled direct convolution must give the pixels of a plain serial sum
+    f1Image K7(7, 7), K5(5, 5);
+    for (int y = 0; y < 7; y++)
+        for (int x = 0; x < 7; x++) K7(x, y) = K(x, y);
+    for (int y = 0; y < 5; y++)
+        for (int x = 0; x < 5; x++) K5(x, y) = K(x, y);
+    f3Image B(600, 150);
+    for (int i = 0; i < B.size(); i++) B[i] = A[i % A.size()];
+    for (const f1Image& KK : {K5, K7}) {
+        const int N = KK.w(), N2 = N / 2;
+        f3Image D;
+        ConvolveImageDirect(D, B, KK);
+        for (int y = 0; y < B.h(); y++) {
+            for (int x = 0; x < B.w(); x++) {
+                const bool edge = x < N2 || x >= B.w() - N2 || y < N2 || y >= B.h() - N2;
+                f3Pixel sum(0.f);
+                float weight = 0;
+                for (int j = 0; j < N; j++) {
+                    for (int i = 0; i < N; i++) {
+                        const int xs = x - N2 + i, ys = y - N2 + j;
+                        if (xs < 0 || xs >= B.w() || ys < 0 || ys >= B.h()) continue;
+                        sum += B(xs, ys) * KK(i, j)[0];
+                        weight += KK(i, j)[0];
+                    }
+                }
+                ASSERT_R(DiffSqr(D(x, y), edge ? sum / weight : sum) < 1e-12f); // Not exact if the compiler fuses multiply-adds
+            }
+        }
+    }
+
+    // Pixel x,y is the kernel times the pixels under it, not flipped
+    f3Image F;
+    ConvolveImage(F, A, K);
+    f3Pixel P(0.f);
+    for (int j = 0; j < K.h(); j++)
+        for (int i = 0; i < K.w(); i++) P += A(40 - 10 + i, 30 - 10 + j) * K(i, j)[0];
+    ASSERT_R(DiffSqr(P, F(40, 30)) < 1e-10f);
+}
+
+// The separable blur must match the 2D convolution, including at the edges
+void TestGaussianBlur()
+{
+    std::cerr << "************************* TestGaussianBlur\n";
+    const f3Image A = makeTestImage(67, 41);
+
+    const f1Image K = MakeGaussianKernel<f1Image>(9, 2.f);
+    // Shorter than the kernel, and narrower and shorter than half the kernel
+    const int Sizes[][2] = {{A.w(), A.h()}, {A.w(), 7}, {3, A.h()}, {A.w(), 3}};
+    for (const auto& Sz : Sizes) {
+        f3Image S(Sz[0], Sz[1]);
+        CopyRect(S, A, 0, 0, 0, 0, S.w(), S.h());
+
+        f3Image G, C;
+        GaussianBlur(G, S, 9, 2.f);
+        ConvolveImage(C, S, K);
+        f3Image D = G - C;
+        D = Abs(D);
+        ASSERT_R(D.max_chan().max_chan() < 1e-5f);
+
+        const SIMDLevel_e Level = GetSIMDLevel();
+        SetSIMDLevel(SIMD_NONE);
+        GaussianBlur(C, S, 9, 2.f);
+        SetSIMDLevel(Level);
+        D = G - C;
+        D = Abs(D);
+        ASSERT_R(D.max_chan().max_chan() < 1e-6f);
+
+        GaussianBlur(S, S, 9, 2.f); // In place
+        ASSERT_R(S == G);
+    }
+
+    // A kernel several times the size of the image
+    for (int k = 0; k < 2; k++) {
+        f1Image S(k ? 40 : 5, k ? 5 : 40), G, C;
+        for (int i = 0; i < S.size(); i++) S[i] = f1Pixel((i * 7 % 13) * 0.1f);
+        GaussianBlur(G, S, 31, 6.f);
+        ConvolveImageDirect(C, S, MakeGaussianKernel<f1Image>(31, 6.f));
+        for (int i = 0; i < S.size(); i++) ASSERT_R(std::abs(G[i][0] - C[i][0]) < 1e-5f);
+    }
+
+    // Integer pixels blur in float and round
+    uc3Image U(A.w(), A.h());
+    f3Image F(A.w(), A.h());
+    for (int i = 0; i < U.size(); i++)
+        for (int c = 0; c < 3; c++) U[i][c] = (unsigned char)(A[i][c] * 300.f + 60.f), F[i][c] = U[i][c];
+    uc3Image UG;
+    f3Image FG;
+    GaussianBlur(UG, U, 31, 6.f);
+    GaussianBlur(FG, F, 31, 6.f);
+    for (int i = 0; i < U.size(); i++)
+        for (int c = 0; c < 3; c++) ASSERT_R(std::abs(UG[i][c] - FG[i][c]) <= 0.501f);
+
+    U.fill(uc3Pixel(7, 128, 255));
+    GaussianBlur(UG, U, 31, 6.f);
+    ASSERT_R(UG.min_chan() == uc3Pixel(7, 128, 255) && UG.max_chan() == uc3Pixel(7, 128, 255));
+}
+
+// The recursive blur must approximate the FIR blur, and its boundaries must keep constant and symmetric images so
+void TestRecursiveGaussianBlur()
+{
+    std::cerr << "************************* TestRecursiveGaussianBlur\n";
+    f3Image A = makeTestImage(67, 41);
+
+    f3Image R, G;
+    RecursiveGaussianBlur(R, A, 3.f);
+    GaussianBlur(G, A, 25, 3.f);
+    for (int y = 12; y < A.h() - 12; y++)
+        for (int x = 12; x < A.w() - 12; x++) ASSERT_R(DiffSqr(R(x, y), G(x, y)) < 0.02f * 0.02f);
+
+    RecursiveGaussianBlur(A, A, 3.f); // In place
+    ASSERT_R(A == R);
+
+    // Sigma much bigger than the image
+    f1Image C(300, 200, f1Pixel(0.25f)), CR;
+    RecursiveGaussianBlur(CR, C, 150.f);
+    ASSERT_R(std::abs(CR.min_chan()[0] - 0.25f) < 1e-4f && std::abs(CR.max_chan()[0] - 0.25f) < 1e-4f);
+
+    // A step in the middle stays symmetric about the middle
+    for (int y = 0; y < C.h(); y++)
+        for (int x = 0; x < C.w(); x++) C(x, y) = f1Pixel(x < C.w() / 2 ? 0.f : 1.f);
+    RecursiveGaussianBlur(CR, C, 40.f);
+    for (int x = 0; x < C.w(); x++) ASSERT_R(std::abs(CR(x, 100)[0] + CR(C.w() - 1 - x, 100)[0] - 1.f) < 1e-3f);
+    ASSERT_R(CR(0, 0)[0] < 0.01f && CR(C.w() / 2, 0)[0] > 0.5f);
+}
+
+// VCD must match evaluating its weights directly, with and without SIMD, and for integer pixels
+void TestVCD()
+{
+    std::cerr << "************************* TestVCD\n";
+    f3Image A(70, 45);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++)
+            for (int c = 0; c < 3; c++) A(x, y)[c] = ((x / 20 + y / 25 + c) % 3) * 0.3f + 0.1f * sinf(x * 0.1f + c);
+
+    const int N = 7, N2 = N / 2;
+    const float ImageStDev = 1.5f, ColorStDev = 0.4f;
+    f3Image V;
+    VCD(V, A, N, ImageStDev, ColorStDev, 1);
+
+    const f1Image K = MakeGaussianKernel<f1Image>(N, ImageStDev);
+    const double s4 = double(ColorStDev) * ColorStDev * ColorStDev * ColorStDev;
+    for (int y = 0; y < A.h(); y++) {
+        for (int x = 0; x < A.w(); x++) {
+            f3Pixel sum(0.f);
+            double weight = 0;
+            for (int yy = std::max(0, y - N2); yy <= std::min(A.h() - 1, y + N2); yy++) {
+                for (int xx = std::max(0, x - N2); xx <= std::min(A.w() - 1, x + N2); xx++) {
+                    const double w = K(xx - x + N2, yy - y + N2)[0] * exp(-0.5 * DiffSqr(A(x, y), A(xx, yy)) / s4);
+                    sum += A(xx, yy) * float(w);
+                    weight += w;
+                }
+            }
+            ASSERT_R(DiffSqr(V(x, y), sum / float(weight)) < 1e-5f * 1e-5f);
+        }
+    }
+
+    const SIMDLevel_e Level = GetSIMDLevel();
+    SetSIMDLevel(SIMD_NONE);
+    f3Image S;
+    VCD(S, A, N, ImageStDev, ColorStDev, 2);
+    SetSIMDLevel(Level);
+    VCD(V, A, N, ImageStDev, ColorStDev, 2);
+    for (int i = 0; i < A.size(); i++) ASSERT_R(DiffSqr(S[i], V[i]) < 1e-6f * 1e-6f);
+
+    f3Image B = A;
+    VCD(B, B, N, ImageStDev, ColorStDev, 2); // In place
+    ASSERT_R(B == V);
+
+    // Integer pixels are filtered in their own units and rounded
+    uc3Image U(A.w(), A.h());
+    f3Image F(A.w(), A.h());
+    for (int i = 0; i < U.size(); i++)
+        for (int c = 0; c < 3; c++) U[i][c] = (unsigned char)(A[i][c] * 200.f + 40.f), F[i][c] = U[i][c];
+    uc3Image UV;
+    f3Image FV;
+    const float UColorStDev = ColorStDev * sqrtf(200.f); // Its square is the range stdev, which scales with the pixels
+    VCD(UV, U, N, ImageStDev, UColorStDev, 1);
+    VCD(FV, F, N, ImageStDev, UColorStDev, 1);
+    for (int i = 0; i < U.size(); i++)
+        for (int c = 0; c < 3; c++) ASSERT_R(UV[i][c] == (unsigned char)(FV[i][c] + 0.5f));
+
+    f4Image A4(A.w(), A.h()), V4;
+    for (int i = 0; i < A.size(); i++) A4[i] = f4Pixel(A[i][0], A[i][1], A[i][2], 1.f);
+    VCD(V4, A4, N, ImageStDev, ColorStDev, 1);
+    ASSERT_R(V4.min_chan()[3] == 1.f && V4.max_chan()[3] == 1.f);
+}
+
+// The fast approximate VCD must stay close to the exact one
+void TestVCDApprox()
+{
+    std::cerr << "************************* TestVCDApprox\n";
+    f3Image A(96, 80);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++)
+            for (int c = 0; c < 3; c++) A(x, y)[c] = ((x / 20 + y / 25 + c) % 3) * 0.3f + 0.1f * sinf(x * 0.1f + c);
+    f1Image A1(A.w(), A.h());
+    for (int i = 0; i < A.size(); i++) A1[i] = f1Pixel(A[i][0]);
+
+    f3Image E, F;
+    VCD(E, A, 13, 2.f, 0.5f);
+    VCDApprox(F, A, 2.f, 0.5f);
+    f1Image E1, F1;
+    VCD(E1, A1, 13, 2.f, 0.5f);
+    VCDApprox(F1, A1, 2.f, 0.5f);
+
+    double errSq = 0, errSq1 = 0;
+    for (int i = 0; i < A.size(); i++) errSq += DiffSqr(E[i], F[i]), errSq1 += DiffSqr(E1[i], F1[i]);
+    ASSERT_R(sqrt(errSq / (A.size() * 3)) < 0.005 && sqrt(errSq1 / A.size()) < 0.005);
+
+    // Zero iterations still filters once, like VCD()
+    f3Image F0;
+    VCDApprox(F0, A, 2.f, 0.5f, 0);
+    ASSERT_R(F0 == F);
+}
+
+// Rectangle sums from the integral image must match summing the pixels
+void TestIntegralImage()
+{
+    std::cerr << "************************* TestIntegralImage\n";
+    uc3Image A(67, 41);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++) A(x, y) = uc3Pixel(x * 7 % 256, y * 5 % 256, (x * y) % 251);
+
+    uc3IntegralImage I(A, true);
+    std::vector<uc3IntegralImage::Rect> Rects = {{0, 0, 67, 41}, {3, 4, 10, 20}, {60, 30, 20, 20}, {-5, -5, 7, 8}, {66, 40, 1, 1}, {10, 10, 0, 5}};
+    std::vector<uc3IntegralImage::SumType> Sums = I.RectSums(Rects);
+    for (size_t i = 0; i < Rects.size(); i++) {
+        const uc3IntegralImage::Rect& R = Rects[i];
+        int64_t S[3] = {0, 0, 0}, Q[3] = {0, 0, 0};
+        for (int y = std::max(R.y, 0); y < std::min(R.y + R.h, A.h()); y++)
+            for (int x = std::max(R.x, 0); x < std::min(R.x + R.w, A.w()); x++)
+                for (int c = 0; c < 3; c++) S[c] += A(x, y)[c], Q[c] += A(x, y)[c] * A(x, y)[c];
+        const uc3IntegralImage::SumType SQ = I.RectSum(R, true);
+        for (int c = 0; c < 3; c++) ASSERT_R(Sums[i][c] == S[c] && SQ[c] == Q[c]);
+    }
+
+    f1Image F(40, 30, f1Pixel(0.5f));
+    F(20, 10) = f1Pixel(2.5f);
+    f1IntegralImage FI(F, true);
+    ASSERT_R(FI.RectMean(0, 0, 40, 30)[0] == (0.5 * 1199 + 2.5) / 1200 && FI.RectMean(19, 9, 3, 3)[0] == (0.5 * 8 + 2.5) / 9);
+    ASSERT_R(FI.RectVariance(0, 0, 10, 10)[0] == 0 && std::abs(FI.RectVariance(20, 10, 2, 1)[0] - 1.0) < 1e-12);
+}
+
+// Converting an image must give the same pixels as converting each pixel
+template <class DstImage_T, class SrcImage_T> void TestImageConvert1(const int w, const int h)
+{
+    typedef typename SrcImage_T::PixType::ElType SrcEl;
+    SrcImage_T S(w, h);
+    for (int i = 0; i < S.size(); i++)
+        for (int c = 0; c < S.chan(); c++) {
+            if constexpr (element_traits<SrcEl>::floating_point)
+                S[i][c] = static_cast<SrcEl>(((i * 37 + c * 11) % 281) / 256.0f - 0.05f); // Some out of 0..1
+            else
+                S[i][c] = static_cast<SrcEl>((i * 37 + c * 11) * 97);
+        }
+
+    const SIMDLevel_e Level = GetSIMDLevel();
+    for (int k = 0; k < 2; k++) {
+        SetSIMDLevel(k ? Level : SIMD_NONE);
+        DstImage_T D(S);
+        for (int i = 0; i < S.size(); i++) ASSERT_R(D[i] == static_cast<typename DstImage_T::PixType>(S[i]));
+    }
+    SetSIMDLevel(Level);
+}
+
+// Black and white pixels, with alpha the inverse of the color, that average to mid-gray in linear light, which is 188 in sRGB
+static uc4Image makeCheckerboard(int w, int h)
+{
+    uc4Image Check(w, h);
+    for (int y = 0; y < Check.h(); y++)
+        for (int x = 0; x < Check.w(); x++) Check(x, y) = uc4Pixel(((x + y) & 1) * 255, ((x + y) & 1) * 255, ((x + y) & 1) * 255, 255 - ((x + y) & 1) * 255);
+    return Check;
+}
+
+void TestResize()
+{
+    std::cerr << "************************* TestResize\n";
+    f3Image A(70, 45);
+    for (int y = 0; y < A.h(); y++)
+        for (int x = 0; x < A.w(); x++)
+            for (int c = 0; c < 3; c++) A(x, y)[c] = ((x / 7 + y / 5 + c) % 3) * 0.3f + 0.1f * sinf(x * 0.3f + c);
+
+    // The unfiltered Resize gives what sample4 gives at each pixel when upsampling
+    f3Image Up;
+    Resize(Up, A, 93, 61);
+    const float xstep = (A.w() - 1) / 92.f, ystep = (A.h() - 1) / 60.f;
+    for (int y = 0; y < Up.h(); y++) {
+        for (int x = 0; x < Up.w(); x++) {
+            f3Pixel p;
+            sample4(p, A, x * xstep, y * ystep);
+            ASSERT_R(DiffSqr(Up(x, y), p) < 1e-5f * 1e-5f);
+        }
+    }
+
+    // A 2:1 box is Downsample2x2, and every filter keeps a constant constant
+    f3Image Box, Half;
+    f3Image A2 = A;
+    A2.SetSize(70, 44, true);
+    for (int y = 0; y < 44; y++)
+        for (int x = 0; x < 70; x++) A2(x, y) = A(x, y);
+    Resize(Box, A2, 35, 22, RESIZE_BOX);
+    Downsample2x2(Half, A2);
+    for (int i = 0; i < Box.size(); i++) ASSERT_R(DiffSqr(Box[i], Half[i]) < 1e-6f * 1e-6f);
+
+    const ResizeFilter_e Filters[] = {RESIZE_BOX, RESIZE_TRIANGLE, RESIZE_MITCHELL, RESIZE_LANCZOS3};
+    f3Image C(A.w(), A.h(), f3Pixel(0.25f, 0.5f, 0.75f)), R;
+    for (ResizeFilter_e F : Filters) {
+        for (int s : {17, 31, 101, 160}) {
+            Resize(R, C, s, s * 2 / 3, F);
+            for (int i = 0; i < R.size(); i++) ASSERT_R(DiffSqr(R[i], C[0]) < 1e-5f * 1e-5f);
+        }
+    }
+
+    // Linear functions are reproduced away from the edges
+    f1Image Ramp(120, 8), RR;
+    for (int y = 0; y < Ramp.h(); y++)
+        for (int x = 0; x < Ramp.w(); x++) Ramp(x, y) = f1Pixel(x + 0.5f);
+    for (ResizeFilter_e F : Filters) {
+        Resize(RR, Ramp, 40, 8, F);
+        for (int x = 6; x < 34; x++) ASSERT_R(fabsf(RR(x, 3)[0] - (x + 0.5f) * 3.f) < 1e-3f);
+    }
+
+    // SIMD matches scalar, and a view matches a copy
+    const SIMDLevel_e Level = GetSIMDLevel();
+    SetSIMDLevel(SIMD_NONE);
+    f3Image S;
+    Resize(S, A, 29, 19, RESIZE_LANCZOS3);
+    SetSIMDLevel(Level);
+    Resize(R, A, 29, 19, RESIZE_LANCZOS3);
+    for (int i = 0; i < R.size(); i++) ASSERT_R(DiffSqr(S[i], R[i]) < 1e-6f * 1e-6f);
+
+    f3ImageView In(A, 10, 5, 40, 30);
+    f3Image Crop = In.Copy(), Out(23, 17), Ref;
+    f3ImageView OutV(Out);
+    Resize(Ref, Crop, 23, 17, RESIZE_MITCHELL);
+    Resize(OutV, In, 23, 17, RESIZE_MITCHELL);
+    ASSERT_R(Out == Ref);
+
+    // The checkerboard averages to 188 in sRGB, but to 128 in the codes
+    const uc4Image Check = makeCheckerboard(40, 40);
+    uc4Image G;
+    Resize(G, Check, 20, 20, RESIZE_BOX, true);
+    for (int i = 0; i < G.size(); i++) ASSERT_R(G[i] == uc4Pixel(188, 188, 188, 128));
+    Resize(G, Check, 20, 20, RESIZE_BOX);
+    for (int i = 0; i < G.size(); i++) ASSERT_R(G[i] == uc4Pixel(128, 128, 128, 128));
+}
+
+// A MIP chain is Downsample2x2 applied over and over
+void TestMipChain()
+{
+    std::cerr << "************************* TestMipChain\n";
+    for (const int w : {73, 2000}) {
+        uc3Image A(w, w == 73 ? 41 : 300);
+        for (int i = 0; i < A.size(); i++) {
+            const unsigned int h = unsigned(i) * 2654435761u;
+            A[i] = uc3Pixel(h >> 24, (h >> 16) & 0xff, (h >> 8) & 0xff);
+        }
+        f3Image F(A);
+
+        uc3MipChain M(A);
+        f3MipChain MF(F);
+        ASSERT_R(M.levels() == (w == 73 ? 8 : 12) && M.w(M.levels() - 1) == 1 && M.h(M.levels() - 1) == 1);
+        ASSERT_R(M.level(0).Copy() == A && MF.level(0).Copy() == F);
+
+        uc3Image L = A, L1;
+        f3Image LF = F, LF1;
+        for (int k = 1; k < M.levels(); k++) {
+            Downsample2x2(L1, L);
+            Downsample2x2(LF1, LF);
+            L = L1;
+            LF = LF1;
+            ASSERT_R(M.level(k).Copy() == L && MF.level(k).Copy() == LF);
+        }
+    }
+
+    const uc4Image Check = makeCheckerboard(40, 30);
+    uc4MipChain MS(Check, true);
+    for (int y = 0; y < MS.h(1); y++)
+        for (int x = 0; x < MS.w(1); x++) ASSERT_R(MS(x, y, 1) == uc4Pixel(188, 188, 188, 128));
+}
+
+void TestMipSampler()
+{
+    std::cerr << "************************* TestMipSampler\n";
+    const int W = 64, H = 48;
+    f1Image Stripes(W, H), Cols(W, H);
+    for (int y = 0; y < H; y++)
+        for (int x = 0; x < W; x++) {
+            Stripes(x, y) = f1Pixel(float((y / 8) & 1)); // Horizontal stripes 8 rows high
+            Cols(x, y) = f1Pixel(float(x & 1));          // Vertical stripes one column wide
+        }
+    f1MipChain MS(Stripes), MC(Cols);
+
+    // Texel centers with no minification give the texels, and repeat and mirror wrap
+    tMipSampler<f1Pixel> Tri(MC, TEX_TRILINEAR), Mir(MC, TEX_TRILINEAR, TEX_MIRROR, TEX_CLAMP);
+    for (int x = 0; x < W; x++) {
+        const float u = (x + 0.5f) / W, v = 0.3f;
+        ASSERT_R(Tri.Sample(u, v, 0, 0, 0, 0)[0] == Cols(x, 0)[0]);
+        ASSERT_R(Tri.Sample(u + 2.f, v, 0, 0, 0, 0)[0] == Cols(x, 0)[0]);
+        ASSERT_R(Mir.Sample(-u, v, 0, 0, 0, 0)[0] == Cols(x, 0)[0]);
+    }
+
+    // Minified one-texel stripes average to gray rather than aliasing
+    for (int i = 0; i < 20; i++) ASSERT_R(fabsf(Tri.Sample(0.013f * i, 0.5f, 8.f / W, 0, 0, 8.f / H)[0] - 0.5f) < 0.02f);
+
+    // A footprint 16 texels wide and 1 high: trilinear blurs the 8-row stripes across it, but anisotropic keeps them sharp
+    tMipSampler<f1Pixel> TriS(MS, TEX_TRILINEAR), Aniso(MS, TEX_ANISOTROPIC);
+    for (int y = 0; y < H; y += 8) {
+        const float v = (y + 4.f) / H, want = float((y / 8) & 1);
+        ASSERT_R(fabsf(TriS.Sample(0.5f, v, 16.f / W, 0, 0, 1.f / H)[0] - want) > 0.1f);
+        ASSERT_R(fabsf(Aniso.Sample(0.5f, v, 16.f / W, 0, 0, 1.f / H)[0] - want) < 0.01f);
+    }
+
+    // The batched call matches single calls, and an sRGB chain samples in linear light
+    const int N = 1000;
+    std::vector<float> U(N), V(N), Dx(N), Dy(N), Z(N, 0.f);
+    for (int i = 0; i < N; i++) {
+        U[i] = i * 0.0137f - 3.f;
+        V[i] = i * 0.0071f;
+        Dx[i] = (i % 13) / 64.f;
+        Dy[i] = (i % 5) / 256.f;
+    }
+    std::vector<f1Pixel> Out(N);
+    Aniso.Sample(Out.data(), U.data(), V.data(), Dx.data(), Z.data(), Z.data(), Dy.data(), N);
+    for (int i = 0; i < N; i++) ASSERT_R(Out[i] == Aniso.Sample(U[i], V[i], Dx[i], 0, 0, Dy[i]));
+
+    uc1Image Gray(4, 4, uc1Pixel(188));
+    uc1MipChain MG(Gray, true);
+    tMipSampler<uc1Pixel> G(MG);
+    ASSERT_R(fabsf(G.Sample(0.3f, 0.6f, 0.5f, 0, 0, 0.5f)[0] - SRGBToLinear(188 / 255.f)) < 1e-6f);
+}
+
+void TestMedian()
+{
+    std::cerr << "************************* TestMedian\n";
+    const int W = 57, H = 43;
+    uc1Image A(W, H);
+    for (int i = 0; i < A.size(); i++) A[i] = uc1Pixel((unsigned(i) * 2654435761u) >> 24);
+
+    // The filter matches a brute force median of the edge-extended window
+    for (const int r : {0, 1, 2, 4}) {
+        uc1Image M;
+        MedianFilter(M, A, r);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                std::vector<unsigned char> Win;
+                for (int j = -r; j <= r; j++)
+                    for (int i = -r; i <= r; i++) Win.push_back(A(std::clamp(x + i, 0, W - 1), std::clamp(y + j, 0, H - 1))[0]);
+                std::nth_element(Win.begin(), Win.begin() + Win.size() / 2, Win.end());
+                ASSERT_R(M(x, y)[0] == Win[Win.size() / 2]);
+            }
+        }
+    }
+
+    // Salt and pepper noise on a smooth image goes away
+    uc3Image S(200, 150), SM;
+    for (int y = 0; y < S.h(); y++)
+        for (int x = 0; x < S.w(); x++) S(x, y) = uc3Pixel(x, y, 100);
+    uc3Image Noisy = S;
+    for (int i = 0; i < Noisy.size(); i += 7) Noisy[i] = ((unsigned(i) * 2654435761u) >> 31) ? uc3Pixel(255, 255, 255) : uc3Pixel(0, 0, 0);
+    MedianFilter(SM, Noisy, 2);
+    for (int y = 2; y < S.h() - 2; y++)
+        for (int x = 2; x < S.w() - 2; x++)
+            for (int c = 0; c < 3; c++) ASSERT_R(abs(int(SM(x, y)[c]) - int(S(x, y)[c])) <= 2);
+
+    // Float channels are quantized to 256 levels across their range
+    f1Image F(W, H), FM;
+    for (int i = 0; i < F.size(); i++) F[i] = f1Pixel(A[i][0] * 0.01f - 1.f);
+    uc1Image AM;
+    MedianFilter(AM, A, 2);
+    MedianFilter(FM, F, 2);
+    f1Pixel mn, mx;
+    F.GetMinMax(mn, mx);
+    const float step = (mx[0] - mn[0]) / 256.f;
+    for (int i = 0; i < F.size(); i++) ASSERT_R(fabsf(FM[i][0] - (AM[i][0] * 0.01f - 1.f)) <= step);
+
+    // Exact percentiles match sorting
+    std::vector<float> P = {0.f, 0.1f, 0.5f, 0.77f, 1.f};
+    const int n = int(A.size());
+    const std::vector<uc3Pixel> SP = getPercentiles(Noisy, P);
+    const std::vector<f1Pixel> FP = getPercentiles(F, P);
+    for (int c = 0; c < 3; c++) {
+        std::vector<unsigned char> V;
+        for (int i = 0; i < Noisy.size(); i++) V.push_back(Noisy[i][c]);
+        std::sort(V.begin(), V.end());
+        for (size_t k = 0; k < P.size(); k++) ASSERT_R(SP[k][c] == V[size_t(P[k] * (V.size() - 1))]);
+    }
+    std::vector<float> V;
+    for (int i = 0; i < n; i++) V.push_back(F[i][0]);
+    std::sort(V.begin(), V.end());
+    for (size_t k = 0; k < P.size(); k++) ASSERT_R(FP[k][0] == V[size_t(P[k] * (n - 1))]);
+    ASSERT_R(getMedian(F)[0] == V[(n - 1) / 2]);
+}
+
+void TestMorphology()
+{
+    std::cerr << "************************* TestMorphology\n";
+    const int W = 83, H = 61;
+    us1Image A(W, H);
+    for (int i = 0; i < A.size(); i++) A[i] = us1Pixel((unsigned(i) * 2654435761u) >> 16);
+
+    // Erode and Dilate match brute force over the edge-extended window, and Despeckle over the neighbors in the image
+    for (const int r : {0, 1, 3, 20}) {
+        us1Image E, D, S;
+        Erode(E, A, r);
+        Dilate(D, A, r);
+        if (r > 0) Despeckle(S, A, r);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                unsigned short mn = 0xffff, mx = 0, nmn = 0xffff, nmx = 0;
+                for (int j = -r; j <= r; j++) {
+                    for (int i = -r; i <= r; i++) {
+                        const int xc = std::clamp(x + i, 0, W - 1), yc = std::clamp(y + j, 0, H - 1);
+                        const unsigned short v = A(xc, yc)[0];
+                        mn = std::min(mn, v);
+                        mx = std::max(mx, v);
+                        if (xc != x || yc != y) nmn = std::min(nmn, v), nmx = std::max(nmx, v);
+                    }
+                }
+                ASSERT_R(E(x, y)[0] == mn && D(x, y)[0] == mx);
+                if (r > 0) ASSERT_R(S(x, y)[0] == std::clamp(A(x, y)[0], nmn, nmx));
+            }
+        }
+    }
+
+    // Opening and closing bracket the image and are idempotent
+    f3Image F(W, H), O, C, O2, C2;
+    for (int i = 0; i < F.size(); i++) {
+        const unsigned h = unsigned(i) * 2654435761u;
+        F[i] = f3Pixel((h >> 24) / 255.f, ((h >> 16) & 0xff) / 255.f, ((h >> 8) & 0xff) / 255.f);
+    }
+    MorphOpen(O, F, 2);
+    MorphClose(C, F, 2);
+    MorphOpen(O2, O, 2);
+    MorphClose(C2, C, 2);
+    ASSERT_R(O2 == O && C2 == C);
+    for (int i = 0; i < F.size(); i++)
+        for (int c = 0; c < 3; c++) ASSERT_R(O[i][c] <= F[i][c] && F[i][c] <= C[i][c]);
+
+    // Specks on the corner and edges are removed, including in a single row or column, and a single pixel is kept
+    for (const int sz : {1, 2, 7}) {
+        for (const bool row : {false, true}) {
+            const int sw = row ? 9 : sz, sh = row ? sz : 9;
+            f1Image Sp(sw, sh, f1Pixel(0.25f)), SpD;
+            Sp(0, 0) = Sp(sw - 1, sh / 2) = f1Pixel(1.f);
+            Despeckle(SpD, Sp, 2);
+            ASSERT_R(SpD == f1Image(sw, sh, f1Pixel(0.25f)));
+        }
+    }
+    f1Image One(1, 1, f1Pixel(0.5f)), OneD;
+    Despeckle(OneD, One, 1);
+    ASSERT_R(OneD == One);
+
+    // Eroding in place on a view of part of an image
+    uc1Image U(W, H), Ref;
+    for (int i = 0; i < U.size(); i++) U[i] = uc1Pixel(A[i][0] >> 8);
+    uc1ImageView Sub(U, 10, 5, 40, 30);
+    Erode(Ref, Sub.Copy(), 4);
+    Erode(Sub, Sub, 4);
+    ASSERT_R(Sub.Copy() == Ref);
+}
+
+void TestHistogram()
+{
+    std::cerr << "************************* TestHistogram\n";
+    uc3Image A(700, 300);
+    us1Image S(700, 300);
+    f4Image F(700, 300);
+    for (int i = 0; i < A.size(); i++) {
+        const unsigned h = unsigned(i) * 2654435761u;
+        A[i] = uc3Pixel(h >> 24, (h >> 16) & 0xff, (h >> 8) & 0xff);
+        S[i] = us1Pixel(h >> 16);
+        F[i] = f4Pixel(A[i][0] / 200.f - 0.1f, A[i][1] / 255.f, A[i][2] * -1.f, 0.5f);
+    }
+
+    // Counts match a simple loop, including values that round toward zero into bucket 0 and values out of range
+    const int NB = 17;
+    const std::vector<ui3Pixel> HA = getHistogram<ui3Pixel>(A, NB, 10.f, 200.f);
+    const std::vector<ui1Pixel> HS = getHistogram<ui1Pixel>(S, NB, 1000.f, 60000.f);
+    const std::vector<ui4Pixel> HF = getHistogram<ui4Pixel>(F, NB, 0.f, 1.f);
+    std::vector<ui3Pixel> RA(NB, ui3Pixel(0));
+    std::vector<ui1Pixel> RS(NB, ui1Pixel(0));
+    std::vector<ui4Pixel> RF(NB, ui4Pixel(0));
+    for (int i = 0; i < A.size(); i++) {
+        for (int c = 0; c < 4; c++) {
+            int b = c < 3 ? int(float(A[i][c] - 10.f) * (NB / 190.f)) : -1;
+            if (b >= 0 && b < NB) RA[b][c]++;
+            b = int(float(F[i][c] - 0.f) * (NB / 1.f));
+            if (b >= 0 && b < NB) RF[b][c]++;
+        }
+        const int b = int(float(S[i][0] - 1000.f) * (NB / 59000.f));
+        if (b >= 0 && b < NB) RS[b][0]++;
+    }
+    ASSERT_R(HA == RA && HS == RS && HF == RF);
+
+    // The fractions and the CDF
+    const std::vector<f3Pixel> FA = getHistogramFraction<f3Pixel>(A, NB, 10.f, 200.f);
+    const std::vector<f3Pixel> CA = getHistogramFraction<f3Pixel>(A, NB, 10.f, 200.f, true);
+    for (int c = 0; c < 3; c++) {
+        double sum = 0;
+        for (int b = 0; b < NB; b++) {
+            ASSERT_R(fabs(FA[b][c] - double(RA[b][c]) / A.size()) < 1e-6);
+            sum += RA[b][c];
+            ASSERT_R(fabs(CA[b][c] - sum / A.size()) < 1e-6);
+        }
+    }
+    const std::vector<f1Pixel> CS = getHistogramFraction<f1Pixel>(S, 4, 0.f, 65536.f, true);
+    ASSERT_R(CS.back()[0] == 1.f);
+}
+
+void TestToneMap()
+{
+    std::cerr << "************************* TestToneMap\n";
+    const int W = 300, H = 250;
+    f3Image F(W, H);
+    us3Image U(W, H);
+    f4Image F4(W, H);
+    for (int i = 0; i < F.size(); i++) {
+        const unsigned h = unsigned(i) * 2654435761u;
+        U[i] = us3Pixel(h >> 16, h & 0xffff, (h >> 8) & 0xffff);
+        F[i] = f3Pixel(U[i][0] / 4096.f - 2.f, U[i][1] / 65535.f, U[i][2] / 8000.f);
+        F4[i] = f4Pixel(F[i][0], F[i][1], F[i][2], U[i][1] / 65535.f);
+    }
+
+    // The extrema map to 0 and 255 like the per-pixel arithmetic, which may round differently with fused multiply-add
+    uc3Image T, TU;
+    ToneMapFindExtrema(T, F);
+    f3Pixel MinP, MaxP;
+    F.GetMinMax(MinP, MaxP);
+    const float sc = 1.f / (MaxP.max_chan() - MinP.min_chan()), bi = -MinP.min_chan() * sc;
+    ToneMapFindExtrema(TU, U);
+    us3Pixel UMin, UMax;
+    U.GetMinMax(UMin, UMax);
+    const float usc = 1.f / (float(UMax.max_chan()) - float(UMin.min_chan())), ubi = -float(UMin.min_chan()) * usc;
+    for (int i = 0; i < F.size(); i++) {
+        for (int c = 0; c < 3; c++) {
+            ASSERT_R(abs(int(T[i][c]) - int(std::clamp(F[i][c] * sc + bi, 0.f, 1.f) * 255.f)) <= 1);
+            ASSERT_R(abs(int(TU[i][c]) - int(std::clamp(U[i][c] * usc + ubi, 0.f, 1.f) * 255.f)) <= 1);
+        }
+    }
+
+    // The operators, with and without sRGB, and the unsigned short table against the same values in float
+    f3Image FU(W, H);
+    for (int i = 0; i < F.size(); i++) FU[i] = f3Pixel(U[i][0] / 65535.f, U[i][1] / 65535.f, U[i][2] / 65535.f);
+    for (const ToneMapOp_e Op : {TONEMAP_CLAMP, TONEMAP_REINHARD, TONEMAP_FILMIC}) {
+        for (const bool sRGB : {false, true}) {
+            uc3Image M, MU, MF;
+            ToneMap(M, F, Op, 2.f, sRGB);
+            ToneMap(MU, U, Op, 2.f, sRGB);
+            ToneMap(MF, FU, Op, 2.f, sRGB);
+            for (int i = 0; i < F.size(); i++) {
+                for (int c = 0; c < 3; c++) {
+                    const float x = std::max(F[i][c] * 2.f, 0.f);
+                    float y = Op == TONEMAP_CLAMP ? x : Op == TONEMAP_REINHARD ? x / (1.f + x) : (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+                    y = std::clamp(y, 0.f, 1.f);
+                    const int want = sRGB ? int(LinearToSRGB(y) * 255.f + 0.5f) : int(y * 255.f + 0.5f);
+                    ASSERT_R(abs(int(M[i][c]) - want) <= 1);
+                    ASSERT_R(abs(int(MU[i][c]) - int(MF[i][c])) <= 1);
+                }
+            }
+        }
+    }
+
+    // Alpha is copied, not tone mapped
+    uc4Image M4;
+    ToneMap(M4, F4, TONEMAP_FILMIC, 4.f);
+    for (int i = 0; i < F4.size(); i++) ASSERT_R(M4[i][3] == int(F4[i][3] * 255.f + 0.5f));
+}
+
+// CopyRect() one pixel at a time the way it used to be, to check the row kernels against
+template <class Image_T>
+void copyRectPixels(Image_T& D, const Image_T& S, const int sx0, const int sy0, const int dx0, const int dy0, const int bw, const int bh, const int mode,
+                    const typename Image_T::PixType Key, const float alpha)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    for (int y = 0; y < bh; y++) {
+        for (int x = 0; x < bw; x++) {
+            const int sx = sx0 + x, sy = sy0 + y, dx = dx0 + x, dy = dy0 + y;
+            if (sx < 0 || sy < 0 || dx < 0 || dy < 0 || sx >= S.w() || sy >= S.h() || dx >= D.w() || dy >= D.h()) continue;
+            const Pixel_T s = S(sx, sy);
+            Pixel_T& d = D(dx, dy);
+            const typename Pixel_T::FloatMathPixType sf(s), df(d);
+            if (mode == 0) d = s;
+            if (mode == 1) d = linInterp(d, s, sf[Pixel_T::Chan - 1]);
+            if (mode == 2 && s != Key) d = s;
+            if (mode == 3) d = linInterp(df, sf * df, sf[Pixel_T::Chan - 1]);
+            if (mode == 4) d = linInterp(d, s, alpha);
+            if (mode == 5) d = d + s;
+            if (mode == 6) d[Key[0]] = s[Key[0]];
+        }
+    }
+}
+
+template <class Image_T> void TestCopyRect1(const int W, const int H)
+{
+    typedef typename Image_T::PixType Pixel_T;
+    typedef typename Pixel_T::ElType El_T;
+    const int C = Pixel_T::Chan;
+    Image_T S(W, H), D0(W + 9, H + 5);
+    for (int i = 0; i < S.size(); i++)
+        for (int c = 0; c < C; c++) basePixel::channel_cast(S[i][c], ((unsigned(i) * 2654435761u) >> (8 + 4 * c) & 0xff) / 255.f);
+    for (int i = 0; i < D0.size(); i++)
+        for (int c = 0; c < C; c++) basePixel::channel_cast(D0[i][c], ((unsigned(i) * 40503u) >> (2 + 3 * c) & 0xff) / 255.f);
+    const Pixel_T Key = S(3, 2); // Keyed copy skips a run of these
+    for (int x = 10; x < 30 && x < W; x++) S(x, 1) = Key;
+
+    const SIMDLevel_e Level = GetSIMDLevel();
+    for (int k = SIMD_NONE; k <= Level; k++) {
+        SetSIMDLevel(SIMDLevel_e(k));
+        for (int mode = 0; mode <= 6; mode++) {
+            if ((mode == 1 || mode == 3) && C != 4) continue;
+            Pixel_T K = Key;
+            if (mode == 6) K[0] = El_T(C - 1); // The channel to copy
+            const int Rects[][4] = {{0, 0, 4, 3}, {-3, -2, 7, 6}, {5, 4, -6, 2}, {W - 10, H - 5, 0, 0}};
+            for (const auto& R : Rects) {
+                Image_T D(D0), Want(D0);
+                D.row(0); // Don't share with Want
+                CopyRect(D, S, R[0], R[1], R[2], R[3], W - 3, H - 1, mode, K, 0.3f);
+                copyRectPixels(Want, S, R[0], R[1], R[2], R[3], W - 3, H - 1, mode, K, 0.3f);
+                // The OVER modes lerp in float, which may round differently with fused multiply-add
+                const double Tol = mode == 1 || mode == 4 ? (element_traits<El_T>::floating_point ? 1e-6 : 1.) : 0.;
+                for (int i = 0; i < D.size(); i++)
+                    for (int c = 0; c < C; c++) ASSERT_R(fabs(double(D[i][c]) - double(Want[i][c])) <= Tol);
+            }
+        }
+    }
+    SetSIMDLevel(Level);
+}
+
+void TestCopyRect()
+{
+    std::cerr << "************************* TestCopyRect\n";
+    TestCopyRect1<uc4Image>(67, 41);
+    TestCopyRect1<uc1Image>(67, 41);
+    TestCopyRect1<uc3Image>(67, 41);
+    TestCopyRect1<f4Image>(67, 41);
+    TestCopyRect1<f1Image>(67, 41);
+    TestCopyRect1<uc4Image>(1031, 517); // Copies on multiple threads
+}
+
+void TestImageConvert()
+{
+    std::cerr << "************************* TestImageConvert\n";
+    TestImageConvert1<f3Image, uc3Image>(67, 41);
+    TestImageConvert1<uc3Image, f3Image>(67, 41);
+    TestImageConvert1<us4Image, f4Image>(67, 41);
+    TestImageConvert1<f1Image, us1Image>(67, 41);
+    TestImageConvert1<uc4Image, us4Image>(67, 41);
+    TestImageConvert1<us3Image, uc3Image>(67, 41);
+    TestImageConvert1<f4Image, uc1Image>(67, 41);
+    TestImageConvert1<us4Image, uc3Image>(67, 41);
+    TestImageConvert1<h3Image, uc3Image>(67, 41);
+    TestImageConvert1<uc1Image, f3Image>(67, 41);
+    TestImageConvert1<f3Image, uc3Image>(1031, 517); // Converts on multiple threads
+    TestImageConvert1<f4Image, h4Image>(67, 41);
+    TestImageConvert1<h3Image, f3Image>(67, 41);
+    TestImageConvert1<uc4Image, h4Image>(67, 41);
+    TestImageConvert1<h1Image, us1Image>(67, 41);
+    TestImageConvert1<us3Image, h3Image>(67, 41);
+
+    // sRGB bytes through linear float and back are unchanged, and alpha isn't transformed
+    uc4Image A(256, 3);
+    for (int i = 0; i < A.size(); i++) A[i] = uc4Pixel(i % 256, (i * 7) % 256, 255 - i % 256, i % 256);
+    f4Image L(A.w(), A.h());
+    uc4Image B;
+    ConvertImage(L, A, XFER_SRGB_TO_LINEAR);
+    ConvertImage(B, L, XFER_LINEAR_TO_SRGB);
+    ASSERT_R(B == A);
+    ASSERT_R(L(128, 0).r() < 0.22f && L(128, 0).r() > 0.21f && L(128, 0).a() == 128 / 255.f);
+}
+
+// The bulk half conversions must give the same bits as class half for every half and a wide sweep of floats
+void TestHalfConvert()
+{
+    std::cerr << "************************* TestHalfConvert\n";
+    std::vector<half> H(1 << 16), H2(H.size());
+    std::vector<float> F(H.size()), F2(H.size());
+    for (int i = 0; i < (1 << 16); i++) H[i].setBits((unsigned short)i);
+
+    const SIMDLevel_e Level = GetSIMDLevel();
+    for (int k = SIMD_NONE; k <= Level; k++) {
+        SetSIMDLevel(SIMDLevel_e(k));
+        HalfToFloat(F.data(), H.data(), H.size());
+        for (int i = 0; i < (1 << 16); i++) {
+            const float f = H[i];
+            ASSERT_R(F[i] == f || (H[i].isNan() && F[i] != F[i]));
+        }
+
+        // Every exponent with a mix of significands, then every exponent with significands that are rounding ties
+        for (unsigned int u = 0; u <= 4; u++) {
+            for (int i = 0; i < (1 << 16); i++) {
+                const unsigned int b = u < 4 ? u * 65536u * 16381u + i * 16381u : (unsigned int)i << 16 | 0x1000;
+                memcpy(&F2[i], &b, 4);
+            }
+            FloatToHalf(H2.data(), F2.data(), H2.size());
+            for (int i = 0; i < (1 << 16); i++) ASSERT_R(H2[i].bits() == half(F2[i]).bits());
+        }
+    }
+    SetSIMDLevel(Level);
+}
+
 void TestImages()
 {
     std::cerr << "************************* TestImages\n";
+    TestImageExpressions();
+    TestImageKernels();
+    TestImageViews();
+    TestImagePitch();
+    TestImageSharing();
+    TestTiledImage();
+    TestPlanarImage();
+    TestConvolveFFT();
+    TestGaussianBlur();
+    TestRecursiveGaussianBlur();
+    TestIntegralImage();
+    TestVCD();
+    TestVCDApprox();
+    TestResize();
+    TestMipChain();
+    TestMipSampler();
+    TestMedian();
+    TestMorphology();
+    TestHistogram();
+    TestToneMap();
+    TestCopyRect();
+    TestImageConvert();
+    TestHalfConvert();
     TestImageConversion();
     TestTIFFLoadSave();
     TestImages1();
@@ -0,0 +1,29 @@
+//////////////////////////////////////////////////////////////////////
+// ParallelFor.h - Run a loop over an index range on all cores
+//
+// Copyright David K. McAllister, 2026.
+
+#pragma once
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+// Call f(begin, end) on consecutive ranges of about grain indices that together cover [0, n).
+// The ranges run in parallel when there is more than one, so f must be safe to call concurrently on disjoint ranges.
+// Choose grain so that each range is enough work to be worth a thread, e.g. 64K pixels of an image operation.
+template <class Func_T> void ParallelForRanges(const int n, const int grain, const Func_T& f)
+{
+    if (n <= 0) return;
+    const int g = std::max(grain, 1);
+    const int numRanges = (n + g - 1) / g;
+    if (numRanges == 1) {
+        f(0, n);
+        return;
+    }
+
+    std::vector<int> rangeIds(numRanges);
+    std::iota(rangeIds.begin(), rangeIds.end(), 0);
+    std::for_each(std::execution::par, rangeIds.begin(), rangeIds.end(), [&](const int r) { f(r * g, std::min(n, (r + 1) * g)); });
+}
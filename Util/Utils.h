@@ -11,6 +11,7 @@
 #include <intrin.h>
 #endif
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -57,7 +58,7 @@ DMC_DECL void ConvertDouble(double* array, int length)
 }
 
 // Swap endian-ness of the array. length is the number of 4-byte words to swap.
-DMC_DECL void ConvertLong(unsigned int* array, int length)
+DMC_DECL void ConvertLong(unsigned int* array, int64_t length)
 {
     unsigned char b0, b1, b2, b3;
     unsigned char* ptr = (unsigned char*)array;
@@ -77,7 +78,7 @@ DMC_DECL void ConvertLong(unsigned int* array, int length)
 }
 
 // Swap endian-ness of the array. length is the number of 2-byte shorts to swap.
-DMC_DECL void ConvertShort(unsigned short* array, int length)
+DMC_DECL void ConvertShort(unsigned short* array, int64_t length)
 {
     unsigned char b0, b1;
     unsigned char* ptr = (unsigned char*)array;
@@ -140,17 +141,18 @@ DMC_HDECL void FloatFmt(std::ostream& os, int prec = 8)
 // Consider removing this or using something like:
 // extern "C" int __isa_available;
 // int main() { printf("__isa_available: %d\n", __isa_available); }
-DMC_DECL void cpuid(unsigned int cmd, unsigned int& a, unsigned int& b, unsigned int& c, unsigned int& d)
+// subcmd selects the sub-leaf for the commands that have them, such as 7.
+DMC_DECL void cpuid(unsigned int cmd, unsigned int& a, unsigned int& b, unsigned int& c, unsigned int& d, unsigned int subcmd = 0)
 {
     unsigned int aa = 0, bb = 0, cc = 0, dd = 0;
 #ifdef DMC_MACHINE_gcc
-    asm("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(cmd));
+    asm("cpuid" : "=a"(aa), "=b"(bb), "=c"(cc), "=d"(dd) : "a"(cmd), "c"(subcmd));
 #else
 #ifdef DMC_BITNESS_32
     __asm {
       mov eax, cmd
+      mov ecx, subcmd
       xor ebx, ebx
-      xor ecx, ecx
       xor edx, edx
       cpuid
       mov aa, eax
@@ -160,11 +162,11 @@ DMC_DECL void cpuid(unsigned int cmd, unsigned int& a, unsigned int& b, unsigned
     }
 #else
     int x[4];
-    __cpuid(x, cmd);
-    a = x[0];
-    b = x[1];
-    c = x[2];
-    d = x[3];
+    __cpuidex(x, cmd, subcmd);
+    aa = x[0];
+    bb = x[1];
+    cc = x[2];
+    dd = x[3];
 #endif
 #endif
     a = aa;
@@ -173,6 +175,52 @@ DMC_DECL void cpuid(unsigned int cmd, unsigned int& a, unsigned int& b, unsigned
     d = dd;
 }
 
+// Which register state the OS saves on context switch. Only call it if cpuid(1) says OSXSAVE.
+DMC_DECL unsigned long long xgetbv0()
+{
+#ifdef DMC_MACHINE_gcc
+    unsigned int lo = 0, hi = 0;
+    asm("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    return _xgetbv(0);
+#endif
+}
+
+// The SIMD instruction sets that DMcTools has kernels for, from worst to best
+enum SIMDLevel_e { SIMD_NONE = 0, SIMD_SSE4 = 1, SIMD_AVX2 = 2, SIMD_AVX512 = 3 };
+
+// Returns the best SIMD instruction set that both the CPU and the OS support.
+// SIMD_AVX2 also implies FMA and F16C.
+DMC_DECL SIMDLevel_e CPUSIMDLevel()
+{
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+    cpuid(0, a, b, c, d);
+    const unsigned int maxCmd = a;
+    if (maxCmd < 1) return SIMD_NONE;
+
+    cpuid(1, a, b, c, d);
+    const bool sse41 = c & (1 << 19);
+    const bool osxsave = c & (1 << 27);
+    const bool avx = c & (1 << 28);
+    const bool fma = c & (1 << 12);
+    const bool f16c = c & (1 << 29);
+    if (!sse41) return SIMD_NONE;
+    if (!(osxsave && avx && fma && f16c) || maxCmd < 7) return SIMD_SSE4;
+
+    const unsigned long long xcr0 = xgetbv0();
+    if ((xcr0 & 0x6) != 0x6) return SIMD_SSE4; // OS doesn't save the YMM registers
+
+    cpuid(7, a, b, c, d, 0);
+    const bool avx2 = b & (1 << 5);
+    const bool avx512f = b & (1 << 16);
+    const bool avx512bw = b & (1 << 30);
+    if (!avx2) return SIMD_SSE4;
+    if (avx512f && avx512bw && (xcr0 & 0xe6) == 0xe6) return SIMD_AVX512;
+
+    return SIMD_AVX2;
+}
+
 DMC_DECL unsigned int NumCores()
 {
     unsigned int a = 0, b = 0, c = 0, d = 0;